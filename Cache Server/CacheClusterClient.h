@@ -0,0 +1,739 @@
+#ifndef CACHE_CLUSTER_CLIENT_H
+#define CACHE_CLUSTER_CLIENT_H
+
+#include "../Common/Hash.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Address of one cache server process.
+ */
+struct CacheNode {
+    std::string host = "127.0.0.1";
+    int port = 11211;
+    std::string unix_path;  // used instead of host:port when set
+
+    /**
+     * @return The node's identity for hashing: "unix:<path>" or "<host>:<port>"
+     */
+    std::string id() const {
+        return unix_path.empty() ? host + ":" + std::to_string(port) : "unix:" + unix_path;
+    }
+};
+
+/**
+ * Memcached text-protocol connection to one cache server.
+ *
+ * Requests are pipelined: a batch is queued with begin(), then flush() and
+ * receive() move it along without blocking while the caller polls fd(),
+ * and the parse calls consume the replies that have arrived. Sending and
+ * reading interleave, so a batch whose replies outgrow the socket buffers
+ * and the server's output cap cannot stall both ends. Single commands
+ * such as remove() block. Not thread-safe.
+ */
+class MemcachedConnection {
+private:
+    static constexpr std::size_t kMaxLine = 8000;      // stay under the server's 8192-byte line limit
+    static constexpr std::size_t kMaxReceive = 1 << 20; // bytes buffered per receive()
+
+    int fd_ = -1;
+    std::string in_;
+    std::size_t in_pos_ = 0;
+    std::string out_;
+    std::size_t out_pos_ = 0;
+
+    /**
+     * Drops what has been parsed, so a long batch of replies does not stay
+     * buffered until the last one is read.
+     */
+    void compact() {
+        if (in_pos_ > 0) {
+            in_.erase(0, in_pos_);
+            in_pos_ = 0;
+        }
+    }
+
+    void fill() {
+        compact();
+        char buf[16 * 1024];
+        while (true) {
+            ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::system_error(n == 0 ? ECONNRESET : errno, std::generic_category(), "recv");
+            }
+            in_.append(buf, static_cast<std::size_t>(n));
+            return;
+        }
+    }
+
+    std::string readLine() {
+        while (true) {
+            std::size_t eol = in_.find("\r\n", in_pos_);
+            if (eol != std::string::npos) {
+                std::string line = in_.substr(in_pos_, eol - in_pos_);
+                in_pos_ = eol + 2;
+                return line;
+            }
+            fill();
+        }
+    }
+
+    static void checkKey(const std::string& key) {
+        if (key.empty() || key.size() > 250) {
+            throw std::invalid_argument("Key must be 1 to 250 bytes");
+        }
+        for (unsigned char c : key) {
+            if (c <= 32 || c == 127) {
+                throw std::invalid_argument("Key must not contain spaces or control characters");
+            }
+        }
+    }
+
+public:
+    /**
+     * Connects to a cache server.
+     *
+     * @param node The server's address
+     * @throws std::system_error if the connection fails
+     * @throws std::invalid_argument if the address is malformed
+     */
+    explicit MemcachedConnection(const CacheNode& node) {
+        if (!node.unix_path.empty()) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (node.unix_path.size() >= sizeof(addr.sun_path)) {
+                throw std::invalid_argument("Unix socket path too long: " + node.unix_path);
+            }
+            std::memcpy(addr.sun_path, node.unix_path.c_str(), node.unix_path.size() + 1);
+            fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd_ < 0) {
+                throw std::system_error(errno, std::generic_category(), "socket");
+            }
+            if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                int saved = errno;
+                ::close(fd_);
+                throw std::system_error(saved, std::generic_category(), "connect " + node.id());
+            }
+            return;
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(node.port));
+        if (::inet_pton(AF_INET, node.host.c_str(), &addr.sin_addr) != 1) {
+            throw std::invalid_argument("Invalid IPv4 address: " + node.host);
+        }
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            int saved = errno;
+            ::close(fd_);
+            throw std::system_error(saved, std::generic_category(), "connect " + node.id());
+        }
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    MemcachedConnection(const MemcachedConnection&) = delete;
+    MemcachedConnection& operator=(const MemcachedConnection&) = delete;
+
+    ~MemcachedConnection() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    /**
+     * Writes a whole buffer.
+     *
+     * @param out The bytes to send
+     * @throws std::system_error on connection failure
+     */
+    void sendAll(const std::string& out) {
+        std::size_t off = 0;
+        while (off < out.size()) {
+            ssize_t n = ::send(fd_, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::system_error(errno, std::generic_category(), "send");
+            }
+            off += static_cast<std::size_t>(n);
+        }
+    }
+
+    /**
+     * Queues a batch of commands to send with flush().
+     *
+     * @param out The commands, taken over by the connection
+     */
+    void begin(std::string out) {
+        out_ = std::move(out);
+        out_pos_ = 0;
+    }
+
+    /**
+     * @return true while part of the batch queued by begin() is unsent
+     */
+    bool sending() const {
+        return out_pos_ < out_.size();
+    }
+
+    /**
+     * @return The socket, for polling
+     */
+    int fd() const {
+        return fd_;
+    }
+
+    /**
+     * Sends as much of the queued batch as the socket takes without
+     * blocking.
+     *
+     * @throws std::system_error on connection failure
+     */
+    void flush() {
+        while (sending()) {
+            ssize_t n = ::send(fd_, out_.data() + out_pos_, out_.size() - out_pos_, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (n <= 0) {
+                throw std::system_error(errno, std::generic_category(), "send");
+            }
+            out_pos_ += static_cast<std::size_t>(n);
+        }
+        std::string().swap(out_);
+        out_pos_ = 0;
+    }
+
+    /**
+     * Buffers the replies that have arrived, up to about 1 MiB, without
+     * blocking. Parse them with parseGets() or parseSets().
+     *
+     * @return false if the server has closed the connection
+     * @throws std::system_error on connection failure
+     */
+    bool receive() {
+        compact();
+        char buf[16 * 1024];
+        std::size_t received = 0;
+        while (received < kMaxReceive) {
+            ssize_t n = ::recv(fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (n < 0) {
+                throw std::system_error(errno, std::generic_category(), "recv");
+            }
+            if (n == 0) {
+                return false;
+            }
+            in_.append(buf, static_cast<std::size_t>(n));
+            received += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * Appends get commands for the keys, as few as the line limit allows.
+     *
+     * @param keys The keys
+     * @param out Buffer to append the commands to
+     * @return The number of get commands appended
+     * @throws std::invalid_argument if a key is invalid
+     */
+    static std::size_t encodeGets(const std::vector<const std::string*>& keys, std::string& out) {
+        std::size_t commands = 0;
+        std::size_t line_start = 0;
+        bool open = false;
+        for (const std::string* key : keys) {
+            checkKey(*key);
+            if (open && out.size() - line_start + key->size() + 1 > kMaxLine) {
+                out += "\r\n";
+                open = false;
+            }
+            if (!open) {
+                line_start = out.size();
+                out += "get";
+                open = true;
+                commands++;
+            }
+            out += ' ';
+            out += *key;
+        }
+        if (open) {
+            out += "\r\n";
+        }
+        return commands;
+    }
+
+    /**
+     * Consumes the complete replies to get commands that receive() has
+     * buffered, leaving a partial reply for the next call.
+     *
+     * @param commands The most get replies to consume
+     * @param found Receives key -> value for every hit
+     * @return The number of get replies completed
+     * @throws std::runtime_error on an unexpected reply
+     */
+    std::size_t parseGets(std::size_t commands, std::unordered_map<std::string, std::string>& found) {
+        std::size_t done = 0;
+        while (done < commands) {
+            std::size_t eol = in_.find("\r\n", in_pos_);
+            if (eol == std::string::npos) {
+                break;
+            }
+            std::string line = in_.substr(in_pos_, eol - in_pos_);
+            if (line == "END") {
+                in_pos_ = eol + 2;
+                done++;
+                continue;
+            }
+            // VALUE <key> <flags> <bytes>
+            if (line.compare(0, 6, "VALUE ") != 0) {
+                throw std::runtime_error("Unexpected reply to get: " + line);
+            }
+            std::size_t key_end = line.find(' ', 6);
+            std::size_t bytes_pos = key_end == std::string::npos ? key_end : line.find(' ', key_end + 1);
+            if (bytes_pos == std::string::npos) {
+                throw std::runtime_error("Malformed VALUE line: " + line);
+            }
+            std::size_t bytes = std::strtoull(line.c_str() + bytes_pos + 1, nullptr, 10);
+            std::size_t data = eol + 2;
+            std::size_t available = in_.size() - data;
+            if (available < bytes || available - bytes < 2) {
+                break;  // the value has not all arrived
+            }
+            found[line.substr(6, key_end - 6)] = in_.substr(data, bytes);
+            in_pos_ = data + bytes + 2;
+        }
+        return done;
+    }
+
+    /**
+     * Appends a set command.
+     *
+     * @param key The key
+     * @param value The value
+     * @param exptime memcached expiry: 0 = never, seconds or unix time
+     * @param out Buffer to append the command to
+     * @throws std::invalid_argument if the key is invalid
+     */
+    static void encodeSet(const std::string& key, const std::string& value, std::int64_t exptime,
+                          std::string& out) {
+        checkKey(key);
+        out += "set ";
+        out += key;
+        out += " 0 ";
+        out += std::to_string(exptime);
+        out += ' ';
+        out += std::to_string(value.size());
+        out += "\r\n";
+        out += value;
+        out += "\r\n";
+    }
+
+    /**
+     * Consumes the replies to set commands that receive() has buffered.
+     *
+     * @param commands The most set replies to consume
+     * @return The number of set replies consumed
+     * @throws std::runtime_error if a set was not stored
+     */
+    std::size_t parseSets(std::size_t commands) {
+        std::size_t done = 0;
+        while (done < commands) {
+            std::size_t eol = in_.find("\r\n", in_pos_);
+            if (eol == std::string::npos) {
+                break;
+            }
+            std::string line = in_.substr(in_pos_, eol - in_pos_);
+            in_pos_ = eol + 2;
+            if (line != "STORED") {
+                throw std::runtime_error("Set failed: " + line);
+            }
+            done++;
+        }
+        return done;
+    }
+
+    /**
+     * Deletes a key.
+     *
+     * @param key The key
+     * @return true if the server held the key
+     * @throws std::system_error on connection failure
+     * @throws std::runtime_error on an unexpected reply
+     */
+    bool remove(const std::string& key) {
+        checkKey(key);
+        sendAll("delete " + key + "\r\n");
+        std::string line = readLine();
+        if (line != "DELETED" && line != "NOT_FOUND") {
+            throw std::runtime_error("Delete failed: " + line);
+        }
+        return line == "DELETED";
+    }
+};
+
+/**
+ * Client that spreads keys over several cache server processes with
+ * rendezvous (highest random weight) hashing.
+ *
+ * Every key goes to the node with the highest score hash(key, node id).
+ * Adding a node moves only the keys it now wins, about 1 / n of them, and
+ * removing one moves only its own keys; every other key keeps its node.
+ * Clients that list the same node ids agree on placement without talking
+ * to each other. Keys and node ids are hashed with FNV-1a, so placement
+ * does not depend on the standard library.
+ *
+ * Each node has one persistent connection, opened on first use. Multi-key
+ * calls group keys by node, use one multi-key get per node, and poll every
+ * node's connection at once, sending and reading as each socket allows,
+ * so a getMulti() over n nodes costs about one round trip and a batch
+ * larger than the socket buffers still drains. A connection that fails is
+ * dropped and reopened by the next call; the failing call throws.
+ *
+ * Not thread-safe: give each thread its own client.
+ */
+class CacheClusterClient {
+private:
+    struct Node {
+        CacheNode address;
+        std::string id;
+        std::uint64_t seed;
+        std::unique_ptr<MemcachedConnection> connection;
+    };
+
+    std::vector<Node> nodes_;
+
+    static std::uint64_t fnv1a(const std::string& s) {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    static std::uint64_t score(std::uint64_t key_hash, std::uint64_t seed) {
+        return fmix64(key_hash ^ seed);
+    }
+
+    std::size_t nodeIndex(const std::string& key) const {
+        if (nodes_.empty()) {
+            throw std::logic_error("Cache cluster has no nodes");
+        }
+        std::uint64_t key_hash = fnv1a(key);
+        std::size_t best = 0;
+        std::uint64_t best_score = score(key_hash, nodes_[0].seed);
+        for (std::size_t i = 1; i < nodes_.size(); i++) {
+            std::uint64_t s = score(key_hash, nodes_[i].seed);
+            if (s > best_score || (s == best_score && nodes_[i].id < nodes_[best].id)) {
+                best = i;
+                best_score = s;
+            }
+        }
+        return best;
+    }
+
+    MemcachedConnection& connection(Node& node) {
+        if (!node.connection) {
+            node.connection = std::make_unique<MemcachedConnection>(node.address);
+        }
+        return *node.connection;
+    }
+
+    /**
+     * Runs fn on a node's connection, dropping the connection if fn fails
+     * with a connection or protocol error, since its stream may be out of step.
+     */
+    template <typename F>
+    auto withConnection(Node& node, F&& fn) -> decltype(fn(std::declval<MemcachedConnection&>())) {
+        try {
+            return fn(connection(node));
+        } catch (const std::system_error&) {
+            node.connection.reset();
+            throw;
+        } catch (const std::runtime_error&) {
+            node.connection.reset();
+            throw;
+        }
+    }
+
+    /**
+     * Sends each node with commands[i] > 0 the batch out[i] and consumes
+     * its commands[i] replies with parse(connection, most), which returns
+     * how many it completed. All nodes are polled together, each sending
+     * while its socket has room and reading whatever has arrived, so no
+     * node waits on a reply buffer that nobody drains. If a node fails,
+     * the other nodes' batches still run to completion so that their
+     * connections stay in step. The failed node's connection is dropped
+     * and the first error is rethrown.
+     */
+    template <typename Parse>
+    void pipeline(std::vector<std::string>& out, const std::vector<std::size_t>& commands, Parse&& parse) {
+        std::exception_ptr error;
+        std::vector<std::size_t> owed(commands);
+        auto fail = [this, &error, &owed](std::size_t i) {
+            owed[i] = 0;
+            nodes_[i].connection.reset();
+            if (!error) {
+                error = std::current_exception();
+            }
+        };
+        for (std::size_t i = 0; i < nodes_.size(); i++) {
+            if (owed[i] == 0) {
+                continue;
+            }
+            try {
+                withConnection(nodes_[i], [&](MemcachedConnection& c) { c.begin(std::move(out[i])); });
+            } catch (...) {
+                fail(i);
+            }
+        }
+        std::vector<pollfd> fds;
+        std::vector<std::size_t> polled;
+        while (true) {
+            fds.clear();
+            polled.clear();
+            for (std::size_t i = 0; i < nodes_.size(); i++) {
+                if (owed[i] > 0) {
+                    MemcachedConnection& c = *nodes_[i].connection;
+                    short events = c.sending() ? POLLIN | POLLOUT : POLLIN;
+                    fds.push_back(pollfd{c.fd(), events, 0});
+                    polled.push_back(i);
+                }
+            }
+            if (fds.empty()) {
+                break;
+            }
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                for (std::size_t i : polled) {
+                    nodes_[i].connection.reset();
+                }
+                throw std::system_error(errno, std::generic_category(), "poll");
+            }
+            for (std::size_t k = 0; k < fds.size(); k++) {
+                if (fds[k].revents == 0) {
+                    continue;
+                }
+                std::size_t i = polled[k];
+                try {
+                    withConnection(nodes_[i], [&](MemcachedConnection& c) {
+                        if (c.sending()) {
+                            c.flush();
+                        }
+                        bool open = c.receive();
+                        owed[i] -= parse(c, owed[i]);
+                        if (!open && owed[i] > 0) {
+                            throw std::system_error(ECONNRESET, std::generic_category(), "recv");
+                        }
+                    });
+                } catch (...) {
+                    fail(i);
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+public:
+    /**
+     * Initializes a client. Connections are opened on first use.
+     *
+     * @param nodes The cache servers
+     * @throws std::invalid_argument if two nodes have the same id
+     */
+    explicit CacheClusterClient(const std::vector<CacheNode>& nodes = {}) {
+        for (const CacheNode& node : nodes) {
+            addNode(node);
+        }
+    }
+
+    /**
+     * Adds a node. Only keys it now wins move to it.
+     *
+     * @param node The cache server
+     * @throws std::invalid_argument if a node with the same id exists
+     */
+    void addNode(const CacheNode& node) {
+        std::string id = node.id();
+        for (const Node& existing : nodes_) {
+            if (existing.id == id) {
+                throw std::invalid_argument("Duplicate cache node: " + id);
+            }
+        }
+        nodes_.push_back(Node{node, id, fnv1a(id), nullptr});
+    }
+
+    /**
+     * Removes a node and closes its connection. Only its keys move.
+     *
+     * @param id The node's id()
+     * @return true if the node was present
+     */
+    bool removeNode(const std::string& id) {
+        auto it = std::find_if(nodes_.begin(), nodes_.end(), [&id](const Node& n) { return n.id == id; });
+        if (it == nodes_.end()) {
+            return false;
+        }
+        nodes_.erase(it);
+        return true;
+    }
+
+    /**
+     * @return The ids of all nodes, in the order they were added
+     */
+    std::vector<std::string> nodeIds() const {
+        std::vector<std::string> ids;
+        for (const Node& node : nodes_) {
+            ids.push_back(node.id);
+        }
+        return ids;
+    }
+
+    /**
+     * Returns the node that owns a key.
+     *
+     * @param key The key
+     * @return The owning node's id
+     * @throws std::logic_error if there are no nodes
+     */
+    std::string nodeFor(const std::string& key) const {
+        return nodes_[nodeIndex(key)].id;
+    }
+
+    /**
+     * Retrieves one value.
+     *
+     * @param key The key
+     * @return The value, or nullopt on a miss
+     * @throws std::system_error if the node cannot be reached
+     * @throws std::logic_error if there are no nodes
+     */
+    std::optional<std::string> get(const std::string& key) {
+        auto found = getMulti({key});
+        auto it = found.find(key);
+        if (it == found.end()) {
+            return std::nullopt;
+        }
+        return std::move(it->second);
+    }
+
+    /**
+     * Retrieves many values with one multi-key get per node, all nodes'
+     * requests in flight together.
+     *
+     * @param keys The keys
+     * @return key -> value for every hit
+     * @throws std::system_error if a node cannot be reached
+     * @throws std::logic_error if there are no nodes
+     */
+    std::unordered_map<std::string, std::string> getMulti(const std::vector<std::string>& keys) {
+        std::unordered_map<std::string, std::string> found;
+        if (keys.empty()) {
+            return found;
+        }
+        std::vector<std::vector<const std::string*>> by_node(nodes_.size());
+        for (const std::string& key : keys) {
+            by_node[nodeIndex(key)].push_back(&key);
+        }
+        std::vector<std::string> out(nodes_.size());
+        std::vector<std::size_t> commands(nodes_.size(), 0);
+        for (std::size_t i = 0; i < nodes_.size(); i++) {
+            if (!by_node[i].empty()) {
+                commands[i] = MemcachedConnection::encodeGets(by_node[i], out[i]);
+            }
+        }
+        pipeline(out, commands,
+                 [&found](MemcachedConnection& c, std::size_t most) { return c.parseGets(most, found); });
+        return found;
+    }
+
+    /**
+     * Stores one value.
+     *
+     * @param key The key
+     * @param value The value
+     * @param exptime memcached expiry: 0 = never, seconds or unix time
+     * @throws std::system_error if the node cannot be reached
+     * @throws std::runtime_error if the server refuses the value
+     */
+    void set(const std::string& key, const std::string& value, std::int64_t exptime = 0) {
+        setMulti({{key, value}}, exptime);
+    }
+
+    /**
+     * Stores many values, pipelined per node with all nodes in flight
+     * together.
+     *
+     * @param items (key, value) pairs
+     * @param exptime memcached expiry for every item
+     * @throws std::system_error if a node cannot be reached
+     * @throws std::runtime_error if a server refuses a value
+     */
+    void setMulti(const std::vector<std::pair<std::string, std::string>>& items, std::int64_t exptime = 0) {
+        if (items.empty()) {
+            return;
+        }
+        std::vector<std::string> out(nodes_.size());
+        std::vector<std::size_t> commands(nodes_.size(), 0);
+        for (const auto& item : items) {
+            std::size_t i = nodeIndex(item.first);
+            MemcachedConnection::encodeSet(item.first, item.second, exptime, out[i]);
+            commands[i]++;
+        }
+        pipeline(out, commands, [](MemcachedConnection& c, std::size_t most) { return c.parseSets(most); });
+    }
+
+    /**
+     * Deletes a key from its node.
+     *
+     * @param key The key
+     * @return true if the node held the key
+     * @throws std::system_error if the node cannot be reached
+     */
+    bool remove(const std::string& key) {
+        Node& node = nodes_[nodeIndex(key)];
+        return withConnection(node, [&key](MemcachedConnection& c) { return c.remove(key); });
+    }
+};
+
+#endif // CACHE_CLUSTER_CLIENT_H
@@ -0,0 +1,419 @@
+#include "CacheClusterClient.h"
+#include "MemcachedProtocol.h"
+#include <iostream>
+#include <cassert>
+#include <csignal>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Test cases for CacheClusterClient, against cache server processes
+ * forked by the test.
+ *
+ * Tests cover:
+ * - Round trips, multi-get and multi-set across nodes
+ * - Minimal key movement when a node joins or leaves
+ * - Large batches split into several pipelined gets
+ * - A failed node raising errors until it is removed
+ * - A node failing in a batch leaving the other connections in step
+ * - Replies already parsed not staying buffered for the rest of a batch
+ * - A batch larger than the socket buffers and the server's output cap
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CacheClusterClientTest.cpp -o cache_cluster_client_test
+ */
+
+namespace {
+
+/**
+ * A cache server in a child process on an ephemeral loopback port.
+ */
+class ServerProcess {
+private:
+    pid_t pid_ = -1;
+    int port_ = 0;
+
+public:
+    ServerProcess() {
+        int fds[2];
+        assert(::pipe(fds) == 0);
+        pid_ = ::fork();
+        assert(pid_ >= 0);
+        if (pid_ == 0) {
+            ::close(fds[0]);
+            sigset_t mask;
+            sigemptyset(&mask);
+            sigaddset(&mask, SIGTERM);
+            ::sigprocmask(SIG_BLOCK, &mask, nullptr);  // inherited by the event loops
+            ServerConfig config;
+            config.tcp_port = 0;
+            config.threads = 1;
+            MemcachedStore store(100000, 8);
+            EpollServer server(config, [&store]() { return std::make_unique<MemcachedSession>(store); });
+            server.start();
+            int port = server.tcpPort();
+            ssize_t written = ::write(fds[1], &port, sizeof(port));
+            (void)written;
+            int sig;
+            sigwait(&mask, &sig);
+            server.stop();
+            ::_exit(0);
+        }
+        ::close(fds[1]);
+        ssize_t n = ::read(fds[0], &port_, sizeof(port_));
+        assert(n == sizeof(port_));
+        ::close(fds[0]);
+    }
+
+    ServerProcess(const ServerProcess&) = delete;
+    ServerProcess& operator=(const ServerProcess&) = delete;
+
+    ~ServerProcess() {
+        ::kill(pid_, SIGTERM);
+        int status;
+        ::waitpid(pid_, &status, 0);
+    }
+
+    CacheNode node() const {
+        CacheNode node;
+        node.port = port_;
+        return node;
+    }
+};
+
+} // namespace
+
+void testRoundTrips() {
+    std::cout << "Test 1: Round trips, multi-get and multi-set" << std::endl;
+    ServerProcess a, b, c;
+    CacheClusterClient client({a.node(), b.node(), c.node()});
+
+    client.set("alpha", "1");
+    client.set("binary", std::string("x\r\ny\0z", 6));
+    assert(client.get("alpha") == std::string("1"));
+    assert(client.get("binary") == std::string("x\r\ny\0z", 6));
+    assert(!client.get("missing").has_value());
+
+    std::vector<std::pair<std::string, std::string>> items;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 300; i++) {
+        items.emplace_back("key" + std::to_string(i), "value" + std::to_string(i));
+        keys.push_back("key" + std::to_string(i));
+    }
+    client.setMulti(items);
+    keys.push_back("missing");
+    auto found = client.getMulti(keys);
+    assert(found.size() == 300);
+    for (int i = 0; i < 300; i++) {
+        assert(found["key" + std::to_string(i)] == "value" + std::to_string(i));
+    }
+
+    // Every node got a share of the keys.
+    for (const std::string& id : client.nodeIds()) {
+        int owned = 0;
+        for (int i = 0; i < 300; i++) {
+            owned += client.nodeFor(keys[i]) == id;
+        }
+        assert(owned > 50);
+    }
+
+    assert(client.remove("alpha"));
+    assert(!client.remove("alpha"));
+    assert(!client.get("alpha").has_value());
+
+    bool threw = false;
+    try {
+        client.set("bad key", "v");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMinimalRebalancing() {
+    std::cout << "Test 2: Only about 1/n of the keys move on join and leave" << std::endl;
+    std::vector<CacheNode> nodes;
+    for (int port = 20000; port < 20005; port++) {
+        CacheNode node;
+        node.port = port;
+        nodes.push_back(node);
+    }
+    CacheClusterClient four({nodes[0], nodes[1], nodes[2], nodes[3]});
+    CacheClusterClient five(nodes);
+    const int kKeys = 20000;
+    int moved = 0;
+    for (int i = 0; i < kKeys; i++) {
+        std::string key = "user:" + std::to_string(i);
+        std::string before = four.nodeFor(key);
+        std::string after = five.nodeFor(key);
+        if (before != after) {
+            // A join only moves keys to the new node.
+            assert(after == nodes[4].id());
+            moved++;
+        }
+    }
+    std::cout << "  Moved on join: " << moved << " of " << kKeys << std::endl;
+    assert(moved > kKeys / 5 * 0.9 && moved < kKeys / 5 * 1.1);
+
+    // A leave only moves the leaving node's keys.
+    assert(five.removeNode(nodes[1].id()));
+    assert(!five.removeNode(nodes[1].id()));
+    for (int i = 0; i < kKeys; i++) {
+        std::string key = "user:" + std::to_string(i);
+        std::string before = four.nodeFor(key);
+        if (before != nodes[1].id()) {
+            std::string owner = five.nodeFor(key);
+            assert(owner == before || owner == nodes[4].id());
+        }
+    }
+
+    // Placement depends only on the node set, not the order nodes were added.
+    CacheClusterClient reversed({nodes[3], nodes[2], nodes[1], nodes[0]});
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "user:" + std::to_string(i);
+        assert(reversed.nodeFor(key) == four.nodeFor(key));
+    }
+
+    bool threw = false;
+    try {
+        four.addNode(nodes[0]);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testLargeBatches() {
+    std::cout << "Test 3: Large batches split into several pipelined gets" << std::endl;
+    ServerProcess a, b;
+    CacheClusterClient client({a.node(), b.node()});
+
+    // 5000 keys of ~200 bytes need many get lines per node.
+    std::vector<std::pair<std::string, std::string>> items;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; i++) {
+        std::string key = std::string(190, 'k') + std::to_string(i);
+        items.emplace_back(key, std::string(i % 50, 'v') + std::to_string(i));
+        keys.push_back(key);
+    }
+    client.setMulti(items);
+    auto found = client.getMulti(keys);
+    assert(found.size() == items.size());
+    for (const auto& item : items) {
+        assert(found[item.first] == item.second);
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testFailedNode() {
+    std::cout << "Test 4: A failed node raises errors until it is removed" << std::endl;
+    ServerProcess a;
+    auto b = std::make_unique<ServerProcess>();
+    CacheNode b_node = b->node();
+    CacheClusterClient client({a.node(), b_node});
+
+    std::string on_b;
+    for (int i = 0; on_b.empty(); i++) {
+        std::string key = "k" + std::to_string(i);
+        if (client.nodeFor(key) == b_node.id()) {
+            on_b = key;
+        }
+    }
+    client.set(on_b, "v");
+    assert(client.get(on_b) == std::string("v"));
+
+    b.reset();
+    bool threw = false;
+    try {
+        client.get(on_b);
+    } catch (const std::system_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Dropping the dead node sends its keys to the survivor.
+    assert(client.removeNode(b_node.id()));
+    assert(client.nodeFor(on_b) == a.node().id());
+    assert(!client.get(on_b).has_value());
+    client.set(on_b, "w");
+    assert(client.get(on_b) == std::string("w"));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+/**
+ * Returns a key owned by the given node.
+ */
+static std::string keyOn(const CacheClusterClient& client, const std::string& id, const std::string& prefix) {
+    for (int i = 0;; i++) {
+        std::string key = prefix + std::to_string(i);
+        if (client.nodeFor(key) == id) {
+            return key;
+        }
+    }
+}
+
+void testFailedNodeInBatch() {
+    std::cout << "Test 5: A node failing in a batch leaves the others in step" << std::endl;
+    ServerProcess a, c;
+    auto b = std::make_unique<ServerProcess>();
+    CacheNode b_node = b->node();
+    CacheClusterClient client({a.node(), b_node, c.node()});
+
+    std::vector<std::string> keys;
+    for (const std::string& id : client.nodeIds()) {
+        for (int i = 0; i < 4; i++) {
+            keys.push_back(keyOn(client, id, "n" + std::to_string(i) + "-"));
+        }
+    }
+    std::vector<std::pair<std::string, std::string>> items;
+    for (const std::string& key : keys) {
+        items.emplace_back(key, "old-" + key);
+    }
+    client.setMulti(items);  // opens a connection to every node
+    b.reset();
+
+    for (int round = 0; round < 2; round++) {
+        bool threw = false;
+        try {
+            client.getMulti(keys);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        threw = false;
+        for (auto& item : items) {
+            item.second = "new" + std::to_string(round) + "-" + item.first;
+        }
+        try {
+            client.setMulti(items);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // The healthy nodes answer their own requests, not replies left over
+    // from the failed batches.
+    assert(client.removeNode(b_node.id()));
+    std::vector<std::string> healthy;
+    for (const std::string& key : keys) {
+        if (client.nodeFor(key) != b_node.id()) {
+            client.set(key, "fresh-" + key);
+            assert(client.get(key) == "fresh-" + key);
+            healthy.push_back(key);
+        }
+    }
+    auto found = client.getMulti(healthy);
+    assert(found.size() == healthy.size());
+    for (const std::string& key : healthy) {
+        assert(found[key] == "fresh-" + key);
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+#ifdef __SANITIZE_ADDRESS__
+// AddressSanitizer's quarantine keeps freed blocks resident, so peak RSS
+// says nothing about what the client retains.
+constexpr bool kMeasureRss = false;
+#else
+constexpr bool kMeasureRss = true;
+#endif
+
+/**
+ * Returns the peak resident set size of this process, in KiB.
+ */
+static long peakRssKiB() {
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void testRepliesNotRetained() {
+    std::cout << "Test 6: Parsed replies are not kept for the rest of a batch" << std::endl;
+    ServerProcess a;
+    CacheClusterClient client({a.node()});
+    std::vector<std::string> keys;
+    for (int i = 0; i < 4; i++) {
+        std::string key = "big" + std::to_string(i);
+        client.set(key, std::string(256 * 1024, static_cast<char>('a' + i)));
+        for (int r = 0; r < 150; r++) {
+            keys.push_back(key);
+        }
+    }
+    // 600 requests for 4 values: about 150 MiB of replies for 1 MiB of
+    // results. Run the batch in a child, whose peak RSS starts near the
+    // current size rather than at this process's earlier peak.
+    pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        long before = peakRssKiB();
+        auto found = client.getMulti(keys);
+        long grown = peakRssKiB() - before;
+        bool ok = found.size() == 4 && found["big3"] == std::string(256 * 1024, 'd');
+        ::_exit(ok && (!kMeasureRss || grown < 64 * 1024) ? 0 : 1);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testBatchBeyondOutputCap() {
+    std::cout << "Test 7: A batch larger than the socket buffers and output cap" << std::endl;
+    ServerProcess a;
+    CacheClusterClient client({a.node()});
+
+    // 2000 keys of 240 bytes with 1 KiB values, each asked for 80 times:
+    // about 38 MiB of gets for about 200 MiB of replies, far past the
+    // server's 4 MiB output cap, after which it stops reading. A client
+    // that wrote its whole batch before reading would never finish.
+    std::vector<std::pair<std::string, std::string>> items;
+    for (int i = 0; i < 2000; i++) {
+        std::string id = std::to_string(i);
+        items.emplace_back(std::string(240 - id.size(), 'k') + id, std::string(1024 - id.size(), 'v') + id);
+    }
+    client.setMulti(items);
+    std::vector<std::string> keys;
+    for (int r = 0; r < 80; r++) {
+        for (const auto& item : items) {
+            keys.push_back(item.first);
+        }
+    }
+    auto found = client.getMulti(keys);
+    assert(found.size() == items.size());
+    for (const auto& item : items) {
+        assert(found[item.first] == item.second);
+    }
+
+    // The same for sets: 160000 sets of 1 KiB, 8 bytes of reply each.
+    std::vector<std::pair<std::string, std::string>> many;
+    for (int r = 0; r < 80; r++) {
+        for (const auto& item : items) {
+            many.emplace_back(item.first, item.second + std::to_string(r));
+        }
+    }
+    client.setMulti(many);
+    assert(client.get(items[7].first) == items[7].second + "79");
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Cache Cluster Client Tests...\n" << std::endl;
+
+    testRoundTrips();
+    testMinimalRebalancing();
+    testLargeBatches();
+    testFailedNode();
+    testFailedNodeInBatch();
+    testRepliesNotRetained();
+    testBatchBeyondOutputCap();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Closed-loop load generator for the memcached-protocol cache server.
+ *
+ * Each thread owns one connection and sends batches of `--pipeline`
+ * requests, then waits for every response. Latency is recorded per request
+ * as the round trip of the batch it travelled in, so pipelining shows up
+ * as higher latency in exchange for higher QPS.
+ *
+ * Usage:
+ *   cache_server_bench [--host 127.0.0.1] [--port 11211 | --unix PATH]
+ *                      [--threads 4] [--pipeline 16] [--seconds 10]
+ *                      [--keys 100000] [--value-size 100] [--get-ratio 0.9]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CacheServerBenchmark.cpp -o cache_server_bench
+ */
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 11211;
+    std::string unix_path;
+    int threads = 4;
+    int pipeline = 16;
+    int seconds = 10;
+    int keys = 100000;
+    int value_size = 100;
+    double get_ratio = 0.9;
+};
+
+int connectTo(const Options& opts) {
+    int fd;
+    if (!opts.unix_path.empty()) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, opts.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+    } else {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(opts.port));
+        ::inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& buf) {
+    std::size_t off = 0;
+    while (off < buf.size()) {
+        ssize_t n = ::send(fd, buf.data() + off, buf.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        off += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Counts complete responses at the front of `buf`, returning how many
+ * bytes they span. A get response ends at END; everything else is one line.
+ */
+std::size_t countResponses(const std::string& buf, int& completed) {
+    std::size_t pos = 0;
+    std::size_t last_complete = 0;
+    while (true) {
+        std::size_t eol = buf.find("\r\n", pos);
+        if (eol == std::string::npos) {
+            break;
+        }
+        if (buf.compare(pos, 6, "VALUE ") == 0) {
+            // "VALUE key flags bytes [cas]": bytes is the 4th token.
+            std::size_t t = pos;
+            for (int i = 0; i < 3; i++) {
+                t = buf.find(' ', t) + 1;
+            }
+            std::size_t bytes = std::strtoul(buf.c_str() + t, nullptr, 10);
+            std::size_t data_end = eol + 2 + bytes + 2;
+            if (data_end > buf.size()) {
+                break;
+            }
+            pos = data_end;
+            continue;
+        }
+        pos = eol + 2;
+        completed++;
+        last_complete = pos;
+    }
+    return last_complete;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    std::size_t idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--host") opts.host = val;
+        else if (arg == "--port") opts.port = std::stoi(val);
+        else if (arg == "--unix") opts.unix_path = val;
+        else if (arg == "--threads") opts.threads = std::stoi(val);
+        else if (arg == "--pipeline") opts.pipeline = std::stoi(val);
+        else if (arg == "--seconds") opts.seconds = std::stoi(val);
+        else if (arg == "--keys") opts.keys = std::stoi(val);
+        else if (arg == "--value-size") opts.value_size = std::stoi(val);
+        else if (arg == "--get-ratio") opts.get_ratio = std::stod(val);
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    const std::string value(static_cast<std::size_t>(opts.value_size), 'x');
+
+    // Preload so gets mostly hit.
+    {
+        int fd = connectTo(opts);
+        if (fd < 0) {
+            std::cerr << "cannot connect to server" << std::endl;
+            return 1;
+        }
+        std::string batch;
+        std::string in;
+        char buf[65536];
+        for (int k = 0; k < opts.keys; k++) {
+            batch += "set key:" + std::to_string(k) + " 0 0 " + std::to_string(value.size()) +
+                     " noreply\r\n" + value + "\r\n";
+            if (batch.size() > 1 << 20 || k + 1 == opts.keys) {
+                sendAll(fd, batch);
+                batch.clear();
+            }
+        }
+        // Round-trip a version command so the preload is applied before timing.
+        sendAll(fd, "version\r\n");
+        while (in.find("\r\n") == std::string::npos) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            in.append(buf, static_cast<std::size_t>(n));
+        }
+        ::close(fd);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<uint64_t>> latencies(opts.threads);
+    std::vector<uint64_t> errors(opts.threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < opts.threads; t++) {
+        workers.emplace_back([&, t]() {
+            int fd = connectTo(opts);
+            if (fd < 0) {
+                errors[t]++;
+                return;
+            }
+            std::mt19937_64 rng(static_cast<uint64_t>(t) * 7919 + 1);
+            std::uniform_int_distribution<int> key_dist(0, opts.keys - 1);
+            std::uniform_real_distribution<double> op_dist(0.0, 1.0);
+            std::string batch;
+            std::string in;
+            char buf[65536];
+            auto& lat = latencies[t];
+            lat.reserve(1 << 20);
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                batch.clear();
+                for (int i = 0; i < opts.pipeline; i++) {
+                    std::string key = "key:" + std::to_string(key_dist(rng));
+                    if (op_dist(rng) < opts.get_ratio) {
+                        batch += "get " + key + "\r\n";
+                    } else {
+                        batch += "set " + key + " 0 0 " + std::to_string(value.size()) + "\r\n" +
+                                 value + "\r\n";
+                    }
+                }
+                auto start = std::chrono::steady_clock::now();
+                if (!sendAll(fd, batch)) {
+                    errors[t]++;
+                    break;
+                }
+                int completed = 0;
+                while (completed < opts.pipeline) {
+                    ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+                    if (n <= 0) {
+                        errors[t]++;
+                        stop.store(true);
+                        break;
+                    }
+                    in.append(buf, static_cast<std::size_t>(n));
+                    std::size_t used = countResponses(in, completed);
+                    in.erase(0, used);
+                }
+                uint64_t rtt = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+                for (int i = 0; i < completed; i++) {
+                    lat.push_back(rtt);
+                }
+            }
+            ::close(fd);
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opts.seconds));
+    stop.store(true);
+    for (auto& w : workers) {
+        w.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<uint64_t> all;
+    uint64_t total_errors = 0;
+    for (int t = 0; t < opts.threads; t++) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        total_errors += errors[t];
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "requests:   " << all.size() << " in " << elapsed << "s ("
+              << total_errors << " connection errors)\n";
+    std::cout << "throughput: " << static_cast<double>(all.size()) / elapsed << " ops/s\n";
+    std::cout << "latency us: p50=" << percentile(all, 0.50) / 1000.0
+              << " p90=" << percentile(all, 0.90) / 1000.0
+              << " p99=" << percentile(all, 0.99) / 1000.0
+              << " p99.9=" << percentile(all, 0.999) / 1000.0
+              << " max=" << (all.empty() ? 0 : all.back()) / 1000.0 << std::endl;
+    return total_errors == 0 ? 0 : 1;
+}
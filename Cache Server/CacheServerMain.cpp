@@ -0,0 +1,114 @@
+#include "MemcachedProtocol.h"
+#include "IoUringServer.h"
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+/**
+ * Standalone memcached-compatible cache server backed by ShardedLRUCache.
+ *
+ * Usage:
+ *   cache_server [--host 127.0.0.1] [--port 11211 | --no-tcp] [--unix PATH]
+ *                [--threads N] [--capacity N] [--shards N]
+ *                [--backend epoll|io_uring]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CacheServerMain.cpp -o cache_server
+ */
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--host ADDR] [--port N | --no-tcp] [--unix PATH]"
+                 " [--threads N] [--capacity N] [--shards N] [--backend epoll|io_uring]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    int capacity = 1'000'000;
+    int shards = 64;
+    std::string backend = "epoll";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--host") {
+            config.tcp_host = next();
+        } else if (arg == "--port") {
+            config.tcp_port = std::stoi(next());
+        } else if (arg == "--no-tcp") {
+            config.tcp_port = -1;
+        } else if (arg == "--unix") {
+            config.unix_path = next();
+        } else if (arg == "--threads") {
+            config.threads = std::stoi(next());
+        } else if (arg == "--capacity") {
+            capacity = std::stoi(next());
+        } else if (arg == "--shards") {
+            shards = std::stoi(next());
+        } else if (arg == "--backend") {
+            backend = next();
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    MemcachedStore store(capacity, shards);
+    SessionFactory factory = [&store]() {
+        return std::make_unique<MemcachedSession>(store);
+    };
+    std::unique_ptr<NetworkServer> server;
+    if (backend == "epoll") {
+        server = std::make_unique<EpollServer>(config, factory);
+    } else if (backend == "io_uring") {
+        server = std::make_unique<IoUringServer>(config, factory);
+    } else {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        server->start();
+    } catch (const std::exception& e) {
+        std::cerr << "cache_server: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "cache_server: " << backend << ", " << server->loopCount() << " event loops";
+    if (server->tcpPort() >= 0) {
+        std::cout << ", tcp " << config.tcp_host << ":" << server->tcpPort();
+    }
+    if (!config.unix_path.empty()) {
+        std::cout << ", unix " << config.unix_path;
+    }
+    std::cout << ", capacity " << capacity << " in " << store.cache().shardCount()
+              << " shards" << std::endl;
+
+    while (!g_stop) {
+        ::pause();
+    }
+    server->stop();
+    return 0;
+}
@@ -0,0 +1,577 @@
+#ifndef EPOLL_SERVER_H
+#define EPOLL_SERVER_H
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <system_error>
+#include <stdexcept>
+
+/**
+ * A stateful protocol handler bound to one client connection.
+ *
+ * The server hands it every byte received and sends back whatever it
+ * appends to the output buffer, so one read can carry many pipelined
+ * requests and one write carries all of their responses.
+ */
+class ProtocolSession {
+public:
+    virtual ~ProtocolSession() = default;
+
+    /**
+     * Consumes as many complete requests as possible, stopping before the
+     * next request once out holds out_limit bytes or more. The server keeps
+     * the rest buffered and calls again once the client has read enough of
+     * the output.
+     *
+     * @param data Pointer to the unconsumed input bytes
+     * @param len Number of unconsumed input bytes
+     * @param out Buffer to append responses to
+     * @param out_limit Size of out at which to stop taking requests
+     * @return The number of input bytes consumed (partial requests stay buffered)
+     */
+    virtual std::size_t onData(const char* data, std::size_t len, std::string& out,
+                               std::size_t out_limit) = 0;
+
+    /**
+     * @return true once the connection should be closed after flushing output
+     */
+    virtual bool shouldClose() const { return false; }
+};
+
+using SessionFactory = std::function<std::unique_ptr<ProtocolSession>()>;
+
+/**
+ * Control surface shared by the network back-ends (epoll, io_uring), so a
+ * binary can choose one at startup.
+ */
+class NetworkServer {
+public:
+    virtual ~NetworkServer() = default;
+
+    /**
+     * Binds all listeners and starts the event-loop threads.
+     */
+    virtual void start() = 0;
+
+    /**
+     * Stops all event loops, closes every connection and listener.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @return The bound TCP port, or -1 if TCP is disabled
+     */
+    virtual int tcpPort() const = 0;
+
+    /**
+     * @return The number of event loops
+     */
+    virtual int loopCount() const = 0;
+};
+
+/**
+ * Listener and event-loop configuration shared by the network front-ends.
+ */
+struct ServerConfig {
+    std::string tcp_host = "127.0.0.1";
+    int tcp_port = 11211;              // -1 disables TCP, 0 picks an ephemeral port
+    std::string unix_path;             // empty disables the Unix socket
+    int threads = 0;                   // 0 means one loop per hardware thread
+    int backlog = 1024;
+    std::size_t max_input_buffer = 4 * 1024 * 1024;   // per-connection cap
+    std::size_t max_output_buffer = 4 * 1024 * 1024;  // unsent replies before reading pauses
+};
+
+namespace net_detail {
+
+inline void throwErrno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline void setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throwErrno("fcntl(O_NONBLOCK)");
+    }
+}
+
+/**
+ * Opens a TCP listener with SO_REUSEPORT so every event loop can own one
+ * and the kernel spreads incoming connections across them.
+ */
+inline int listenTcp(const std::string& host, int port, int backlog) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throwErrno("socket(AF_INET)");
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+        ::close(fd);
+        throwErrno("setsockopt(SO_REUSEPORT)");
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        ::close(fd);
+        throw std::invalid_argument("Invalid IPv4 address: " + host);
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, backlog) < 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        throwErrno("bind/listen(tcp)");
+    }
+    return fd;
+}
+
+inline int boundPort(int fd) {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        throwErrno("getsockname");
+    }
+    return ntohs(addr.sin_port);
+}
+
+inline int listenUnix(const std::string& path, int backlog) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throwErrno("socket(AF_UNIX)");
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        ::close(fd);
+        throw std::invalid_argument("Unix socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, backlog) < 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        throwErrno("bind/listen(unix)");
+    }
+    return fd;
+}
+
+} // namespace net_detail
+
+/**
+ * Multi-threaded epoll server with one event loop per thread.
+ *
+ * Each loop owns its own SO_REUSEPORT TCP listener, so accepts are spread
+ * by the kernel and a connection stays on the loop that accepted it for
+ * its whole life: no cross-thread handoff and no shared connection table.
+ * The Unix socket listener is shared and registered with EPOLLEXCLUSIVE so
+ * only one loop is woken per incoming connection.
+ *
+ * Sockets are edge-triggered: a readable event drains the socket, runs the
+ * session over everything buffered, and writes all responses at once.
+ * Once a client leaves max_output_buffer bytes of replies unread, the loop
+ * stops reading from it until EPOLLOUT shows the backlog draining, so the
+ * unread requests stay in the kernel and TCP pushes back on the client.
+ * When the process runs out of file descriptors, each loop frees a spare
+ * one to accept and close pending connections, rather than leave them
+ * queued on a listener that keeps reporting readable.
+ */
+class EpollServer : public NetworkServer {
+private:
+    enum class HandleKind { TcpListener, UnixListener, Wakeup, Connection };
+
+    struct Handle {
+        HandleKind kind;
+        int fd;
+    };
+
+    struct Connection : Handle {
+        std::unique_ptr<ProtocolSession> session;
+        std::string in;
+        std::string out;
+        std::size_t out_offset = 0;
+        bool want_write = false;
+    };
+
+    struct Loop {
+        int epfd = -1;
+        int wakefd = -1;
+        int tcp_listener = -1;
+        int spare_fd = -1;  // given up to shed a connection when out of descriptors
+        Handle tcp_handle{HandleKind::TcpListener, -1};
+        Handle unix_handle{HandleKind::UnixListener, -1};
+        Handle wake_handle{HandleKind::Wakeup, -1};
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+        std::thread thread;
+    };
+
+    ServerConfig config_;
+    SessionFactory factory_;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    int unix_listener_ = -1;
+    int tcp_port_ = -1;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> warned_fd_limit_{false};
+
+    static void addToEpoll(int epfd, int fd, uint32_t events, Handle* handle) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.ptr = handle;
+        if (::epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            net_detail::throwErrno("epoll_ctl(ADD)");
+        }
+    }
+
+    void closeConnection(Loop& loop, Connection* conn) {
+        ::epoll_ctl(loop.epfd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        ::close(conn->fd);
+        loop.connections.erase(conn->fd);
+    }
+
+    /**
+     * Out of descriptors, the pending connection stays queued and the
+     * level-triggered listener would wake the loop again at once. Gives up
+     * the loop's spare descriptor to accept the connection and close it,
+     * then takes the spare back. Returns false if nothing could be shed.
+     */
+    bool shedConnection(Loop& loop, int listener) {
+        if (!warned_fd_limit_.exchange(true)) {
+            std::cerr << "EpollServer: out of file descriptors, closing new connections: "
+                      << std::strerror(errno) << std::endl;
+        }
+        if (loop.spare_fd < 0) {
+            return false;
+        }
+        ::close(loop.spare_fd);
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        loop.spare_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return fd >= 0;
+    }
+
+    void acceptAll(Loop& loop, int listener, bool is_tcp) {
+        while (true) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if ((errno == EMFILE || errno == ENFILE) && shedConnection(loop, listener)) {
+                    continue;
+                }
+                // EAGAIN: drained, or another loop won the race for it.
+                return;
+            }
+            if (is_tcp) {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            auto conn = std::make_unique<Connection>();
+            conn->kind = HandleKind::Connection;
+            conn->fd = fd;
+            conn->session = factory_();
+            Connection* raw = conn.get();
+            loop.connections[fd] = std::move(conn);
+            addToEpoll(loop.epfd, fd, EPOLLIN | EPOLLRDHUP | EPOLLET, raw);
+        }
+    }
+
+    static std::size_t unsent(const Connection* conn) {
+        return conn->out.size() - conn->out_offset;
+    }
+
+    /**
+     * Writes pending output. Returns false if the connection failed.
+     */
+    bool flush(Loop& loop, Connection* conn) {
+        while (conn->out_offset < conn->out.size()) {
+            ssize_t n = ::send(conn->fd, conn->out.data() + conn->out_offset,
+                               conn->out.size() - conn->out_offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn->out_offset += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (conn->out_offset >= config_.max_output_buffer) {
+                    // Drop what was sent, so a slow reader cannot grow out forever.
+                    conn->out.erase(0, conn->out_offset);
+                    conn->out_offset = 0;
+                }
+                if (!conn->want_write) {
+                    epoll_event ev{};
+                    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    ev.data.ptr = conn;
+                    ::epoll_ctl(loop.epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+                    conn->want_write = true;
+                }
+                return true;
+            }
+            return false;
+        }
+        conn->out.clear();
+        conn->out_offset = 0;
+        if (conn->want_write) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+            ev.data.ptr = conn;
+            ::epoll_ctl(loop.epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+            conn->want_write = false;
+        }
+        return true;
+    }
+
+    /**
+     * Runs buffered requests and writes their replies until only a partial
+     * request is left or the unsent output reaches the cap. Returns false
+     * if the connection was closed.
+     */
+    bool process(Loop& loop, Connection* conn) {
+        while (true) {
+            bool ran = false;
+            std::size_t consumed = 0;
+            if (!conn->in.empty() && unsent(conn) < config_.max_output_buffer) {
+                // out still holds the bytes already sent, so the cap starts at out_offset.
+                ran = true;
+                consumed = conn->session->onData(conn->in.data(), conn->in.size(), conn->out,
+                                                 conn->out_offset + config_.max_output_buffer);
+                conn->in.erase(0, consumed);
+            }
+            if (!flush(loop, conn) || (conn->session->shouldClose() && conn->out.empty())) {
+                closeConnection(loop, conn);
+                return false;
+            }
+            if (conn->in.empty() || unsent(conn) >= config_.max_output_buffer || (ran && consumed == 0)) {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Reads and serves the connection until the socket is drained or the
+     * unsent output reaches the cap. Called for readable and writable
+     * events alike: after a pause, reading resumes on EPOLLOUT, because
+     * requests left in the socket raise no new edge.
+     */
+    void serve(Loop& loop, Connection* conn) {
+        char buf[64 * 1024];
+        while (true) {
+            if (!process(loop, conn)) {
+                return;
+            }
+            if (unsent(conn) >= config_.max_output_buffer) {
+                return;  // flush() armed EPOLLOUT
+            }
+            ssize_t n = ::recv(conn->fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                conn->in.append(buf, static_cast<std::size_t>(n));
+                if (conn->in.size() > config_.max_input_buffer) {
+                    closeConnection(loop, conn);
+                    return;
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            // Peer closed or failed: answer what is buffered, then close.
+            if (process(loop, conn)) {
+                closeConnection(loop, conn);
+            }
+            return;
+        }
+    }
+
+    void run(Loop& loop) {
+        std::vector<epoll_event> events(256);
+        while (running_.load(std::memory_order_relaxed)) {
+            int n = ::epoll_wait(loop.epfd, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                auto* handle = static_cast<Handle*>(events[i].data.ptr);
+                switch (handle->kind) {
+                case HandleKind::TcpListener:
+                    acceptAll(loop, handle->fd, true);
+                    break;
+                case HandleKind::UnixListener:
+                    acceptAll(loop, handle->fd, false);
+                    break;
+                case HandleKind::Wakeup:
+                    break;
+                case HandleKind::Connection: {
+                    auto* conn = static_cast<Connection*>(handle);
+                    uint32_t ev = events[i].events;
+                    if (ev & EPOLLERR) {
+                        closeConnection(loop, conn);
+                    } else {
+                        serve(loop, conn);
+                    }
+                    break;
+                }
+                }
+            }
+        }
+        for (auto& entry : loop.connections) {
+            ::close(entry.first);
+        }
+        loop.connections.clear();
+    }
+
+public:
+    /**
+     * Creates a server; no sockets are opened until start().
+     *
+     * @param config Listener and threading configuration
+     * @param factory Creates one protocol session per accepted connection
+     */
+    EpollServer(ServerConfig config, SessionFactory factory)
+        : config_(std::move(config)), factory_(std::move(factory)) {}
+
+    EpollServer(const EpollServer&) = delete;
+    EpollServer& operator=(const EpollServer&) = delete;
+
+    /**
+     * Binds all listeners and starts the event-loop threads.
+     *
+     * @throws std::system_error if a socket cannot be created or bound
+     * @throws std::invalid_argument if no listener is configured
+     */
+    void start() override {
+        if (config_.tcp_port < 0 && config_.unix_path.empty()) {
+            throw std::invalid_argument("At least one of TCP or Unix listener must be enabled");
+        }
+        int threads = config_.threads > 0 ? config_.threads
+                                          : static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) {
+            threads = 1;
+        }
+        if (!config_.unix_path.empty()) {
+            unix_listener_ = net_detail::listenUnix(config_.unix_path, config_.backlog);
+        }
+
+        int port = config_.tcp_port;
+        for (int i = 0; i < threads; i++) {
+            auto loop = std::make_unique<Loop>();
+            loop->epfd = ::epoll_create1(EPOLL_CLOEXEC);
+            loop->wakefd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (loop->epfd < 0 || loop->wakefd < 0) {
+                net_detail::throwErrno("epoll_create1/eventfd");
+            }
+            loop->spare_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            loop->wake_handle.fd = loop->wakefd;
+            addToEpoll(loop->epfd, loop->wakefd, EPOLLIN, &loop->wake_handle);
+
+            if (port >= 0) {
+                loop->tcp_listener = net_detail::listenTcp(config_.tcp_host, port, config_.backlog);
+                if (port == 0) {
+                    // Later loops join the ephemeral port the first one got.
+                    port = net_detail::boundPort(loop->tcp_listener);
+                }
+                loop->tcp_handle.fd = loop->tcp_listener;
+                addToEpoll(loop->epfd, loop->tcp_listener, EPOLLIN, &loop->tcp_handle);
+            }
+            if (unix_listener_ >= 0) {
+                loop->unix_handle.fd = unix_listener_;
+                addToEpoll(loop->epfd, unix_listener_, EPOLLIN | EPOLLEXCLUSIVE, &loop->unix_handle);
+            }
+            loops_.push_back(std::move(loop));
+        }
+        tcp_port_ = port;
+
+        running_.store(true);
+        for (auto& loop : loops_) {
+            Loop* raw = loop.get();
+            loop->thread = std::thread([this, raw]() { run(*raw); });
+        }
+    }
+
+    /**
+     * Stops all event loops, closes every connection and listener.
+     * Safe to call more than once.
+     */
+    void stop() override {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        for (auto& loop : loops_) {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(loop->wakefd, &one, sizeof(one));
+            (void)ignored;
+        }
+        for (auto& loop : loops_) {
+            if (loop->thread.joinable()) {
+                loop->thread.join();
+            }
+            if (loop->tcp_listener >= 0) {
+                ::close(loop->tcp_listener);
+            }
+            if (loop->spare_fd >= 0) {
+                ::close(loop->spare_fd);
+            }
+            ::close(loop->wakefd);
+            ::close(loop->epfd);
+        }
+        loops_.clear();
+        if (unix_listener_ >= 0) {
+            ::close(unix_listener_);
+            ::unlink(config_.unix_path.c_str());
+            unix_listener_ = -1;
+        }
+    }
+
+    /**
+     * Returns the bound TCP port (useful when configured with port 0).
+     *
+     * @return The TCP port, or -1 if TCP is disabled
+     */
+    int tcpPort() const override {
+        return tcp_port_;
+    }
+
+    /**
+     * Returns the number of event loops.
+     *
+     * @return The loop (thread) count
+     */
+    int loopCount() const override {
+        return static_cast<int>(loops_.size());
+    }
+
+    ~EpollServer() override {
+        stop();
+    }
+};
+
+#endif // EPOLL_SERVER_H
@@ -0,0 +1,809 @@
+#ifndef IO_URING_SERVER_H
+#define IO_URING_SERVER_H
+
+#include "EpollServer.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+ * Tuning knobs specific to the io_uring back-end.
+ */
+struct IoUringConfig {
+    unsigned ring_entries = 4096;       // submission queue size per loop
+    unsigned max_connections = 4096;    // registered (fixed) file slots per loop
+    unsigned buffer_count = 1024;       // provided receive buffers per loop, power of two
+    unsigned buffer_size = 16 * 1024;   // bytes per provided buffer
+};
+
+namespace uring_detail {
+
+inline int setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline int enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline int registerOp(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+} // namespace uring_detail
+
+/**
+ * Minimal io_uring wrapper over the raw syscalls (no liburing dependency):
+ * maps the submission/completion rings and hands out SQEs.
+ *
+ * Not thread-safe; each event loop owns one ring.
+ */
+class IoUring {
+private:
+    int fd_ = -1;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    void* ring_ptr_ = MAP_FAILED;
+    std::size_t ring_len_ = 0;
+    std::size_t sqes_len_ = 0;
+    unsigned local_tail_ = 0;   // SQEs handed out but not yet published
+    unsigned flushed_tail_ = 0; // SQEs published to the kernel but not yet submitted
+
+public:
+    explicit IoUring(unsigned entries) {
+        io_uring_params params{};
+        // The ring is created by start() but driven by the loop thread, so
+        // IORING_SETUP_SINGLE_ISSUER (which pins the creating task) is not used.
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = entries * 4;  // multishot ops post many CQEs per SQE
+        fd_ = uring_detail::setup(entries, &params);
+        if (fd_ < 0 && errno == EINVAL) {
+            // Older kernels: drop the optional task-run flag.
+            params = io_uring_params{};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * 4;
+            fd_ = uring_detail::setup(entries, &params);
+        }
+        if (fd_ < 0) {
+            net_detail::throwErrno("io_uring_setup");
+        }
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+            ::close(fd_);
+            throw std::runtime_error("io_uring: kernel lacks IORING_FEAT_SINGLE_MMAP");
+        }
+
+        std::size_t sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        std::size_t cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        ring_len_ = sq_len > cq_len ? sq_len : cq_len;
+        ring_ptr_ = ::mmap(nullptr, ring_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           fd_, IORING_OFF_SQ_RING);
+        if (ring_ptr_ == MAP_FAILED) {
+            ::close(fd_);
+            net_detail::throwErrno("mmap(sq/cq ring)");
+        }
+        sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            ::munmap(ring_ptr_, ring_len_);
+            ::close(fd_);
+            net_detail::throwErrno("mmap(sqes)");
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* base = static_cast<char*>(ring_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        auto* sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; i++) {
+            sq_array[i] = i;  // identity mapping: SQE slot i is array entry i
+        }
+        cq_head_ = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+        local_tail_ = flushed_tail_ = *sq_tail_;
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    int fd() const {
+        return fd_;
+    }
+
+    /**
+     * Returns a zeroed SQE, submitting pending ones first if the queue is full.
+     */
+    io_uring_sqe* getSqe() {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (local_tail_ - head >= sq_entries_) {
+            submit(0);
+            head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+            if (local_tail_ - head >= sq_entries_) {
+                throw std::runtime_error("io_uring submission queue overflow");
+            }
+        }
+        io_uring_sqe* sqe = &sqes_[local_tail_ & sq_mask_];
+        local_tail_++;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    /**
+     * Publishes pending SQEs and enters the kernel once, optionally
+     * waiting for at least `wait_nr` completions.
+     */
+    int submit(unsigned wait_nr) {
+        __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+        unsigned to_submit = local_tail_ - flushed_tail_;
+        flushed_tail_ = local_tail_;
+        unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int ret;
+        do {
+            ret = uring_detail::enter(fd_, to_submit, wait_nr, flags);
+        } while (ret < 0 && errno == EINTR && wait_nr == 0);
+        return ret;
+    }
+
+    /**
+     * Invokes fn(cqe) for every available completion and releases them.
+     */
+    template <typename Fn>
+    unsigned forEachCqe(Fn&& fn) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned seen = 0;
+        while (head != tail) {
+            fn(cqes_[head & cq_mask_]);
+            head++;
+            seen++;
+            if (head == tail) {
+                // Publish progress, then pick up CQEs posted meanwhile.
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return seen;
+    }
+
+    ~IoUring() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_len_);
+        }
+        if (ring_ptr_ != MAP_FAILED) {
+            ::munmap(ring_ptr_, ring_len_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+};
+
+/**
+ * A ring of kernel-selected receive buffers (IORING_REGISTER_PBUF_RING).
+ *
+ * Multishot receives pick a free buffer at completion time, so idle
+ * connections pin no memory; the loop hands each buffer back as soon as
+ * its bytes are consumed.
+ */
+class ProvidedBufferRing {
+private:
+    io_uring_buf_ring* ring_ = nullptr;
+    std::size_t ring_len_ = 0;
+    char* storage_ = nullptr;
+    unsigned count_;
+    unsigned size_;
+    unsigned mask_;
+    uint16_t tail_ = 0;
+
+public:
+    ProvidedBufferRing(IoUring& ring, uint16_t group_id, unsigned count, unsigned size)
+        : count_(count), size_(size), mask_(count - 1) {
+        if (count == 0 || (count & (count - 1)) != 0 || count > 32768) {
+            throw std::invalid_argument("Provided buffer count must be a power of two <= 32768");
+        }
+        ring_len_ = count * sizeof(io_uring_buf);
+        void* mem = ::mmap(nullptr, ring_len_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            net_detail::throwErrno("mmap(buffer ring)");
+        }
+        ring_ = static_cast<io_uring_buf_ring*>(mem);
+        storage_ = static_cast<char*>(std::malloc(static_cast<std::size_t>(count) * size));
+        if (storage_ == nullptr) {
+            ::munmap(ring_, ring_len_);
+            throw std::bad_alloc();
+        }
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(ring_);
+        reg.ring_entries = count;
+        reg.bgid = group_id;
+        if (uring_detail::registerOp(ring.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            int saved = errno;
+            std::free(storage_);
+            ::munmap(ring_, ring_len_);
+            throw std::system_error(saved, std::generic_category(), "io_uring_register(PBUF_RING)");
+        }
+        for (unsigned i = 0; i < count; i++) {
+            stage(static_cast<uint16_t>(i));
+        }
+        publish();
+    }
+
+    ProvidedBufferRing(const ProvidedBufferRing&) = delete;
+    ProvidedBufferRing& operator=(const ProvidedBufferRing&) = delete;
+
+    const char* data(uint16_t bid) const {
+        return storage_ + static_cast<std::size_t>(bid) * size_;
+    }
+
+    /**
+     * Queues a buffer for return to the kernel; visible after publish().
+     */
+    void stage(uint16_t bid) {
+        // Index from the ring base rather than ring_->bufs: some uapi headers
+        // declare bufs via __DECLARE_FLEX_ARRAY, which C++ lays out at offset 8.
+        io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(ring_)[tail_ & mask_];
+        buf.addr = reinterpret_cast<uint64_t>(storage_ + static_cast<std::size_t>(bid) * size_);
+        buf.len = size_;
+        buf.bid = bid;
+        tail_++;
+    }
+
+    void publish() {
+        __atomic_store_n(&ring_->tail, tail_, __ATOMIC_RELEASE);
+    }
+
+    ~ProvidedBufferRing() {
+        std::free(storage_);
+        ::munmap(ring_, ring_len_);
+    }
+};
+
+/**
+ * io_uring network front-end with the same behaviour as EpollServer.
+ *
+ * Per event loop (one thread, one ring):
+ * - multishot accept straight into the ring's registered file table, so
+ *   connection sockets are never installed in the process fd table;
+ * - one multishot recv per connection drawing from a provided buffer ring;
+ * - at most one send in flight per connection; responses produced while it
+ *   is in flight are coalesced into the next send;
+ * - once max_output_buffer bytes of responses wait behind that send, the
+ *   connection's recv is cancelled, and re-armed when the send completes.
+ *
+ * Under pipelined load a single io_uring_enter both submits every pending
+ * send and reaps every receive, instead of one epoll_wait plus a recv and
+ * a send syscall per ready connection.
+ */
+class IoUringServer : public NetworkServer {
+private:
+    enum Op : uint64_t {
+        kAccept = 1,
+        kRecv = 2,
+        kSend = 3,
+        kClose = 4,
+        kShutdown = 5,
+        kWake = 6,
+        kCancel = 7,
+    };
+
+    static constexpr uint16_t kBufferGroup = 1;
+
+    struct Connection {
+        std::unique_ptr<ProtocolSession> session;
+        std::string in;
+        std::string sending;
+        std::string pending;
+        std::size_t send_offset = 0;
+        uint32_t gen = 0;
+        bool active = false;
+        bool recv_armed = false;
+        bool send_inflight = false;
+        bool closing = false;
+        bool paused = false;      // output cap reached: no recv until sends drain
+        bool cancelling = false;  // a cancel for the armed recv has been submitted
+    };
+
+    struct Loop {
+        // Declared before the ring so the ring (and any request that could
+        // still write into a buffer) is torn down first.
+        std::unique_ptr<ProvidedBufferRing> buffers;
+        std::unique_ptr<IoUring> ring;
+        std::vector<Connection> connections;  // indexed by registered file slot
+        int tcp_listener = -1;
+        int wakefd = -1;
+        uint64_t wake_value = 0;
+        std::thread thread;
+    };
+
+    ServerConfig config_;
+    IoUringConfig uring_config_;
+    SessionFactory factory_;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    int unix_listener_ = -1;
+    int tcp_port_ = -1;
+    std::atomic<bool> running_{false};
+
+    static uint64_t tag(Op op, uint32_t slot = 0, uint32_t gen = 0) {
+        return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(gen & 0xffffff) << 32) | slot;
+    }
+
+    static Op tagOp(uint64_t data) { return static_cast<Op>(data >> 56); }
+    static uint32_t tagGen(uint64_t data) { return static_cast<uint32_t>(data >> 32) & 0xffffff; }
+    static uint32_t tagSlot(uint64_t data) { return static_cast<uint32_t>(data); }
+
+    /**
+     * io_uring completes operations on O_NONBLOCK files with -EAGAIN instead
+     * of waiting, so listeners driven by multishot accept must block.
+     */
+    static void setBlocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || ::fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+            net_detail::throwErrno("fcntl(~O_NONBLOCK)");
+        }
+    }
+
+    static void armAccept(Loop& loop, int listener) {
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listener;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->file_index = IORING_FILE_INDEX_ALLOC;
+        sqe->user_data = tag(kAccept, static_cast<uint32_t>(listener));
+    }
+
+    static void armRecv(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = static_cast<int>(slot);
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->user_data = tag(kRecv, slot, conn.gen);
+        conn.recv_armed = true;
+    }
+
+    static void armWake(Loop& loop) {
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = loop.wakefd;
+        sqe->addr = reinterpret_cast<uint64_t>(&loop.wake_value);
+        sqe->len = sizeof(loop.wake_value);
+        sqe->user_data = tag(kWake);
+    }
+
+    static void submitSend(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = static_cast<int>(slot);
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->addr = reinterpret_cast<uint64_t>(conn.sending.data() + conn.send_offset);
+        sqe->len = static_cast<uint32_t>(conn.sending.size() - conn.send_offset);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = tag(kSend, slot, conn.gen);
+        conn.send_inflight = true;
+    }
+
+    /**
+     * Starts a send if none is in flight and output is waiting.
+     */
+    static void maybeSend(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        if (conn.send_inflight || conn.pending.empty()) {
+            return;
+        }
+        conn.sending.swap(conn.pending);
+        conn.pending.clear();
+        conn.send_offset = 0;
+        submitSend(loop, slot);
+    }
+
+    /**
+     * Runs buffered requests until only a partial request is left or the
+     * responses waiting behind the send in flight reach the output cap.
+     */
+    void process(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        while (true) {
+            bool ran = false;
+            std::size_t used = 0;
+            if (!conn.in.empty() && conn.pending.size() < config_.max_output_buffer) {
+                ran = true;
+                used = conn.session->onData(conn.in.data(), conn.in.size(), conn.pending,
+                                            config_.max_output_buffer);
+                conn.in.erase(0, used);
+            }
+            maybeSend(loop, slot);
+            if (conn.in.empty() || conn.pending.size() >= config_.max_output_buffer || (ran && used == 0)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Stops reading from a connection whose output is at the cap. Data
+     * the recv already holds still completes and is buffered in conn.in.
+     */
+    static void pause(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        conn.paused = true;
+        if (conn.recv_armed && !conn.cancelling) {
+            conn.cancelling = true;
+            io_uring_sqe* sqe = loop.ring->getSqe();
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = tag(kRecv, slot, conn.gen);
+            sqe->user_data = tag(kCancel, slot, conn.gen);
+        }
+    }
+
+    /**
+     * Runs buffered requests and starts or stops reading to match the
+     * output backlog. Called after input arrives and after each send.
+     */
+    void afterIo(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        process(loop, slot);
+        if (conn.in.size() > config_.max_input_buffer) {
+            beginClose(loop, slot);
+            return;
+        }
+        if (conn.session->shouldClose() && !conn.send_inflight) {
+            beginClose(loop, slot);
+            return;
+        }
+        if (conn.pending.size() >= config_.max_output_buffer) {
+            if (!conn.paused) {
+                pause(loop, slot);
+            }
+            return;
+        }
+        conn.paused = false;
+        if (!conn.recv_armed && !conn.closing) {
+            armRecv(loop, slot);
+        }
+    }
+
+    /**
+     * Begins tearing a connection down: shutting the socket down ends the
+     * multishot recv, and the slot is closed once nothing is in flight.
+     */
+    static void beginClose(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        if (conn.closing) {
+            return;
+        }
+        conn.closing = true;
+        if (conn.recv_armed) {
+            io_uring_sqe* sqe = loop.ring->getSqe();
+            sqe->opcode = IORING_OP_SHUTDOWN;
+            sqe->fd = static_cast<int>(slot);
+            sqe->flags = IOSQE_FIXED_FILE;
+            sqe->len = SHUT_RDWR;
+            sqe->user_data = tag(kShutdown, slot, conn.gen);
+        }
+        maybeRelease(loop, slot);
+    }
+
+    static void maybeRelease(Loop& loop, uint32_t slot) {
+        Connection& conn = loop.connections[slot];
+        if (!conn.closing || conn.recv_armed || conn.send_inflight) {
+            return;
+        }
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->file_index = slot + 1;
+        sqe->user_data = tag(kClose, slot, conn.gen);
+        // No further completions carry this generation except the close.
+        conn.session.reset();
+        conn.in.clear();
+        conn.in.shrink_to_fit();
+        conn.sending.clear();
+        conn.pending.clear();
+        conn.active = false;
+        conn.closing = false;
+        conn.gen = (conn.gen + 1) & 0xffffff;
+    }
+
+    void onAccept(Loop& loop, const io_uring_cqe& cqe) {
+        bool fatal = cqe.res == -EINVAL || cqe.res == -EBADF;
+        if (!(cqe.flags & IORING_CQE_F_MORE) && !fatal && running_.load(std::memory_order_relaxed)) {
+            armAccept(loop, static_cast<int>(tagSlot(cqe.user_data)));
+        }
+        if (cqe.res < 0) {
+            return;  // e.g. -ENFILE when the registered file table is full
+        }
+        uint32_t slot = static_cast<uint32_t>(cqe.res);
+        Connection& conn = loop.connections[slot];
+        conn.session = factory_();
+        conn.active = true;
+        conn.closing = false;
+        conn.send_inflight = false;
+        conn.paused = false;
+        conn.cancelling = false;
+        armRecv(loop, slot);
+    }
+
+    void onRecv(Loop& loop, const io_uring_cqe& cqe) {
+        uint32_t slot = tagSlot(cqe.user_data);
+        Connection& conn = loop.connections[slot];
+        bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+        if (conn.gen != tagGen(cqe.user_data) || !conn.active) {
+            if (has_buffer) {
+                loop.buffers->stage(bid);
+                loop.buffers->publish();
+            }
+            return;
+        }
+        bool cancelled = false;
+        if (!more) {
+            conn.recv_armed = false;
+            cancelled = conn.cancelling;
+            conn.cancelling = false;
+        }
+
+        if (cqe.res > 0 && has_buffer && !conn.closing) {
+            const char* data = loop.buffers->data(bid);
+            std::size_t len = static_cast<std::size_t>(cqe.res);
+            if (conn.in.empty() && !conn.paused) {
+                // Common case: parse straight out of the kernel buffer and
+                // copy only an incomplete tail.
+                std::size_t used = conn.session->onData(data, len, conn.pending, config_.max_output_buffer);
+                conn.in.assign(data + used, len - used);
+            } else {
+                conn.in.append(data, len);
+            }
+            loop.buffers->stage(bid);
+            loop.buffers->publish();
+            afterIo(loop, slot);
+            return;
+        }
+
+        if (has_buffer) {
+            loop.buffers->stage(bid);
+            loop.buffers->publish();
+        }
+        if (cqe.res == -ENOBUFS && !conn.closing) {
+            // Buffer ring ran dry; buffers have been returned above.
+            if (!conn.recv_armed && !conn.paused) {
+                armRecv(loop, slot);
+            }
+            return;
+        }
+        if (cqe.res == -ECANCELED && cancelled && !conn.closing) {
+            // pause() ended it. If the backlog drained before the cancel
+            // landed, afterIo() saw the recv still armed, so re-arm here.
+            if (!conn.paused) {
+                armRecv(loop, slot);
+            }
+            return;
+        }
+        // EOF, error, or shutdown completed: stop reading.
+        if (conn.recv_armed) {
+            return;
+        }
+        if (!conn.closing) {
+            beginClose(loop, slot);
+        } else {
+            maybeRelease(loop, slot);
+        }
+    }
+
+    void onSend(Loop& loop, const io_uring_cqe& cqe) {
+        uint32_t slot = tagSlot(cqe.user_data);
+        Connection& conn = loop.connections[slot];
+        if (conn.gen != tagGen(cqe.user_data)) {
+            return;
+        }
+        conn.send_inflight = false;
+        if (cqe.res < 0) {
+            if (!conn.closing) {
+                beginClose(loop, slot);
+            } else {
+                maybeRelease(loop, slot);
+            }
+            return;
+        }
+        conn.send_offset += static_cast<std::size_t>(cqe.res);
+        if (conn.closing) {
+            maybeRelease(loop, slot);
+            return;
+        }
+        if (conn.send_offset < conn.sending.size()) {
+            submitSend(loop, slot);  // short write: send the rest
+            return;
+        }
+        conn.sending.clear();
+        afterIo(loop, slot);
+    }
+
+    void run(Loop& loop) {
+        if (loop.tcp_listener >= 0) {
+            armAccept(loop, loop.tcp_listener);
+        }
+        if (unix_listener_ >= 0) {
+            armAccept(loop, unix_listener_);
+        }
+        armWake(loop);
+
+        while (running_.load(std::memory_order_relaxed)) {
+            int ret = loop.ring->submit(1);
+            if (ret < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+                break;
+            }
+            loop.ring->forEachCqe([&](const io_uring_cqe& cqe) {
+                switch (tagOp(cqe.user_data)) {
+                case kAccept:
+                    onAccept(loop, cqe);
+                    break;
+                case kRecv:
+                    onRecv(loop, cqe);
+                    break;
+                case kSend:
+                    onSend(loop, cqe);
+                    break;
+                case kWake:
+                    if (running_.load(std::memory_order_relaxed)) {
+                        armWake(loop);
+                    }
+                    break;
+                case kClose:
+                case kShutdown:
+                case kCancel:
+                    break;
+                }
+            });
+        }
+    }
+
+public:
+    /**
+     * Creates a server; no sockets or rings are created until start().
+     *
+     * @param config Listener and threading configuration
+     * @param factory Creates one protocol session per accepted connection
+     * @param uring_config Ring, registered-file and buffer sizing
+     */
+    IoUringServer(ServerConfig config, SessionFactory factory, IoUringConfig uring_config = {})
+        : config_(std::move(config)), uring_config_(uring_config), factory_(std::move(factory)) {}
+
+    IoUringServer(const IoUringServer&) = delete;
+    IoUringServer& operator=(const IoUringServer&) = delete;
+
+    /**
+     * Creates one ring per loop, registers its file table and buffer ring,
+     * binds listeners and starts the loop threads.
+     *
+     * @throws std::system_error if the kernel rejects io_uring setup or a socket call fails
+     * @throws std::invalid_argument if no listener is configured
+     */
+    void start() override {
+        if (config_.tcp_port < 0 && config_.unix_path.empty()) {
+            throw std::invalid_argument("At least one of TCP or Unix listener must be enabled");
+        }
+        int threads = config_.threads > 0 ? config_.threads
+                                          : static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) {
+            threads = 1;
+        }
+        if (!config_.unix_path.empty()) {
+            unix_listener_ = net_detail::listenUnix(config_.unix_path, config_.backlog);
+            setBlocking(unix_listener_);
+        }
+
+        int port = config_.tcp_port;
+        for (int i = 0; i < threads; i++) {
+            auto loop = std::make_unique<Loop>();
+            loop->ring = std::make_unique<IoUring>(uring_config_.ring_entries);
+
+            io_uring_rsrc_register files{};
+            files.nr = uring_config_.max_connections;
+            files.flags = IORING_RSRC_REGISTER_SPARSE;
+            if (uring_detail::registerOp(loop->ring->fd(), IORING_REGISTER_FILES2, &files,
+                                         sizeof(files)) < 0) {
+                net_detail::throwErrno("io_uring_register(FILES2)");
+            }
+            loop->connections.resize(uring_config_.max_connections);
+            loop->buffers = std::make_unique<ProvidedBufferRing>(
+                *loop->ring, kBufferGroup, uring_config_.buffer_count, uring_config_.buffer_size);
+
+            loop->wakefd = ::eventfd(0, EFD_CLOEXEC);
+            if (loop->wakefd < 0) {
+                net_detail::throwErrno("eventfd");
+            }
+            if (port >= 0) {
+                loop->tcp_listener = net_detail::listenTcp(config_.tcp_host, port, config_.backlog);
+                if (port == 0) {
+                    port = net_detail::boundPort(loop->tcp_listener);
+                }
+                setBlocking(loop->tcp_listener);
+                // Accepted sockets inherit TCP_NODELAY from the listener, which
+                // matters because direct descriptors have no fd for setsockopt.
+                int one = 1;
+                ::setsockopt(loop->tcp_listener, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            loops_.push_back(std::move(loop));
+        }
+        tcp_port_ = port;
+
+        running_.store(true);
+        for (auto& loop : loops_) {
+            Loop* raw = loop.get();
+            loop->thread = std::thread([this, raw]() { run(*raw); });
+        }
+    }
+
+    /**
+     * Stops all loops. Destroying a ring closes every registered connection.
+     * Safe to call more than once.
+     */
+    void stop() override {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        for (auto& loop : loops_) {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(loop->wakefd, &one, sizeof(one));
+            (void)ignored;
+        }
+        for (auto& loop : loops_) {
+            if (loop->thread.joinable()) {
+                loop->thread.join();
+            }
+            if (loop->tcp_listener >= 0) {
+                ::close(loop->tcp_listener);
+            }
+            ::close(loop->wakefd);
+        }
+        loops_.clear();
+        if (unix_listener_ >= 0) {
+            ::close(unix_listener_);
+            ::unlink(config_.unix_path.c_str());
+            unix_listener_ = -1;
+        }
+    }
+
+    int tcpPort() const override {
+        return tcp_port_;
+    }
+
+    int loopCount() const override {
+        return static_cast<int>(loops_.size());
+    }
+
+    ~IoUringServer() override {
+        stop();
+    }
+};
+
+#endif // IO_URING_SERVER_H
@@ -0,0 +1,345 @@
+#ifndef MEMCACHED_PROTOCOL_H
+#define MEMCACHED_PROTOCOL_H
+
+#include "EpollServer.h"
+#include "../LRU Cache (Thread Safe)/ShardedLRUCache.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <ostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+/**
+ * A value stored by the memcached front-end.
+ */
+struct MemcachedItem {
+    std::string data;
+    uint32_t flags = 0;
+    uint64_t cas = 0;
+    int64_t expires_at = 0;  // unix seconds, 0 = never
+};
+
+inline std::ostream& operator<<(std::ostream& os, const MemcachedItem& item) {
+    return os << item.data;
+}
+
+/**
+ * Shared state behind every connection: the sharded cache plus the
+ * monotonically increasing CAS counter reported by `gets`.
+ */
+class MemcachedStore {
+private:
+    ShardedLRUCache<std::string, MemcachedItem> cache_;
+    std::atomic<uint64_t> next_cas_{1};
+
+public:
+    MemcachedStore(int capacity, int shards) : cache_(capacity, shards) {}
+
+    ShardedLRUCache<std::string, MemcachedItem>& cache() { return cache_; }
+
+    uint64_t nextCas() { return next_cas_.fetch_add(1, std::memory_order_relaxed); }
+};
+
+/**
+ * Incremental parser and executor for the memcached text protocol.
+ *
+ * Supported commands: get, gets, set, delete, version, quit. Requests may be
+ * pipelined and may arrive split across reads; anything incomplete is left
+ * unconsumed so the server keeps it buffered until more bytes arrive.
+ *
+ * @tparam Clock A wall clock with a static now(), for exptime; tests
+ *         substitute a fake
+ */
+template <typename Clock = std::chrono::system_clock>
+class BasicMemcachedSession : public ProtocolSession {
+public:
+    static constexpr std::size_t kMaxKeyLength = 250;
+    static constexpr std::size_t kMaxLineLength = 8192;
+    static constexpr std::size_t kMaxValueSize = 1024 * 1024;
+    // Largest data block a rejected set may announce and still be skipped;
+    // beyond it the connection is closed instead.
+    static constexpr std::size_t kMaxSkippedValue = 64 * kMaxValueSize;
+
+private:
+    static constexpr int64_t kRelativeExptimeLimit = 60 * 60 * 24 * 30;  // 30 days, as memcached
+
+    MemcachedStore& store_;
+    bool close_ = false;
+    std::size_t swallow_ = 0;  // bytes of a rejected value still to discard
+    std::vector<std::string> tokens_;
+
+    static int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   Clock::now().time_since_epoch()).count();
+    }
+
+    static bool validKey(const std::string& key) {
+        if (key.empty() || key.size() > kMaxKeyLength) {
+            return false;
+        }
+        for (unsigned char c : key) {
+            if (c <= 32 || c == 127) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool parseUnsigned(const std::string& s, uint64_t& out) {
+        if (s.empty() || s.size() > 20) {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long v = std::strtoull(s.c_str(), &end, 10);
+        if (errno != 0 || *end != '\0' || s[0] == '-') {
+            return false;
+        }
+        out = v;
+        return true;
+    }
+
+    static bool parseSigned(const std::string& s, int64_t& out) {
+        if (s.empty() || s.size() > 20) {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        long long v = std::strtoll(s.c_str(), &end, 10);
+        if (errno != 0 || *end != '\0') {
+            return false;
+        }
+        out = v;
+        return true;
+    }
+
+    void tokenize(const char* line, std::size_t len) {
+        tokens_.clear();
+        std::size_t i = 0;
+        while (i < len) {
+            while (i < len && line[i] == ' ') {
+                i++;
+            }
+            std::size_t start = i;
+            while (i < len && line[i] != ' ') {
+                i++;
+            }
+            if (i > start) {
+                tokens_.emplace_back(line + start, i - start);
+            }
+        }
+    }
+
+    void handleGet(bool with_cas, std::string& out) {
+        if (tokens_.size() < 2) {
+            out += "ERROR\r\n";
+            return;
+        }
+        int64_t now = 0;
+        auto expired = [&now](const MemcachedItem& item) {
+            if (item.expires_at == 0) {
+                return false;
+            }
+            if (now == 0) {
+                now = nowSeconds();
+            }
+            return item.expires_at <= now;
+        };
+        for (std::size_t i = 1; i < tokens_.size(); i++) {
+            const std::string& key = tokens_[i];
+            if (key.size() > kMaxKeyLength) {
+                out += "CLIENT_ERROR bad command line format\r\n";
+                return;
+            }
+            auto item = store_.cache().get(key);
+            if (!item) {
+                continue;
+            }
+            if (expired(*item)) {
+                // Remove only the item that was read: a set may have
+                // replaced it since, and that value must survive.
+                uint64_t stale = item->cas;
+                item = store_.cache().computeIfPresent(
+                    key, [stale](const MemcachedItem& current) -> std::optional<MemcachedItem> {
+                        if (current.cas == stale) {
+                            return std::nullopt;
+                        }
+                        return current;
+                    });
+                if (!item || expired(*item)) {
+                    continue;
+                }
+            }
+            out += "VALUE ";
+            out += key;
+            out += ' ';
+            out += std::to_string(item->flags);
+            out += ' ';
+            out += std::to_string(item->data.size());
+            if (with_cas) {
+                out += ' ';
+                out += std::to_string(item->cas);
+            }
+            out += "\r\n";
+            out += item->data;
+            out += "\r\n";
+        }
+        out += "END\r\n";
+    }
+
+    /**
+     * Arranges to discard the data block of a rejected set. A block too
+     * large to be worth reading closes the connection instead, which also
+     * keeps bytes + 2 from overflowing.
+     */
+    void skipValue(uint64_t bytes) {
+        if (bytes > kMaxSkippedValue) {
+            close_ = true;
+            return;
+        }
+        swallow_ = static_cast<std::size_t>(bytes) + 2;
+    }
+
+    /**
+     * Handles "set <key> <flags> <exptime> <bytes> [noreply]".
+     * Returns the number of bytes consumed after the command line, or
+     * npos if the data block has not fully arrived yet.
+     */
+    std::size_t handleSet(const char* data, std::size_t len, std::string& out) {
+        uint64_t flags = 0;
+        uint64_t bytes = 0;
+        int64_t exptime = 0;
+        if (tokens_.size() < 5 || tokens_.size() > 6 ||
+            !parseUnsigned(tokens_[2], flags) || flags > UINT32_MAX ||
+            !parseSigned(tokens_[3], exptime) ||
+            !parseUnsigned(tokens_[4], bytes)) {
+            out += "CLIENT_ERROR bad command line format\r\n";
+            return 0;
+        }
+        bool noreply = tokens_.size() == 6 && tokens_[5] == "noreply";
+        if (!validKey(tokens_[1])) {
+            out += "CLIENT_ERROR bad command line format\r\n";
+            skipValue(bytes);
+            return 0;
+        }
+        if (bytes > kMaxValueSize) {
+            out += "SERVER_ERROR object too large for cache\r\n";
+            skipValue(bytes);
+            return 0;
+        }
+        std::size_t needed = static_cast<std::size_t>(bytes) + 2;
+        if (len < needed) {
+            return std::string::npos;
+        }
+        if (data[bytes] != '\r' || data[bytes + 1] != '\n') {
+            out += "CLIENT_ERROR bad data chunk\r\n";
+            return needed;
+        }
+
+        MemcachedItem item;
+        item.data.assign(data, static_cast<std::size_t>(bytes));
+        item.flags = static_cast<uint32_t>(flags);
+        item.cas = store_.nextCas();
+        if (exptime < 0) {
+            // Negative exptime means "already expired": behaves like delete.
+            store_.cache().remove(tokens_[1]);
+        } else {
+            if (exptime > 0) {
+                item.expires_at = exptime > kRelativeExptimeLimit ? exptime : nowSeconds() + exptime;
+            }
+            store_.cache().put(tokens_[1], item);
+        }
+        if (!noreply) {
+            out += "STORED\r\n";
+        }
+        return needed;
+    }
+
+    void handleDelete(std::string& out) {
+        // "delete <key> [0] [noreply]" -- the legacy time argument must be 0.
+        bool noreply = tokens_.back() == "noreply";
+        std::size_t args = tokens_.size() - (noreply ? 1 : 0);
+        if (args < 2 || args > 3 || (args == 3 && tokens_[2] != "0")) {
+            out += "CLIENT_ERROR bad command line format.  Usage: delete <key> [noreply]\r\n";
+            return;
+        }
+        bool removed = store_.cache().remove(tokens_[1]);
+        if (!noreply) {
+            out += removed ? "DELETED\r\n" : "NOT_FOUND\r\n";
+        }
+    }
+
+public:
+    explicit BasicMemcachedSession(MemcachedStore& store) : store_(store) {}
+
+    std::size_t onData(const char* data, std::size_t len, std::string& out,
+                       std::size_t out_limit) override {
+        std::size_t pos = 0;
+        while (pos < len && !close_ && out.size() < out_limit) {
+            if (swallow_ > 0) {
+                std::size_t skip = std::min(swallow_, len - pos);
+                swallow_ -= skip;
+                pos += skip;
+                continue;
+            }
+            const char* line = data + pos;
+            const void* nl = std::memchr(line, '\n', len - pos);
+            if (nl == nullptr) {
+                if (len - pos > kMaxLineLength) {
+                    out += "CLIENT_ERROR line too long\r\n";
+                    close_ = true;
+                    return len;
+                }
+                break;
+            }
+            std::size_t line_len = static_cast<const char*>(nl) - line;
+            std::size_t next = pos + line_len + 1;
+            if (line_len > 0 && line[line_len - 1] == '\r') {
+                line_len--;
+            }
+            tokenize(line, line_len);
+            if (tokens_.empty()) {
+                out += "ERROR\r\n";
+                pos = next;
+                continue;
+            }
+
+            const std::string& cmd = tokens_[0];
+            if (cmd == "get") {
+                handleGet(false, out);
+            } else if (cmd == "gets") {
+                handleGet(true, out);
+            } else if (cmd == "set") {
+                std::size_t used = handleSet(data + next, len - next, out);
+                if (used == std::string::npos) {
+                    break;  // wait for the rest of the data block
+                }
+                next += used;
+            } else if (cmd == "delete") {
+                handleDelete(out);
+            } else if (cmd == "version") {
+                out += "VERSION 1.6.0-lru\r\n";
+            } else if (cmd == "quit") {
+                close_ = true;
+            } else {
+                out += "ERROR\r\n";
+            }
+            pos = next;
+        }
+        return pos;
+    }
+
+    bool shouldClose() const override {
+        return close_;
+    }
+};
+
+using MemcachedSession = BasicMemcachedSession<>;
+
+#endif // MEMCACHED_PROTOCOL_H
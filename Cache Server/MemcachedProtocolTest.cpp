@@ -0,0 +1,474 @@
+#include "MemcachedProtocol.h"
+#include "IoUringServer.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <poll.h>
+#include <unistd.h>
+
+/**
+ * Test cases for MemcachedSession and the server's output cap.
+ *
+ * Tests cover:
+ * - Commands and data blocks split across reads
+ * - noreply, delete, gets and quit
+ * - Malformed commands: bad byte counts, missing data terminators, long keys
+ * - exptime: relative, absolute, negative and malformed
+ * - Stopping at the output limit
+ * - Both back-ends pausing reads while a client leaves replies unread
+ * - A get dropping an expired item never dropping a set that replaced it
+ * - The epoll server shedding connections when out of file descriptors
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread MemcachedProtocolTest.cpp -o memcached_protocol_test
+ */
+
+namespace {
+
+/**
+ * Records the largest unsent output seen after any call, i.e. the bytes
+ * appended beyond what the server had already written to the socket.
+ */
+class RecordingSession : public ProtocolSession {
+private:
+    std::unique_ptr<ProtocolSession> inner_;
+    std::size_t cap_;
+    std::atomic<std::size_t>& peak_;
+
+public:
+    RecordingSession(std::unique_ptr<ProtocolSession> inner, std::size_t cap, std::atomic<std::size_t>& peak)
+        : inner_(std::move(inner)), cap_(cap), peak_(peak) {}
+
+    std::size_t onData(const char* data, std::size_t len, std::string& out,
+                       std::size_t out_limit) override {
+        std::size_t used = inner_->onData(data, len, out, out_limit);
+        std::size_t unsent = out.size() - (out_limit - cap_);
+        if (unsent > peak_.load()) {
+            peak_.store(unsent);
+        }
+        return used;
+    }
+
+    bool shouldClose() const override {
+        return inner_->shouldClose();
+    }
+};
+
+int connectTcp(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    int small = 64 * 1024;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    assert(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    return fd;
+}
+
+void putItem(MemcachedStore& store, const std::string& key, const std::string& data) {
+    MemcachedItem item;
+    item.data = data;
+    item.cas = store.nextCas();
+    store.cache().put(key, item);
+}
+
+/**
+ * Buffers input the way the server does: whatever the session leaves
+ * unconsumed is kept and handed back with the next bytes.
+ */
+class Client {
+private:
+    MemcachedSession session_;
+    std::string in_;
+    std::string out_;
+
+public:
+    explicit Client(MemcachedStore& store) : session_(store) {}
+
+    /**
+     * Feeds bytes to the session and returns the output they produced.
+     */
+    std::string feed(const std::string& bytes) {
+        in_ += bytes;
+        std::size_t used = session_.onData(in_.data(), in_.size(), out_, std::string::npos);
+        in_.erase(0, used);
+        std::string produced;
+        produced.swap(out_);
+        return produced;
+    }
+
+    std::size_t buffered() const { return in_.size(); }
+
+    bool closed() const { return session_.shouldClose(); }
+};
+
+/**
+ * The system clock, except that the first now() after race is set runs
+ * race once, to interleave a write with a session's expiry check.
+ */
+struct RacingClock {
+    using duration = std::chrono::system_clock::duration;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::system_clock::time_point;
+    static constexpr bool is_steady = false;
+
+    static inline std::function<void()> race;
+
+    static time_point now() {
+        if (race) {
+            auto run = std::move(race);
+            race = nullptr;
+            run();
+        }
+        return std::chrono::system_clock::now();
+    }
+};
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void testSplitInput() {
+    std::cout << "Test 1: Commands and Data Blocks Split Across Reads" << std::endl;
+    MemcachedStore store(100, 4);
+    Client client(store);
+
+    // One byte at a time: nothing is answered until the data block ends.
+    std::string set = "set greeting 7 0 5\r\nhello\r\n";
+    for (std::size_t i = 0; i + 1 < set.size(); i++) {
+        assert(client.feed(set.substr(i, 1)).empty());
+    }
+    assert(client.feed(set.substr(set.size() - 1)) == "STORED\r\n");
+    assert(client.buffered() == 0);
+
+    // A split command line, then a data block cut inside the terminator.
+    assert(client.feed("ge").empty());
+    assert(client.feed("t greeting\r").empty());
+    assert(client.feed("\n") == "VALUE greeting 7 5\r\nhello\r\nEND\r\n");
+    assert(client.feed("set k 0 0 3\r\nabc\r").empty());
+    assert(client.feed("\nget k missing greeting\r\n") ==
+           "STORED\r\nVALUE k 0 3\r\nabc\r\nVALUE greeting 7 5\r\nhello\r\nEND\r\n");
+
+    // Binary data containing CR LF is read by length, not by line.
+    assert(client.feed("set bin 0 0 4\r\n\r\n\r\n\r\n") == "STORED\r\n");
+    assert(client.feed("get bin\r\n") == "VALUE bin 0 4\r\n\r\n\r\n\r\nEND\r\n");
+    // Bare LF line endings are accepted too.
+    assert(client.feed("get k\n") == "VALUE k 0 3\r\nabc\r\nEND\r\n");
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testNoreplyDeleteAndQuit() {
+    std::cout << "Test 2: noreply, delete, gets and quit" << std::endl;
+    MemcachedStore store(100, 4);
+    Client client(store);
+
+    assert(client.feed("set a 1 0 1 noreply\r\nx\r\n").empty());
+    assert(client.feed("set b 2 0 1 noreply\r\ny\r\nget a b\r\n") ==
+           "VALUE a 1 1\r\nx\r\nVALUE b 2 1\r\ny\r\nEND\r\n");
+
+    std::string gets = client.feed("gets a\r\n");
+    assert(gets.rfind("VALUE a 1 1 ", 0) == 0);  // followed by the CAS unique
+    assert(client.feed("set a 1 0 1\r\nz\r\n") == "STORED\r\n");
+    assert(client.feed("gets a\r\n") != gets);  // a new CAS unique
+
+    assert(client.feed("delete a\r\n") == "DELETED\r\n");
+    assert(client.feed("delete a\r\n") == "NOT_FOUND\r\n");
+    assert(client.feed("delete b noreply\r\n").empty());
+    assert(client.feed("delete b 0\r\n") == "NOT_FOUND\r\n");
+    assert(client.feed("delete b 5\r\n").rfind("CLIENT_ERROR", 0) == 0);
+    assert(client.feed("version\r\n").rfind("VERSION ", 0) == 0);
+    assert(client.feed("flush_all\r\n\r\n") == "ERROR\r\nERROR\r\n");
+
+    // quit closes without answering, and nothing after it is run.
+    assert(client.feed("quit\r\nset c 0 0 1\r\nc\r\n").empty());
+    assert(client.closed());
+    assert(!store.cache().containsKey("c"));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMalformedCommands() {
+    std::cout << "Test 3: Malformed Commands" << std::endl;
+    MemcachedStore store(100, 4);
+    Client client(store);
+    const std::string bad_format = "CLIENT_ERROR bad command line format\r\n";
+
+    // Byte count shorter than the data: the terminator check fails, and
+    // the leftover bytes are read as the next command.
+    assert(client.feed("set k 0 0 3\r\nhello\r\n") == "CLIENT_ERROR bad data chunk\r\nERROR\r\n");
+    // Missing trailing CR LF.
+    assert(client.feed("set k 0 0 5\r\nhelloXY") == "CLIENT_ERROR bad data chunk\r\n");
+    assert(!store.cache().containsKey("k"));
+    assert(client.buffered() == 0);  // "XY" was taken as the terminator
+
+    assert(client.feed("set k 0 0 abc\r\n") == bad_format);
+    assert(client.feed("set k 0 0 -1\r\n") == bad_format);
+    assert(client.feed("set k 0 0\r\n") == bad_format);
+    assert(client.feed("set k 4294967296 0 1\r\n") == bad_format);  // flags over 32 bits
+    assert(client.feed("get\r\n") == "ERROR\r\n");
+
+    // Keys: 250 bytes is the limit. A rejected set still skips its data block.
+    std::string longest(MemcachedSession::kMaxKeyLength, 'k');
+    std::string too_long(MemcachedSession::kMaxKeyLength + 1, 'k');
+    assert(client.feed("set " + longest + " 0 0 1\r\nv\r\n") == "STORED\r\n");
+    assert(client.feed("set " + too_long + " 0 0 5\r\nhello\r\nget " + longest + "\r\n") ==
+           bad_format + "VALUE " + longest + " 0 1\r\nv\r\nEND\r\n");
+    assert(client.feed("get " + too_long + "\r\n") == bad_format);
+    assert(!store.cache().containsKey(too_long));
+
+    // An oversized value is refused and its data block skipped, even when
+    // it arrives in pieces.
+    std::size_t big = MemcachedSession::kMaxValueSize + 1;
+    assert(client.feed("set big 0 0 " + std::to_string(big) + "\r\n") ==
+           "SERVER_ERROR object too large for cache\r\n");
+    assert(client.feed(std::string(big, 'x')).empty());
+    assert(client.feed("\r\nget big\r\n") == "END\r\n");
+
+    // A rejected set announcing more data than is worth skipping closes
+    // the connection; the largest byte count would wrap bytes + 2 to 1.
+    const std::string huge = " 0 0 18446744073709551615\r\nxget " + longest + "\r\n";
+    Client oversized(store);
+    assert(oversized.feed("set big" + huge) == "SERVER_ERROR object too large for cache\r\n");
+    assert(oversized.closed());
+    Client bad_key(store);
+    assert(bad_key.feed("set " + too_long + huge) == bad_format);
+    assert(bad_key.closed());
+
+    // A line that never ends closes the connection.
+    assert(client.feed(std::string(MemcachedSession::kMaxLineLength + 1, 'g')) ==
+           "CLIENT_ERROR line too long\r\n");
+    assert(client.closed());
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testExptime() {
+    std::cout << "Test 4: exptime Edge Cases" << std::endl;
+    MemcachedStore store(100, 4);
+    Client client(store);
+    const int64_t thirty_days = 60 * 60 * 24 * 30;
+    auto set = [&client](const std::string& key, const std::string& exptime) {
+        return client.feed("set " + key + " 0 " + exptime + " 1\r\nv\r\n");
+    };
+    auto hit = [&client](const std::string& key) {
+        return client.feed("get " + key + "\r\n") != "END\r\n";
+    };
+
+    assert(set("never", "0") == "STORED\r\n" && hit("never"));
+    assert(set("relative", "100") == "STORED\r\n" && hit("relative"));
+    // Exactly 30 days is still relative; one more second is an absolute time.
+    assert(set("month", std::to_string(thirty_days)) == "STORED\r\n" && hit("month"));
+    assert(set("past", std::to_string(thirty_days + 1)) == "STORED\r\n" && !hit("past"));
+    assert(set("future", std::to_string(unixNow() + 100)) == "STORED\r\n" && hit("future"));
+    assert(set("expired", std::to_string(unixNow() - 1)) == "STORED\r\n" && !hit("expired"));
+
+    // A negative exptime stores nothing and drops an existing value.
+    assert(set("never", "-1") == "STORED\r\n" && !hit("never"));
+
+    assert(set("bad", "1.5") == "CLIENT_ERROR bad command line format\r\nERROR\r\n");
+    assert(set("bad", "99999999999999999999") == "CLIENT_ERROR bad command line format\r\nERROR\r\n");
+    assert(!hit("bad"));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testOutputLimit() {
+    std::cout << "Test 5: Stopping at the Output Limit" << std::endl;
+    MemcachedStore store(100, 1);
+    putItem(store, "k", "value");
+    MemcachedSession session(store);
+
+    std::string in = "get k\r\nget k\r\nget k\r\n";
+    std::string out;
+    std::size_t used = session.onData(in.data(), in.size(), out, 1);
+    assert(used == 7);  // one request, then out is over the limit
+    assert(out == "VALUE k 0 5\r\nvalue\r\nEND\r\n");
+    in.erase(0, used);
+    assert(session.onData(in.data(), in.size(), out, std::string::npos) == in.size());
+    assert(out.size() == 3 * std::string("VALUE k 0 5\r\nvalue\r\nEND\r\n").size());
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+/**
+ * Pipelines gets of a 1 MiB value without reading the replies, checks that
+ * the server stops near its output cap, then reads every reply.
+ *
+ * @return The largest unsent output seen, or 0 if the back-end could not start
+ */
+template <typename Server>
+std::size_t checkPausesReading() {
+    const std::size_t value_size = 1024 * 1024;
+    const int requests = 64;
+    MemcachedStore store(100, 1);
+    putItem(store, "big", std::string(value_size, 'v'));
+
+    ServerConfig config;
+    config.tcp_port = 0;
+    config.threads = 1;
+    config.max_output_buffer = 4 * 1024 * 1024;
+    std::atomic<std::size_t> peak{0};
+    Server server(config, [&]() {
+        return std::make_unique<RecordingSession>(std::make_unique<MemcachedSession>(store),
+                                                  config.max_output_buffer, peak);
+    });
+    try {
+        server.start();
+    } catch (const std::system_error&) {
+        return 0;  // e.g. io_uring disabled in this kernel or container
+    }
+
+    int fd = connectTcp(server.tcpPort());
+    std::string pipeline;
+    for (int i = 0; i < requests; i++) {
+        pipeline += "get big\r\n";
+    }
+    assert(::send(fd, pipeline.data(), pipeline.size(), 0) == static_cast<ssize_t>(pipeline.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    // Without the cap the server would have queued all 64 MB of replies.
+    assert(peak.load() < config.max_output_buffer + 2 * value_size);
+
+    // Reading resumes as the client drains, and every reply arrives.
+    std::string header = "VALUE big 0 " + std::to_string(value_size) + "\r\n";
+    std::size_t reply_size = header.size() + value_size + 2 + 5;
+    std::size_t expected = reply_size * requests;
+    std::size_t received = 0;
+    std::string buf(256 * 1024, '\0');
+    std::string tail;
+    while (received < expected) {
+        ssize_t n = ::recv(fd, &buf[0], buf.size(), 0);
+        assert(n > 0);
+        received += static_cast<std::size_t>(n);
+        tail.append(buf.data(), static_cast<std::size_t>(n));
+        if (tail.size() > 16) {
+            tail.erase(0, tail.size() - 16);
+        }
+    }
+    assert(received == expected);
+    assert(tail.size() >= 7 && tail.compare(tail.size() - 7, 7, "\r\nEND\r\n") == 0);
+    ::close(fd);
+    server.stop();
+    return peak.load();
+}
+
+void testServerPausesReading() {
+    std::cout << "Test 6: Server Pauses Reading While Replies Are Unread" << std::endl;
+    std::size_t epoll_peak = checkPausesReading<EpollServer>();
+    assert(epoll_peak > 0);
+    std::cout << "  epoll: peak unsent output " << epoll_peak / 1024 << " KiB" << std::endl;
+    std::size_t uring_peak = checkPausesReading<IoUringServer>();
+    if (uring_peak == 0) {
+        std::cout << "  io_uring: not available, skipped" << std::endl;
+    } else {
+        std::cout << "  io_uring: peak unsent output " << uring_peak / 1024 << " KiB" << std::endl;
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testExpiryRemovalKeepsNewSet() {
+    std::cout << "Test 7: Expiry Removal Keeps a Concurrent Set" << std::endl;
+    MemcachedStore store(100, 1);
+    MemcachedItem stale;
+    stale.data = "stale";
+    stale.cas = store.nextCas();
+    stale.expires_at = 1;
+    store.cache().put("k", stale);
+
+    // The get reads the clock after finding the expired item and before
+    // removing it; the fake clock stores a new value at exactly that point.
+    RacingClock::race = [&store]() { putItem(store, "k", "fresh"); };
+    BasicMemcachedSession<RacingClock> session(store);
+    std::string request = "get k\r\n";
+    std::string out;
+    assert(session.onData(request.data(), request.size(), out, std::string::npos) == request.size());
+    assert(!RacingClock::race);
+    assert(out == "VALUE k 0 5\r\nfresh\r\nEND\r\n");
+    assert(store.cache().get("k")->data == "fresh");
+    std::cout << "✓ Passed\n" << std::endl;
+}
+void testOutOfDescriptors() {
+    std::cout << "Test 8: Shedding Connections When Out of Descriptors" << std::endl;
+    MemcachedStore store(100, 1);
+    ServerConfig config;
+    config.tcp_port = 0;
+    config.threads = 1;
+    EpollServer server(config, [&store]() { return std::make_unique<MemcachedSession>(store); });
+    server.start();
+
+    // Create the client sockets first, then cap descriptors at what is
+    // open, so the server's accept fails with EMFILE.
+    std::vector<int> clients;
+    for (int i = 0; i < 3; i++) {
+        clients.push_back(::socket(AF_INET, SOCK_STREAM, 0));
+        assert(clients.back() >= 0);
+    }
+    rlimit saved{};
+    assert(::getrlimit(RLIMIT_NOFILE, &saved) == 0);
+    rlimit capped = saved;
+    capped.rlim_cur = static_cast<rlim_t>(clients.back() + 1);
+    assert(::setrlimit(RLIMIT_NOFILE, &capped) == 0);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(server.tcpPort()));
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    rusage before{};
+    ::getrusage(RUSAGE_SELF, &before);
+    for (int fd : clients) {
+        assert(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    }
+    // Each connection is accepted and closed rather than left queued.
+    for (int fd : clients) {
+        pollfd p{fd, POLLIN, 0};
+        assert(::poll(&p, 1, 2000) == 1);
+        char c;
+        assert(::recv(fd, &c, 1, 0) <= 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    rusage after{};
+    ::getrusage(RUSAGE_SELF, &after);
+    auto cpuMs = [](const rusage& u) {
+        return (u.ru_utime.tv_sec + u.ru_stime.tv_sec) * 1000 + (u.ru_utime.tv_usec + u.ru_stime.tv_usec) / 1000;
+    };
+    assert(cpuMs(after) - cpuMs(before) < 150);  // the loop is not spinning on the listener
+
+    assert(::setrlimit(RLIMIT_NOFILE, &saved) == 0);
+    for (int fd : clients) {
+        ::close(fd);
+    }
+    int fd = connectTcp(server.tcpPort());
+    std::string version = "version\r\n";
+    assert(::send(fd, version.data(), version.size(), 0) == static_cast<ssize_t>(version.size()));
+    char buf[64];
+    assert(::recv(fd, buf, sizeof(buf), 0) > 0 && std::string(buf, 8) == "VERSION ");
+    ::close(fd);
+    server.stop();
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Memcached Protocol Tests...\n" << std::endl;
+
+    testSplitInput();
+    testNoreplyDeleteAndQuit();
+    testMalformedCommands();
+    testExptime();
+    testOutputLimit();
+    testServerPausesReading();
+    testExpiryRemovalKeepsNewSet();
+    testOutOfDescriptors();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,187 @@
+#ifndef CACHE_SIMULATOR_H
+#define CACHE_SIMULATOR_H
+
+#include "Policies.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Settings for a replay.
+ */
+struct SimulatorConfig {
+    // On a get miss, insert the key as a look-aside client would after
+    // loading it. Turn off for traces that record the fill as a Set.
+    bool fill_on_miss = true;
+};
+
+/**
+ * Outcome of replaying one trace through one policy at one capacity.
+ */
+struct SimulationResult {
+    std::string policy;
+    std::size_t capacity = 0;
+    std::uint64_t gets = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t get_bytes = 0;
+    std::uint64_t hit_bytes = 0;
+    std::uint64_t sets = 0;
+    std::uint64_t deletes = 0;
+    double seconds = 0;
+
+    double hitRatio() const {
+        return gets > 0 ? static_cast<double>(hits) / gets : 0.0;
+    }
+
+    double byteHitRatio() const {
+        return get_bytes > 0 ? static_cast<double>(hit_bytes) / get_bytes : 0.0;
+    }
+
+    /**
+     * Returns the replay speed.
+     *
+     * @return Trace records processed per second
+     */
+    double accessesPerSecond() const {
+        return seconds > 0 ? (gets + sets + deletes) / seconds : 0.0;
+    }
+};
+
+/**
+ * Replays trace records through a policy.
+ *
+ * @param begin First record
+ * @param end One past the last record
+ * @param policy Any policy from Policies.h
+ * @param config Replay settings
+ * @return Counts for the replay; policy and capacity are left for the caller
+ */
+template <typename Policy>
+SimulationResult replay(const TraceRecord* begin, const TraceRecord* end, Policy& policy,
+                        const SimulatorConfig& config = SimulatorConfig()) {
+    SimulationResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (const TraceRecord* r = begin; r != end; ++r) {
+        switch (static_cast<TraceOp>(r->op)) {
+            case TraceOp::Get:
+                result.gets++;
+                result.get_bytes += r->size;
+                if (policy.get(r->key)) {
+                    result.hits++;
+                    result.hit_bytes += r->size;
+                } else if (config.fill_on_miss) {
+                    policy.put(r->key);
+                }
+                break;
+            case TraceOp::Set:
+                result.sets++;
+                policy.put(r->key);
+                break;
+            case TraceOp::Delete:
+                result.deletes++;
+                policy.remove(r->key);
+                break;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/**
+ * Returns the names accepted by simulate().
+ *
+ * @return lru, fifo, clock, slru and lrucache (the production LRUCache)
+ */
+inline const std::vector<std::string>& policyNames() {
+    static const std::vector<std::string> names = {"lru", "fifo", "clock", "slru", "lrucache"};
+    return names;
+}
+
+/**
+ * Replays a trace through a freshly constructed policy.
+ *
+ * @param begin First record
+ * @param end One past the last record
+ * @param policy A name from policyNames()
+ * @param capacity Cache capacity in entries
+ * @param config Replay settings
+ * @return The result for this policy and capacity
+ * @throws std::invalid_argument if the policy is unknown or capacity is invalid
+ */
+inline SimulationResult simulate(const TraceRecord* begin, const TraceRecord* end,
+                                 const std::string& policy, std::size_t capacity,
+                                 const SimulatorConfig& config = SimulatorConfig()) {
+    SimulationResult result;
+    if (policy == "lru") {
+        LruPolicy p(capacity);
+        result = replay(begin, end, p, config);
+    } else if (policy == "fifo") {
+        FifoPolicy p(capacity);
+        result = replay(begin, end, p, config);
+    } else if (policy == "clock") {
+        ClockPolicy p(capacity);
+        result = replay(begin, end, p, config);
+    } else if (policy == "slru") {
+        SlruPolicy p(capacity);
+        result = replay(begin, end, p, config);
+    } else if (policy == "lrucache") {
+        LRUCachePolicy p(capacity);
+        result = replay(begin, end, p, config);
+    } else {
+        throw std::invalid_argument("Unknown policy: " + policy);
+    }
+    result.policy = policy;
+    result.capacity = capacity;
+    return result;
+}
+
+/**
+ * Replays a mapped trace through every policy at every capacity.
+ *
+ * @param trace The trace
+ * @param policies Names from policyNames()
+ * @param capacities Capacities in entries
+ * @param config Replay settings
+ * @return One result per policy and capacity, policy-major
+ * @throws std::invalid_argument if a policy is unknown or a capacity is invalid
+ */
+inline std::vector<SimulationResult> simulateAll(const MappedTrace& trace,
+                                                 const std::vector<std::string>& policies,
+                                                 const std::vector<std::size_t>& capacities,
+                                                 const SimulatorConfig& config = SimulatorConfig()) {
+    std::vector<SimulationResult> results;
+    for (const std::string& policy : policies) {
+        for (std::size_t capacity : capacities) {
+            results.push_back(simulate(trace.begin(), trace.end(), policy, capacity, config));
+        }
+    }
+    return results;
+}
+
+/**
+ * Renders results as a table.
+ *
+ * @param results Results from simulateAll()
+ * @return One row per result
+ */
+inline std::string formatResults(const std::vector<SimulationResult>& results) {
+    std::ostringstream oss;
+    oss << std::left << std::setw(10) << "policy" << std::right << std::setw(12) << "capacity"
+        << std::setw(12) << "hit ratio" << std::setw(12) << "byte ratio" << std::setw(14) << "Maccess/s"
+        << "\n";
+    oss << std::fixed;
+    for (const SimulationResult& r : results) {
+        oss << std::left << std::setw(10) << r.policy << std::right << std::setw(12) << r.capacity
+            << std::setw(12) << std::setprecision(4) << r.hitRatio()
+            << std::setw(12) << std::setprecision(4) << r.byteHitRatio()
+            << std::setw(14) << std::setprecision(1) << r.accessesPerSecond() / 1e6 << "\n";
+    }
+    return oss.str();
+}
+
+#endif // CACHE_SIMULATOR_H
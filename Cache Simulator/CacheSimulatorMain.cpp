@@ -0,0 +1,157 @@
+#include "CacheSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Trace-driven cache simulator CLI.
+ *
+ * Replays a binary trace (see Trace.h) through each policy at each
+ * capacity and prints hit ratios, or writes a synthetic Zipf trace to try
+ * it with.
+ *
+ * Usage:
+ *   cache_simulator --trace FILE [--policies lru,fifo,clock,slru,lrucache]
+ *                   [--capacities 1000,10000,100000] [--no-fill]
+ *   cache_simulator --generate FILE [--requests 10000000] [--keys 1000000]
+ *                   [--zipf 0.99] [--set-ratio 0.0] [--delete-ratio 0.0] [--seed 1]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CacheSimulatorMain.cpp -o cache_simulator
+ */
+
+namespace {
+
+struct Options {
+    std::string trace;
+    std::string generate;
+    std::vector<std::string> policies = {"lru", "fifo", "clock", "slru"};
+    std::vector<std::size_t> capacities = {1000, 10000, 100000};
+    SimulatorConfig config;
+    std::uint64_t requests = 10000000;
+    std::uint64_t keys = 1000000;
+    double zipf = 0.99;
+    double set_ratio = 0.0;
+    double delete_ratio = 0.0;
+    std::uint64_t seed = 1;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " --trace FILE [--policies lru,fifo,clock,slru,lrucache] [--capacities N,N,...]"
+                 " [--no-fill]\n"
+              << "       " << argv0
+              << " --generate FILE [--requests N] [--keys N] [--zipf S] [--set-ratio F]"
+                 " [--delete-ratio F] [--seed N]\n";
+}
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * Writes a trace whose keys follow a Zipf distribution with exponent
+ * opts.zipf. Each key has a fixed pseudo-random value size of 64 B to 4 KiB.
+ */
+void generateTrace(const Options& opts) {
+    std::vector<double> cdf(opts.keys);
+    double total = 0;
+    for (std::uint64_t i = 0; i < opts.keys; i++) {
+        total += 1.0 / std::pow(static_cast<double>(i + 1), opts.zipf);
+        cdf[i] = total;
+    }
+    std::mt19937_64 rng(opts.seed);
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+    TraceWriter writer(opts.generate);
+    for (std::uint64_t n = 0; n < opts.requests; n++) {
+        std::uint64_t key = std::upper_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        key = std::min(key, opts.keys - 1);
+        std::uint32_t size = 64 + static_cast<std::uint32_t>((key * 0x9e3779b97f4a7c15ULL) >> 52);
+        double c = coin(rng);
+        TraceOp op = c < opts.delete_ratio ? TraceOp::Delete
+                     : c < opts.delete_ratio + opts.set_ratio ? TraceOp::Set
+                     : TraceOp::Get;
+        writer.append(key, op, size);
+    }
+    writer.close();
+    std::cout << "wrote " << opts.requests << " records over " << opts.keys << " keys to "
+              << opts.generate << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--trace") {
+            opts.trace = next();
+        } else if (arg == "--generate") {
+            opts.generate = next();
+        } else if (arg == "--policies") {
+            opts.policies = split(next());
+        } else if (arg == "--capacities") {
+            opts.capacities.clear();
+            for (const std::string& c : split(next())) {
+                opts.capacities.push_back(std::stoull(c));
+            }
+        } else if (arg == "--no-fill") {
+            opts.config.fill_on_miss = false;
+        } else if (arg == "--requests") {
+            opts.requests = std::stoull(next());
+        } else if (arg == "--keys") {
+            opts.keys = std::stoull(next());
+        } else if (arg == "--zipf") {
+            opts.zipf = std::stod(next());
+        } else if (arg == "--set-ratio") {
+            opts.set_ratio = std::stod(next());
+        } else if (arg == "--delete-ratio") {
+            opts.delete_ratio = std::stod(next());
+        } else if (arg == "--seed") {
+            opts.seed = std::stoull(next());
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.trace.empty() == opts.generate.empty() || opts.keys == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        if (!opts.generate.empty()) {
+            generateTrace(opts);
+            return 0;
+        }
+        MappedTrace trace(opts.trace);
+        std::cout << opts.trace << ": " << trace.size() << " records" << std::endl;
+        std::cout << formatResults(simulateAll(trace, opts.policies, opts.capacities, opts.config));
+    } catch (const std::exception& e) {
+        std::cerr << "cache_simulator: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "CacheSimulator.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Test cases for the trace-driven cache simulator.
+ *
+ * Tests cover:
+ * - Writing and mapping a trace file
+ * - Small hand-checked sequences per policy
+ * - The fast LRU policy matches LRUCache exactly
+ * - LRU hit ratio never drops as capacity grows
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CacheSimulatorTest.cpp -o cache_simulator_test
+ */
+
+namespace {
+
+TraceRecord get(std::uint64_t key, std::uint32_t size = 1) {
+    return TraceRecord{key, size, static_cast<std::uint8_t>(TraceOp::Get), {0, 0, 0}};
+}
+
+// Mostly gets with some sets and deletes over a skewed key space.
+std::vector<TraceRecord> randomTrace(std::size_t n, std::uint64_t keys, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<TraceRecord> trace;
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint64_t r = rng();
+        std::uint64_t key = (r % keys) % ((r >> 20) % keys + 1);  // skewed toward small keys
+        std::uint8_t op = (r >> 40) % 100 < 90 ? 0 : (r >> 40) % 100 < 97 ? 1 : 2;
+        trace.push_back(TraceRecord{key, static_cast<std::uint32_t>(r >> 54), op, {0, 0, 0}});
+    }
+    return trace;
+}
+
+} // namespace
+
+void testTraceRoundTrip() {
+    std::cout << "Test 1: Write and Map a Trace" << std::endl;
+    std::string path = "/tmp/cache_simulator_test.trace";
+    {
+        TraceWriter writer(path);
+        writer.append(1, TraceOp::Set, 100);
+        writer.append(1, TraceOp::Get, 100);
+        writer.append(2, TraceOp::Get, 300);
+        writer.append(1, TraceOp::Delete, 0);
+        writer.append(1, TraceOp::Get, 100);
+        writer.close();
+    }
+    MappedTrace trace(path);
+    assert(trace.size() == 5);
+    assert(trace.begin()[2].key == 2 && trace.begin()[2].size == 300);
+
+    std::vector<SimulationResult> results = simulateAll(trace, {"lru", "slru"}, {1, 4});
+    assert(results.size() == 4);
+    for (const SimulationResult& r : results) {
+        assert(r.gets == 3 && r.sets == 1 && r.deletes == 1);
+        assert(r.hits == 1 && r.hit_bytes == 100 && r.get_bytes == 500);
+    }
+    assert(results[3].policy == "slru" && results[3].capacity == 4);
+
+    MappedTrace moved(std::move(trace));
+    assert(moved.size() == 5 && trace.size() == 0);
+
+    bool threw = false;
+    try {
+        simulate(moved.begin(), moved.end(), "random", 10);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::remove(path.c_str());
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testPolicySequences() {
+    std::cout << "Test 2: Hand-Checked Policy Sequences" << std::endl;
+    // Capacity 3: load 1 2 3, reuse 1, then 4 forces an eviction, then 1 again.
+    std::vector<TraceRecord> trace = {get(1), get(2), get(3), get(1), get(4), get(1), get(2)};
+    auto hits = [&trace](const std::string& policy) {
+        return simulate(trace.data(), trace.data() + trace.size(), policy, 3).hits;
+    };
+    assert(hits("lru") == 2);    // 4 evicts 2; hits: 1, 1
+    assert(hits("fifo") == 1);   // 4 evicts 1, then 1 evicts 2; hits: 1
+    assert(hits("clock") == 2);  // 1 has its second chance, 4 evicts 2; hits: 1, 1
+    // SLRU: a one-time scan does not flush a key that was used twice.
+    std::vector<TraceRecord> scan = {get(1), get(1)};
+    for (std::uint64_t k = 100; k < 110; k++) {
+        scan.push_back(get(k));
+    }
+    scan.push_back(get(1));
+    assert(simulate(scan.data(), scan.data() + scan.size(), "slru", 5).hits == 2);
+    assert(simulate(scan.data(), scan.data() + scan.size(), "lru", 5).hits == 1);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testFastLruMatchesLRUCache() {
+    std::cout << "Test 3: Fast LRU Matches LRUCache" << std::endl;
+    std::vector<TraceRecord> trace = randomTrace(200000, 5000, 7);
+    for (std::size_t capacity : {1, 10, 100, 1000}) {
+        for (bool fill : {true, false}) {
+            SimulatorConfig config;
+            config.fill_on_miss = fill;
+            LruPolicy fast(capacity);
+            LRUCachePolicy real(capacity);
+            SimulationResult a = replay(trace.data(), trace.data() + trace.size(), fast, config);
+            SimulationResult b = replay(trace.data(), trace.data() + trace.size(), real, config);
+            assert(a.hits == b.hits && a.hit_bytes == b.hit_bytes);
+            assert(fast.size() == real.size());
+        }
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testLruInclusion() {
+    std::cout << "Test 4: LRU Hit Ratio Grows with Capacity" << std::endl;
+    std::vector<TraceRecord> trace;
+    for (const TraceRecord& r : randomTrace(200000, 20000, 11)) {
+        trace.push_back(get(r.key));  // gets only, so LRU's stack property holds
+    }
+    std::uint64_t previous = 0;
+    for (std::size_t capacity = 1; capacity <= 32768; capacity *= 2) {
+        std::uint64_t hits = simulate(trace.data(), trace.data() + trace.size(), "lru", capacity).hits;
+        assert(hits >= previous);
+        previous = hits;
+    }
+    // Capacity above the key count: every policy misses only the first
+    // access to each key.
+    for (const std::string& policy : policyNames()) {
+        SimulationResult r = simulate(trace.data(), trace.data() + trace.size(), policy, 32768);
+        assert(r.gets == trace.size());
+        assert(r.hits == previous);
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Cache Simulator Tests...\n" << std::endl;
+
+    testTraceRoundTrip();
+    testPolicySequences();
+    testFastLruMatchesLRUCache();
+    testLruInclusion();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
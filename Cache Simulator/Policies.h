@@ -0,0 +1,396 @@
+#ifndef POLICIES_H
+#define POLICIES_H
+
+#include "../LRU Cache (Thread Safe)/LRUCache.h"
+#include "../Common/Hash.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Eviction policies for trace replay.
+ *
+ * Every policy has the same three operations on 64-bit trace keys:
+ *
+ *   bool get(key)     true on a hit; updates the policy's recency state
+ *   void put(key)     inserts (evicting if full) or refreshes a key
+ *   void remove(key)  drops a key if present
+ *
+ * They are single-threaded and keep no values: only keys, flat index
+ * arrays and an open-addressing table, allocated at construction. That is
+ * what lets a replay run at tens of millions of accesses per second.
+ * LRUCachePolicy instead drives the real LRUCache, to check the fast LRU
+ * against it and to measure the production structure itself.
+ */
+
+/**
+ * Open-addressing map from trace key to entry index, at most half full.
+ */
+class KeyIndex {
+public:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        std::uint32_t entry;  // kNone if empty
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_;
+
+public:
+    explicit KeyIndex(std::size_t capacity) {
+        std::size_t size = 16;
+        while (size < capacity * 2) {
+            size *= 2;
+        }
+        slots_.assign(size, Slot{0, kNone});
+        mask_ = size - 1;
+    }
+
+    std::uint32_t find(std::uint64_t key) const {
+        for (std::size_t i = fmix64(key) & mask_;; i = (i + 1) & mask_) {
+            const Slot& slot = slots_[i];
+            if (slot.entry == kNone || slot.key == key) {
+                return slot.entry;
+            }
+        }
+    }
+
+    /** Adds a key that is not present. */
+    void insert(std::uint64_t key, std::uint32_t entry) {
+        std::size_t i = fmix64(key) & mask_;
+        while (slots_[i].entry != kNone) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = Slot{key, entry};
+    }
+
+    /** Removes a key that is present, shifting later probes back. */
+    void erase(std::uint64_t key) {
+        std::size_t i = fmix64(key) & mask_;
+        while (slots_[i].key != key || slots_[i].entry == kNone) {
+            i = (i + 1) & mask_;
+        }
+        for (std::size_t j = (i + 1) & mask_; slots_[j].entry != kNone; j = (j + 1) & mask_) {
+            std::size_t home = fmix64(slots_[j].key) & mask_;
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i].entry = kNone;
+    }
+};
+
+/**
+ * Entries linked into one or more doubly linked lists by index, with a
+ * sentinel per list after the last entry. Shared by the list policies.
+ */
+class LinkedEntries {
+protected:
+    static constexpr std::uint32_t kNone = KeyIndex::kNone;
+
+    std::uint32_t capacity_;
+    std::uint32_t size_ = 0;
+    std::uint32_t used_ = 0;
+    std::uint32_t free_head_ = kNone;
+    KeyIndex index_;
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint32_t> prev_;
+    std::vector<std::uint32_t> next_;
+
+    LinkedEntries(std::size_t capacity, std::uint32_t lists)
+        : capacity_(checkedCapacity(capacity)), index_(capacity),
+          keys_(capacity), prev_(capacity + lists), next_(capacity + lists) {
+        for (std::uint32_t l = 0; l < lists; l++) {
+            prev_[sentinel(l)] = next_[sentinel(l)] = sentinel(l);
+        }
+    }
+
+    static std::uint32_t checkedCapacity(std::size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        if (capacity > (std::size_t(1) << 30)) {
+            throw std::invalid_argument("Capacity must be at most 2^30");
+        }
+        return static_cast<std::uint32_t>(capacity);
+    }
+
+    std::uint32_t sentinel(std::uint32_t list) const {
+        return capacity_ + list;
+    }
+
+    std::uint32_t front(std::uint32_t list) const {
+        return next_[sentinel(list)];
+    }
+
+    bool listEmpty(std::uint32_t list) const {
+        return front(list) == sentinel(list);
+    }
+
+    void unlink(std::uint32_t e) {
+        next_[prev_[e]] = next_[e];
+        prev_[next_[e]] = prev_[e];
+    }
+
+    void linkBack(std::uint32_t list, std::uint32_t e) {
+        std::uint32_t s = sentinel(list);
+        prev_[e] = prev_[s];
+        next_[e] = s;
+        next_[prev_[s]] = e;
+        prev_[s] = e;
+    }
+
+    std::uint32_t allocate(std::uint64_t key) {
+        std::uint32_t e;
+        if (free_head_ != kNone) {
+            e = free_head_;
+            free_head_ = next_[e];
+        } else {
+            e = used_++;
+        }
+        keys_[e] = key;
+        index_.insert(key, e);
+        size_++;
+        return e;
+    }
+
+    /** Unlinks and frees an entry. */
+    void release(std::uint32_t e) {
+        unlink(e);
+        index_.erase(keys_[e]);
+        next_[e] = free_head_;
+        free_head_ = e;
+        size_--;
+    }
+
+public:
+    std::size_t size() const {
+        return size_;
+    }
+};
+
+/**
+ * Least recently used: hits move an entry to the back, the front is evicted.
+ */
+class LruPolicy : public LinkedEntries {
+public:
+    explicit LruPolicy(std::size_t capacity) : LinkedEntries(capacity, 1) {}
+
+    bool get(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e == kNone) {
+            return false;
+        }
+        unlink(e);
+        linkBack(0, e);
+        return true;
+    }
+
+    void put(std::uint64_t key) {
+        if (get(key)) {
+            return;
+        }
+        if (size_ == capacity_) {
+            release(front(0));
+        }
+        linkBack(0, allocate(key));
+    }
+
+    void remove(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e != kNone) {
+            release(e);
+        }
+    }
+};
+
+/**
+ * First in, first out: hits change nothing, the oldest insert is evicted.
+ */
+class FifoPolicy : public LinkedEntries {
+public:
+    explicit FifoPolicy(std::size_t capacity) : LinkedEntries(capacity, 1) {}
+
+    bool get(std::uint64_t key) {
+        return index_.find(key) != kNone;
+    }
+
+    void put(std::uint64_t key) {
+        if (get(key)) {
+            return;
+        }
+        if (size_ == capacity_) {
+            release(front(0));
+        }
+        linkBack(0, allocate(key));
+    }
+
+    void remove(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e != kNone) {
+            release(e);
+        }
+    }
+};
+
+/**
+ * CLOCK (second chance): FIFO order, but a hit sets a reference bit and
+ * the eviction scan clears set bits and requeues those entries instead of
+ * evicting them.
+ */
+class ClockPolicy : public LinkedEntries {
+private:
+    std::vector<std::uint8_t> referenced_;
+
+public:
+    explicit ClockPolicy(std::size_t capacity) : LinkedEntries(capacity, 1), referenced_(capacity) {}
+
+    bool get(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e == kNone) {
+            return false;
+        }
+        referenced_[e] = 1;
+        return true;
+    }
+
+    void put(std::uint64_t key) {
+        if (get(key)) {
+            return;
+        }
+        if (size_ == capacity_) {
+            std::uint32_t e = front(0);
+            while (referenced_[e]) {
+                referenced_[e] = 0;
+                unlink(e);
+                linkBack(0, e);
+                e = front(0);
+            }
+            release(e);
+        }
+        std::uint32_t e = allocate(key);
+        referenced_[e] = 0;
+        linkBack(0, e);
+    }
+
+    void remove(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e != kNone) {
+            release(e);
+        }
+    }
+};
+
+/**
+ * Segmented LRU: new keys enter a probationary LRU segment and move to a
+ * protected segment (80% of capacity) on their second access. Keys pushed
+ * out of the protected segment go back to probation, so one scan of
+ * single-use keys cannot flush the keys that are reused.
+ */
+class SlruPolicy : public LinkedEntries {
+private:
+    static constexpr std::uint32_t kProbation = 0;
+    static constexpr std::uint32_t kProtected = 1;
+
+    std::vector<std::uint8_t> segment_;
+    std::uint32_t protected_capacity_;
+    std::uint32_t protected_size_ = 0;
+
+public:
+    explicit SlruPolicy(std::size_t capacity)
+        : LinkedEntries(capacity, 2), segment_(capacity),
+          protected_capacity_(static_cast<std::uint32_t>(capacity - (capacity + 4) / 5)) {}
+
+    bool get(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e == kNone) {
+            return false;
+        }
+        unlink(e);
+        if (segment_[e] == kProbation) {
+            if (protected_capacity_ == 0) {
+                linkBack(kProbation, e);
+                return true;
+            }
+            segment_[e] = kProtected;
+            protected_size_++;
+            if (protected_size_ > protected_capacity_) {
+                std::uint32_t demoted = front(kProtected);
+                unlink(demoted);
+                segment_[demoted] = kProbation;
+                protected_size_--;
+                linkBack(kProbation, demoted);
+            }
+        }
+        linkBack(segment_[e], e);
+        return true;
+    }
+
+    void put(std::uint64_t key) {
+        if (get(key)) {
+            return;
+        }
+        if (size_ == capacity_) {
+            std::uint32_t victim = listEmpty(kProbation) ? front(kProtected) : front(kProbation);
+            if (segment_[victim] == kProtected) {
+                protected_size_--;
+            }
+            release(victim);
+        }
+        std::uint32_t e = allocate(key);
+        segment_[e] = kProbation;
+        linkBack(kProbation, e);
+    }
+
+    void remove(std::uint64_t key) {
+        std::uint32_t e = index_.find(key);
+        if (e != kNone) {
+            if (segment_[e] == kProtected) {
+                protected_size_--;
+            }
+            release(e);
+        }
+    }
+};
+
+/**
+ * Drives the production LRUCache, locks and shared_ptr nodes included,
+ * with empty values. Much slower than LruPolicy, with the same hits.
+ */
+class LRUCachePolicy {
+private:
+    LRUCache<std::uint64_t, char> cache_;
+
+    static int checkedCapacity(std::size_t capacity) {
+        if (capacity > static_cast<std::size_t>(INT32_MAX)) {
+            throw std::invalid_argument("Capacity must fit in an int");
+        }
+        return static_cast<int>(capacity);
+    }
+
+public:
+    explicit LRUCachePolicy(std::size_t capacity) : cache_(checkedCapacity(capacity)) {}
+
+    bool get(std::uint64_t key) {
+        return cache_.get(key) != nullptr;
+    }
+
+    void put(std::uint64_t key) {
+        cache_.put(key, 0);
+    }
+
+    void remove(std::uint64_t key) {
+        cache_.remove(key);
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(cache_.size());
+    }
+};
+
+#endif // POLICIES_H
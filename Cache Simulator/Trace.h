@@ -0,0 +1,191 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Operation recorded in a trace.
+ */
+enum class TraceOp : std::uint8_t {
+    Get = 0,
+    Set = 1,
+    Delete = 2,
+};
+
+/**
+ * One access in a binary trace file. A trace is a flat array of these in
+ * host byte order, with no header, so it can be mapped and read in place.
+ */
+struct TraceRecord {
+    std::uint64_t key;        // already hashed or numbered by whoever captured it
+    std::uint32_t size;       // value size in bytes
+    std::uint8_t op;          // TraceOp
+    std::uint8_t reserved[3];
+};
+
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+/**
+ * Read-only memory mapping of a trace file.
+ *
+ * The file is mapped once and the kernel is told it will be read
+ * sequentially, so replays stream from the page cache without copying or
+ * parsing. Move-only.
+ */
+class MappedTrace {
+private:
+    const TraceRecord* records_ = nullptr;
+    std::size_t count_ = 0;
+    std::size_t bytes_ = 0;
+
+public:
+    /**
+     * Maps a trace file.
+     *
+     * @param path The trace file
+     * @throws std::system_error if the file cannot be opened or mapped
+     * @throws std::invalid_argument if its size is not a multiple of
+     *         sizeof(TraceRecord)
+     */
+    explicit MappedTrace(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "fstat " + path);
+        }
+        bytes_ = static_cast<std::size_t>(st.st_size);
+        if (bytes_ % sizeof(TraceRecord) != 0) {
+            ::close(fd);
+            throw std::invalid_argument("Trace size is not a multiple of the record size: " + path);
+        }
+        if (bytes_ > 0) {
+            void* data = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "mmap " + path);
+            }
+            ::madvise(data, bytes_, MADV_SEQUENTIAL);
+            records_ = static_cast<const TraceRecord*>(data);
+            count_ = bytes_ / sizeof(TraceRecord);
+        }
+        ::close(fd);  // the mapping stays valid
+    }
+
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    MappedTrace(MappedTrace&& other) noexcept
+        : records_(std::exchange(other.records_, nullptr)),
+          count_(std::exchange(other.count_, 0)),
+          bytes_(std::exchange(other.bytes_, 0)) {}
+
+    MappedTrace& operator=(MappedTrace&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            records_ = std::exchange(other.records_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+            bytes_ = std::exchange(other.bytes_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedTrace() {
+        unmap();
+    }
+
+    const TraceRecord* begin() const { return records_; }
+    const TraceRecord* end() const { return records_ + count_; }
+
+    /**
+     * Returns the number of records in the trace.
+     *
+     * @return The record count
+     */
+    std::size_t size() const {
+        return count_;
+    }
+
+private:
+    void unmap() {
+        if (records_ != nullptr) {
+            ::munmap(const_cast<TraceRecord*>(records_), bytes_);
+            records_ = nullptr;
+        }
+    }
+};
+
+/**
+ * Writes a trace file record by record, buffered.
+ */
+class TraceWriter {
+private:
+    std::FILE* file_;
+
+public:
+    /**
+     * Creates or truncates a trace file.
+     *
+     * @param path The trace file
+     * @throws std::system_error if the file cannot be created
+     */
+    explicit TraceWriter(const std::string& path) : file_(std::fopen(path.c_str(), "wb")) {
+        if (file_ == nullptr) {
+            throw std::system_error(errno, std::generic_category(), "fopen " + path);
+        }
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    ~TraceWriter() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+
+    /**
+     * Appends one record.
+     *
+     * @param key The key
+     * @param op The operation
+     * @param size The value size in bytes
+     * @throws std::system_error if the write fails
+     */
+    void append(std::uint64_t key, TraceOp op, std::uint32_t size) {
+        TraceRecord record{key, size, static_cast<std::uint8_t>(op), {0, 0, 0}};
+        if (std::fwrite(&record, sizeof(record), 1, file_) != 1) {
+            throw std::system_error(errno, std::generic_category(), "fwrite");
+        }
+    }
+
+    /**
+     * Flushes and closes the file. Further appends are not allowed.
+     *
+     * @throws std::system_error if the final write fails
+     */
+    void close() {
+        std::FILE* file = std::exchange(file_, nullptr);
+        if (file != nullptr && std::fclose(file) != 0) {
+            throw std::system_error(errno, std::generic_category(), "fclose");
+        }
+    }
+};
+
+#endif // TRACE_H
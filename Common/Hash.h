@@ -0,0 +1,26 @@
+#ifndef COMMON_HASH_H
+#define COMMON_HASH_H
+
+#include <cstdint>
+
+/**
+ * The MurmurHash3 64-bit finalizer (fmix64).
+ *
+ * Every input bit affects every output bit, so the low bits of the result
+ * are usable as a table, shard or stripe index even when the input is a
+ * weak hash such as std::hash<int>, which is the identity on libstdc++.
+ * It is a bijection, so distinct inputs stay distinct.
+ *
+ * @param h The value to mix
+ * @return The mixed value
+ */
+inline std::uint64_t fmix64(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+#endif // COMMON_HASH_H
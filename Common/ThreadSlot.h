@@ -0,0 +1,130 @@
+#ifndef THREAD_SLOT_H
+#define THREAD_SLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace thread_slot_detail {
+
+struct Entry {
+    void* value = nullptr;
+    std::uint64_t generation = 0;   // of the slot that stored value
+};
+
+/**
+ * Returns this thread's slot table, indexed by slot id.
+ */
+inline std::vector<Entry>& threadTable() {
+    thread_local std::vector<Entry> table;
+    return table;
+}
+
+/**
+ * Hands out slot ids, reusing the ids of destroyed slots, and a generation
+ * that is never reused.
+ */
+class Registry {
+private:
+    std::mutex lock_;
+    std::vector<std::size_t> free_;
+    std::size_t next_id_ = 0;
+    std::uint64_t next_generation_ = 1;   // 0 marks an empty entry
+
+public:
+    void acquire(std::size_t& id, std::uint64_t& generation) {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (free_.empty()) {
+            id = next_id_++;
+        } else {
+            id = free_.back();
+            free_.pop_back();
+        }
+        generation = next_generation_++;
+    }
+
+    void release(std::size_t id) {
+        std::lock_guard<std::mutex> guard(lock_);
+        free_.push_back(id);
+    }
+
+    static Registry& instance() {
+        // Never destroyed, so slots in static objects can still release.
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+};
+
+} // namespace thread_slot_detail
+
+/**
+ * One pointer per thread for an object that keeps a private record per
+ * calling thread, such as an epoch record or a histogram shard.
+ *
+ * Every thread has one table shared by all slots, indexed by slot id, so a
+ * lookup is a thread_local access and an index with no lock. The ids of
+ * destroyed slots are reused, which keeps each thread's table as long as
+ * the largest number of slots alive at once rather than the number ever
+ * created. Each entry also records the generation of the slot that wrote
+ * it; a slot that inherits an id ignores the stale pointers other threads
+ * still hold for that id.
+ *
+ * The owner keeps the records themselves and frees them when it is
+ * destroyed; the slot only remembers where each thread's record is.
+ */
+class ThreadSlot {
+private:
+    std::size_t id_;
+    std::uint64_t generation_;
+
+public:
+    ThreadSlot() {
+        thread_slot_detail::Registry::instance().acquire(id_, generation_);
+    }
+
+    ~ThreadSlot() {
+        thread_slot_detail::Registry::instance().release(id_);
+    }
+
+    ThreadSlot(const ThreadSlot&) = delete;
+    ThreadSlot& operator=(const ThreadSlot&) = delete;
+
+    /**
+     * Returns the pointer the calling thread stored in this slot.
+     *
+     * @return The pointer, or nullptr if this thread has not set one
+     */
+    void* get() const {
+        const std::vector<thread_slot_detail::Entry>& table = thread_slot_detail::threadTable();
+        if (id_ < table.size() && table[id_].generation == generation_) {
+            return table[id_].value;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Stores the calling thread's pointer.
+     *
+     * @param value The pointer, owned by the caller
+     */
+    void set(void* value) {
+        std::vector<thread_slot_detail::Entry>& table = thread_slot_detail::threadTable();
+        if (table.size() <= id_) {
+            table.resize(id_ + 1);
+        }
+        table[id_].value = value;
+        table[id_].generation = generation_;
+    }
+
+    /**
+     * Returns the slot's index in every thread's table.
+     *
+     * @return The id, possibly shared with a destroyed slot
+     */
+    std::size_t id() const {
+        return id_;
+    }
+};
+
+#endif // THREAD_SLOT_H
@@ -0,0 +1,83 @@
+#include "ThreadSlot.h"
+#include "../Metrics/Metrics.h"
+#include "../LRU Cache (Thread Safe)/EpochManager.h"
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <thread>
+
+/**
+ * Test cases for ThreadSlot.
+ *
+ * Tests cover:
+ * - One pointer per thread
+ * - Reusing the id of a destroyed slot without its stale pointers
+ * - Per-thread tables staying small while many owners come and go
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread ThreadSlotTest.cpp -o thread_slot_test
+ */
+
+void testPerThread() {
+    std::cout << "Test 1: One Pointer per Thread" << std::endl;
+    ThreadSlot slot;
+    int mine = 1;
+    int theirs = 2;
+    assert(slot.get() == nullptr);
+    slot.set(&mine);
+    std::thread other([&slot, &theirs]() {
+        assert(slot.get() == nullptr);
+        slot.set(&theirs);
+        assert(slot.get() == &theirs);
+    });
+    other.join();
+    assert(slot.get() == &mine);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testIdReuse() {
+    std::cout << "Test 2: Reused Ids Ignore Stale Pointers" << std::endl;
+    int value = 1;
+    std::size_t id;
+    {
+        ThreadSlot first;
+        id = first.id();
+        first.set(&value);
+    }
+    ThreadSlot second;
+    assert(second.id() == id);
+    assert(second.get() == nullptr);  // not first's pointer
+    second.set(&value);
+    assert(second.get() == &value);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testOwnersComeAndGo() {
+    std::cout << "Test 3: Tables Stay Small as Owners Come and Go" << std::endl;
+    std::size_t before = thread_slot_detail::threadTable().size();
+    for (int i = 0; i < 10000; i++) {
+        // Each one registers this thread, then frees its record. A reused id
+        // must not lead the next one to the freed record.
+        auto histogram = std::make_unique<Histogram>();
+        histogram->record(i);
+        histogram->record(i);
+        assert(histogram->snapshot().count == 2);
+
+        EpochManager epochs;
+        auto guard = epochs.pin();
+    }
+    assert(thread_slot_detail::threadTable().size() <= before + 2);
+    std::cout << "✓ Passed (table size " << thread_slot_detail::threadTable().size() << ")\n"
+              << std::endl;
+}
+
+int main() {
+    std::cout << "Running Thread Slot Tests...\n" << std::endl;
+
+    testPerThread();
+    testIdReuse();
+    testOwnersComeAndGo();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,322 @@
+#ifndef COMPACT_LRU_CACHE_H
+#define COMPACT_LRU_CACHE_H
+
+#include "../Common/Hash.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Thread-safe LRU cache with a structure-of-arrays layout.
+ *
+ * LRUCache keeps each entry in a heap node holding the key, the value and
+ * two shared_ptr links, so following the list or probing the map loads the
+ * whole entry. Here the metadata and the payload live apart:
+ *
+ * - metadata: an open-addressing table of {hash, entry index} pairs and
+ *   parallel arrays of hashes and prev/next indices (4 bytes each);
+ * - payload: arrays of keys and values, indexed by entry.
+ *
+ * A lookup compares 32-bit hashes in the table and reads a key only when
+ * the hash matches. Eviction follows the prev/next indices and finds the
+ * victim's table slot from its stored hash, without reading the victim's
+ * key or value. All storage is allocated up front and entry slots are
+ * reused, so once the cache is full put() allocates nothing for the cache
+ * itself; assigning K and V into a slot still allocates if their copy
+ * assignment does (e.g. a longer std::string).
+ *
+ * Keys and values must be default-constructible; capacity entries of each
+ * are constructed by the constructor. Unlike LRUCache, get() takes the
+ * write lock directly since a hit always reorders the list.
+ *
+ * Time Complexity:
+ * - get / put / remove: O(1) expected
+ * - clear: O(capacity)
+ *
+ * Space Complexity: O(capacity), allocated at construction
+ *
+ * @tparam K The type of keys maintained by this cache
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class CompactLRUCache {
+private:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+
+    struct Slot {
+        std::uint32_t hash;
+        std::uint32_t entry;  // kNone if the slot is empty
+    };
+
+    // Metadata.
+    std::vector<Slot> table_;            // linear probing, at most half full
+    std::vector<std::uint32_t> hashes_;  // per entry, to find its slot on eviction
+    std::vector<std::uint32_t> prev_;    // per entry, plus the sentinel at index capacity_
+    std::vector<std::uint32_t> next_;    // also links the free list
+    // Payload.
+    std::vector<K> keys_;
+    std::vector<V> values_;
+
+    std::uint32_t capacity_;
+    std::uint32_t mask_;
+    std::uint32_t size_ = 0;
+    std::uint32_t used_ = 0;         // entries handed out at least once
+    std::uint32_t free_head_ = kNone;
+    Hash hasher_;
+    mutable std::shared_mutex lock_;
+
+    std::uint32_t hashOf(const K& key) const {
+        return static_cast<std::uint32_t>(fmix64(hasher_(key)));
+    }
+
+    /**
+     * Returns the table position holding key, or kNone.
+     */
+    std::uint32_t findSlot(const K& key, std::uint32_t hash) const {
+        for (std::uint32_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+            const Slot& slot = table_[pos];
+            if (slot.entry == kNone) {
+                return kNone;
+            }
+            if (slot.hash == hash && keys_[slot.entry] == key) {
+                return pos;
+            }
+        }
+    }
+
+    /**
+     * Returns the table position of a live entry, using only its stored hash.
+     */
+    std::uint32_t slotOf(std::uint32_t entry) const {
+        std::uint32_t pos = hashes_[entry] & mask_;
+        while (table_[pos].entry != entry) {
+            pos = (pos + 1) & mask_;
+        }
+        return pos;
+    }
+
+    void insertSlot(std::uint32_t hash, std::uint32_t entry) {
+        std::uint32_t pos = hash & mask_;
+        while (table_[pos].entry != kNone) {
+            pos = (pos + 1) & mask_;
+        }
+        table_[pos] = Slot{hash, entry};
+    }
+
+    /**
+     * Empties a table slot, shifting later slots of the probe run back so
+     * lookups never need tombstones.
+     */
+    void eraseSlot(std::uint32_t pos) {
+        std::uint32_t next = (pos + 1) & mask_;
+        while (table_[next].entry != kNone) {
+            std::uint32_t home = table_[next].hash & mask_;
+            // The slot at next may fill the hole if its home is not in (pos, next].
+            if (((next - home) & mask_) >= ((next - pos) & mask_)) {
+                table_[pos] = table_[next];
+                pos = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        table_[pos].entry = kNone;
+    }
+
+    void unlink(std::uint32_t entry) {
+        next_[prev_[entry]] = next_[entry];
+        prev_[next_[entry]] = prev_[entry];
+    }
+
+    void linkAtEnd(std::uint32_t entry) {
+        std::uint32_t last = prev_[capacity_];
+        prev_[entry] = last;
+        next_[entry] = capacity_;
+        next_[last] = entry;
+        prev_[capacity_] = entry;
+    }
+
+    /**
+     * Returns an unused entry, evicting the least recently used one if the
+     * cache is full. Caller holds the write lock.
+     */
+    std::uint32_t acquireEntry() {
+        if (size_ == capacity_) {
+            std::uint32_t victim = next_[capacity_];
+            unlink(victim);
+            eraseSlot(slotOf(victim));
+            return victim;  // its key and value are overwritten by the caller
+        }
+        size_++;
+        if (free_head_ != kNone) {
+            std::uint32_t entry = free_head_;
+            free_head_ = next_[entry];
+            return entry;
+        }
+        return used_++;
+    }
+
+public:
+    /**
+     * Initializes a cache and allocates storage for capacity entries.
+     *
+     * @param capacity The maximum number of entries the cache can hold
+     * @throws std::invalid_argument if capacity <= 0 or capacity > 2^30
+     */
+    explicit CompactLRUCache(int capacity) {
+        if (capacity <= 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        if (capacity > (1 << 30)) {
+            throw std::invalid_argument("Capacity must be at most 2^30");
+        }
+        capacity_ = static_cast<std::uint32_t>(capacity);
+        std::uint32_t table_size = 2;
+        while (table_size < 2 * capacity_) {
+            table_size *= 2;
+        }
+        mask_ = table_size - 1;
+        table_.assign(table_size, Slot{0, kNone});
+        hashes_.assign(capacity_, 0);
+        prev_.assign(capacity_ + 1, capacity_);
+        next_.assign(capacity_ + 1, capacity_);
+        keys_.resize(capacity_);
+        values_.resize(capacity_);
+    }
+
+    /**
+     * Retrieves the value associated with the given key and marks it as
+     * recently used.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to a copy of the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key) {
+        std::uint32_t hash = hashOf(key);
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        std::uint32_t pos = findSlot(key, hash);
+        if (pos == kNone) {
+            return nullptr;
+        }
+        std::uint32_t entry = table_[pos].entry;
+        unlink(entry);
+        linkAtEnd(entry);
+        return std::make_shared<V>(values_[entry]);
+    }
+
+    /**
+     * Inserts or updates a key-value pair and marks it as recently used.
+     * If the cache is at capacity, the least recently used entry is removed.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        std::uint32_t hash = hashOf(key);
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        std::uint32_t pos = findSlot(key, hash);
+        if (pos != kNone) {
+            std::uint32_t entry = table_[pos].entry;
+            values_[entry] = value;
+            unlink(entry);
+            linkAtEnd(entry);
+            return;
+        }
+        std::uint32_t entry = acquireEntry();
+        keys_[entry] = key;
+        values_[entry] = value;
+        hashes_[entry] = hash;
+        insertSlot(hash, entry);
+        linkAtEnd(entry);
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        std::uint32_t hash = hashOf(key);
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        std::uint32_t pos = findSlot(key, hash);
+        if (pos == kNone) {
+            return false;
+        }
+        std::uint32_t entry = table_[pos].entry;
+        unlink(entry);
+        eraseSlot(pos);
+        keys_[entry] = K();
+        values_[entry] = V();
+        next_[entry] = free_head_;
+        free_head_ = entry;
+        size_--;
+        return true;
+    }
+
+    /**
+     * Removes all entries from the cache. Storage stays allocated.
+     */
+    void clear() {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        for (Slot& slot : table_) {
+            slot.entry = kNone;
+        }
+        for (std::uint32_t i = 0; i < used_; i++) {
+            keys_[i] = K();
+            values_[i] = V();
+        }
+        prev_[capacity_] = capacity_;
+        next_[capacity_] = capacity_;
+        size_ = 0;
+        used_ = 0;
+        free_head_ = kNone;
+    }
+
+    /**
+     * Checks whether the given key is present in the cache.
+     * Does not affect the LRU order.
+     *
+     * @param key The key whose presence is to be tested
+     * @return true if the key is present, false otherwise
+     */
+    bool containsKey(const K& key) const {
+        std::uint32_t hash = hashOf(key);
+        std::shared_lock<std::shared_mutex> read_lock(lock_);
+        return findSlot(key, hash) != kNone;
+    }
+
+    /**
+     * Returns the number of entries currently in the cache.
+     *
+     * @return The current size of the cache
+     */
+    int size() const {
+        std::shared_lock<std::shared_mutex> read_lock(lock_);
+        return static_cast<int>(size_);
+    }
+
+    /**
+     * Checks whether the cache is empty.
+     *
+     * @return true if the cache contains no entries, false otherwise
+     */
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the maximum number of entries.
+     *
+     * @return The capacity given at construction
+     */
+    int getCapacity() const {
+        return static_cast<int>(capacity_);
+    }
+};
+
+#endif // COMPACT_LRU_CACHE_H
@@ -0,0 +1,200 @@
+#include "CompactLRUCache.h"
+#include "LRUCache.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Compares LRUCache with CompactLRUCache on eviction and lookup paths.
+ *
+ * Both caches hold 256-byte values. For each workload the benchmark reports
+ * nanoseconds per operation and, where the kernel exposes hardware counters
+ * to the process, L1 data cache and last-level cache misses per operation.
+ *
+ * Workloads:
+ * - evict:    put() of new keys into a full cache, so every put evicts
+ * - get-hit:  get() of random resident keys
+ * - get-miss: get() of absent keys, which only probes the index
+ *
+ * Usage:
+ *   compact_lru_cache_bench [--entries 500000] [--ops 2000000]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CompactLRUCacheBenchmark.cpp -o compact_lru_cache_bench
+ */
+
+namespace {
+
+struct Value {
+    std::array<char, 256> bytes{};
+};
+
+/**
+ * A hardware event counter for the calling thread, user space only.
+ * valid() is false where perf events are unavailable (e.g. in containers).
+ */
+class PerfCounter {
+private:
+    int fd_ = -1;
+
+public:
+    PerfCounter(std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~PerfCounter() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool valid() const { return fd_ >= 0; }
+
+    void start() {
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    std::uint64_t stop() {
+        std::uint64_t count = 0;
+        if (fd_ >= 0) {
+            ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fd_, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+};
+
+struct Result {
+    double ns_per_op;
+    double l1_misses_per_op;  // negative if unavailable
+    double llc_misses_per_op;
+};
+
+template <typename Body>
+Result measure(std::size_t ops, Body&& body) {
+    PerfCounter l1(PERF_TYPE_HW_CACHE,
+                   PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    PerfCounter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    l1.start();
+    llc.start();
+    auto begin = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    std::uint64_t l1_misses = l1.stop();
+    std::uint64_t llc_misses = llc.stop();
+
+    Result result;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(end - begin).count() / ops;
+    result.l1_misses_per_op = l1.valid() ? static_cast<double>(l1_misses) / ops : -1;
+    result.llc_misses_per_op = llc.valid() ? static_cast<double>(llc_misses) / ops : -1;
+    return result;
+}
+
+template <typename Cache>
+void runWorkloads(const std::string& name, std::size_t entries, std::size_t ops) {
+    Cache cache(static_cast<int>(entries));
+    Value value;
+    for (std::uint64_t k = 0; k < entries; k++) {
+        cache.put(k, value);
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<std::uint64_t> resident(ops);
+    for (auto& k : resident) {
+        k = rng() % entries;
+    }
+
+    std::uint64_t next_key = entries;
+    Result evict = measure(ops, [&]() {
+        for (std::size_t i = 0; i < ops; i++) {
+            cache.put(next_key++, value);
+        }
+    });
+    // The cache now holds the keys [next_key - entries, next_key).
+    std::uint64_t base = next_key - entries;
+    std::size_t found = 0;
+    Result hit = measure(ops, [&]() {
+        for (std::size_t i = 0; i < ops; i++) {
+            found += cache.get(base + resident[i]) != nullptr;
+        }
+    });
+    Result miss = measure(ops, [&]() {
+        for (std::size_t i = 0; i < ops; i++) {
+            found += cache.get(next_key + resident[i]) != nullptr;
+        }
+    });
+    if (found != ops) {
+        std::cerr << name << ": unexpected hit count " << found << std::endl;
+    }
+
+    auto print = [&name](const char* workload, const Result& r) {
+        std::cout << std::left << std::setw(18) << name << std::setw(10) << workload << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(10) << r.ns_per_op;
+        if (r.l1_misses_per_op >= 0) {
+            std::cout << std::setprecision(2) << std::setw(14) << r.l1_misses_per_op;
+        } else {
+            std::cout << std::setw(14) << "n/a";
+        }
+        if (r.llc_misses_per_op >= 0) {
+            std::cout << std::setprecision(2) << std::setw(14) << r.llc_misses_per_op;
+        } else {
+            std::cout << std::setw(14) << "n/a";
+        }
+        std::cout << std::endl;
+    };
+    print("evict", evict);
+    print("get-hit", hit);
+    print("get-miss", miss);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t entries = 500000;
+    std::size_t ops = 2000000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--entries") {
+            entries = std::stoul(argv[i + 1]);
+        } else if (flag == "--ops") {
+            ops = std::stoul(argv[i + 1]);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(18) << "cache" << std::setw(10) << "workload"
+              << std::right << std::setw(10) << "ns/op" << std::setw(14) << "L1D miss/op"
+              << std::setw(14) << "LLC miss/op" << std::endl;
+    runWorkloads<LRUCache<std::uint64_t, Value>>("LRUCache", entries, ops);
+    runWorkloads<CompactLRUCache<std::uint64_t, Value>>("CompactLRUCache", entries, ops);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "CompactLRUCache.h"
+#include "LRUCache.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for CompactLRUCache.
+ *
+ * Tests cover:
+ * - Basic put, get and LRU eviction
+ * - Removal, clearing and reuse of entry slots
+ * - Identical behaviour to LRUCache under a random workload
+ * - Concurrent access
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread CompactLRUCacheTest.cpp -o compact_lru_cache_test
+ */
+
+void testPutGetEvict() {
+    std::cout << "Test 1: Put, Get and LRU Eviction" << std::endl;
+    CompactLRUCache<std::string, int> cache(3);
+    assert(cache.getCapacity() == 3);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.put("c", 3);
+    assert(*cache.get("a") == 1);  // a becomes most recently used
+
+    cache.put("d", 4);             // evicts b
+    assert(cache.get("b") == nullptr);
+    assert(*cache.get("a") == 1);
+    assert(*cache.get("c") == 3);
+    assert(*cache.get("d") == 4);
+
+    cache.put("c", 30);            // update keeps the size
+    assert(cache.size() == 3);
+    assert(*cache.get("c") == 30);
+
+    bool threw = false;
+    try {
+        CompactLRUCache<int, int> invalid(0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRemoveAndClear() {
+    std::cout << "Test 2: Remove, Clear and Slot Reuse" << std::endl;
+    CompactLRUCache<int, std::string> cache(4);
+    for (int i = 0; i < 4; i++) {
+        cache.put(i, "v" + std::to_string(i));
+    }
+    assert(cache.remove(1));
+    assert(!cache.remove(1));
+    assert(!cache.containsKey(1));
+    assert(cache.size() == 3);
+
+    cache.put(10, "v10");          // reuses the freed entry, nothing is evicted
+    assert(cache.size() == 4);
+    assert(cache.containsKey(0));
+    cache.put(11, "v11");          // now 0 is evicted
+    assert(!cache.containsKey(0));
+    assert(*cache.get(10) == "v10");
+
+    cache.clear();
+    assert(cache.isEmpty());
+    assert(cache.get(10) == nullptr);
+    for (int i = 0; i < 10; i++) {
+        cache.put(i, "w" + std::to_string(i));
+    }
+    assert(cache.size() == 4);
+    assert(*cache.get(9) == "w9");
+    assert(cache.get(5) == nullptr);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMatchesLRUCache() {
+    std::cout << "Test 3: Same Results as LRUCache on a Random Workload" << std::endl;
+    // Few keys, a small capacity and frequent removals exercise probe
+    // collisions and backward-shift deletion.
+    CompactLRUCache<int, int> compact(64);
+    LRUCache<int, int> reference(64);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 200000; i++) {
+        int key = static_cast<int>(rng() % 200);
+        int op = static_cast<int>(rng() % 10);
+        if (op < 5) {
+            auto a = compact.get(key);
+            auto b = reference.get(key);
+            assert((a == nullptr) == (b == nullptr));
+            assert(a == nullptr || *a == *b);
+        } else if (op < 9) {
+            compact.put(key, i);
+            reference.put(key, i);
+        } else {
+            assert(compact.remove(key) == reference.remove(key));
+        }
+        assert(compact.size() == reference.size());
+    }
+    for (int key = 0; key < 200; key++) {
+        assert(compact.containsKey(key) == reference.containsKey(key));
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testConcurrentAccess() {
+    std::cout << "Test 4: Concurrent Access" << std::endl;
+    CompactLRUCache<int, int> cache(500);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 20000; i++) {
+                int key = (i * 13 + t) % 1000;
+                if (i % 3 == 0) {
+                    cache.put(key, key * 2);
+                } else if (i % 7 == 0) {
+                    cache.remove(key);
+                } else {
+                    auto value = cache.get(key);
+                    assert(value == nullptr || *value == key * 2);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(cache.size() <= 500);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Compact LRU Cache Tests...\n" << std::endl;
+
+    testPutGetEvict();
+    testRemoveAndClear();
+    testMatchesLRUCache();
+    testConcurrentAccess();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
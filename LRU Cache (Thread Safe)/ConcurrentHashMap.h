@@ -0,0 +1,344 @@
+#ifndef CONCURRENT_HASH_MAP_H
+#define CONCURRENT_HASH_MAP_H
+
+#include "EpochManager.h"
+#include "../Common/Hash.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * Concurrent hash map with lock-free reads and striped-lock writes.
+ *
+ * Buckets are singly linked chains of immutable nodes. Readers pin an
+ * epoch and walk a chain with atomic loads only, so a get() never waits for
+ * a writer. Writers lock one of kStripes mutexes, chosen by the low bits of
+ * the hash, and swing a single pointer to insert, replace (a new node with
+ * the new value) or unlink a node. Unlinked nodes are retired to an
+ * EpochManager and freed once no reader can still be on them.
+ *
+ * The table doubles when it passes a load factor of 1. Growing locks every
+ * stripe, copies the chains into a new table and publishes it with one
+ * pointer store; readers still walking the old table finish there.
+ *
+ * It is meant as the index behind a cache in place of a std::unordered_map
+ * under a global lock. It keeps no recency order and never evicts.
+ *
+ * Time Complexity:
+ * - get / read / containsKey: O(1) expected, lock-free
+ * - put / remove: O(1) expected, one stripe lock
+ * - size: O(kStripes)
+ *
+ * @tparam K The type of keys maintained by this map
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentHashMap {
+private:
+    static constexpr std::size_t kStripes = 64;         // power of two
+    static constexpr std::size_t kCollectEvery = 64;    // retires per stripe between collections
+
+    struct Node {
+        const K key;
+        const V value;
+        const std::size_t hash;
+        std::atomic<Node*> next;
+
+        Node(const K& k, const V& v, std::size_t h, Node* n) : key(k), value(v), hash(h), next(n) {}
+    };
+
+    struct Table {
+        std::size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+        explicit Table(std::size_t size) : mask(size - 1), buckets(new std::atomic<Node*>[size]) {
+            for (std::size_t i = 0; i < size; i++) {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct alignas(64) Stripe {
+        std::mutex lock;
+        std::size_t count = 0;    // entries whose hash maps to this stripe
+        std::size_t retires = 0;  // since the last collection
+    };
+
+    mutable EpochManager epochs_;
+    std::atomic<Table*> table_;
+    std::array<Stripe, kStripes> stripes_;
+    Hash hasher_;
+
+    std::size_t hashOf(const K& key) const {
+        // Mix, so weak hashes (e.g. identity for ints) use every bucket and stripe.
+        return static_cast<std::size_t>(fmix64(hasher_(key)));
+    }
+
+    Stripe& stripeFor(std::size_t hash) {
+        // The table has at least kStripes buckets, so every key in a bucket
+        // maps to the same stripe at every table size.
+        return stripes_[hash & (kStripes - 1)];
+    }
+
+    const Node* find(const K& key, std::size_t hash) const {
+        Table* table = table_.load(std::memory_order_seq_cst);
+        const Node* node = table->buckets[hash & table->mask].load(std::memory_order_seq_cst);
+        while (node != nullptr && !(node->hash == hash && node->key == key)) {
+            node = node->next.load(std::memory_order_seq_cst);
+        }
+        return node;
+    }
+
+    static void deleteTable(Table* table) {
+        for (std::size_t i = 0; i <= table->mask; i++) {
+            Node* node = table->buckets[i].load(std::memory_order_relaxed);
+            while (node != nullptr) {
+                Node* next = node->next.load(std::memory_order_relaxed);
+                delete node;
+                node = next;
+            }
+        }
+        delete table;
+    }
+
+    /**
+     * Doubles the table if it is still the one the caller saw as too full.
+     */
+    void grow(Table* seen) {
+        Table* old;
+        {
+            std::array<std::unique_lock<std::mutex>, kStripes> locks;
+            for (std::size_t i = 0; i < kStripes; i++) {
+                locks[i] = std::unique_lock<std::mutex>(stripes_[i].lock);
+            }
+            old = table_.load(std::memory_order_relaxed);
+            if (old != seen) {
+                return;
+            }
+            auto* table = new Table((old->mask + 1) * 2);
+            for (std::size_t i = 0; i <= old->mask; i++) {
+                for (Node* node = old->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+                     node = node->next.load(std::memory_order_relaxed)) {
+                    auto& head = table->buckets[node->hash & table->mask];
+                    head.store(new Node(node->key, node->value, node->hash,
+                                        head.load(std::memory_order_relaxed)),
+                               std::memory_order_relaxed);
+                }
+            }
+            table_.store(table, std::memory_order_seq_cst);
+        }
+        epochs_.retire([old]() { deleteTable(old); });
+        epochs_.collect();
+    }
+
+public:
+    /**
+     * Initializes an empty map.
+     *
+     * @param initial_buckets Buckets to start with, rounded up to a power of two (at least 64)
+     */
+    explicit ConcurrentHashMap(std::size_t initial_buckets = kStripes) {
+        std::size_t size = kStripes;
+        while (size < initial_buckets) {
+            size *= 2;
+        }
+        table_.store(new Table(size), std::memory_order_relaxed);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    /**
+     * Frees all entries. No other thread may use the map.
+     */
+    ~ConcurrentHashMap() {
+        deleteTable(table_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Retrieves a copy of the value associated with the given key.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to a copy of the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key) const {
+        std::size_t hash = hashOf(key);
+        auto guard = epochs_.pin();
+        const Node* node = find(key, hash);
+        return node == nullptr ? nullptr : std::make_shared<V>(node->value);
+    }
+
+    /**
+     * Calls fn with a reference to the value in place, without copying it.
+     * The reference is valid only during the call.
+     *
+     * @param key The key whose value is to be read
+     * @param fn Called as fn(const V&) if the key is present
+     * @return true if the key was present
+     */
+    template <typename F>
+    bool read(const K& key, F&& fn) const {
+        std::size_t hash = hashOf(key);
+        auto guard = epochs_.pin();
+        const Node* node = find(key, hash);
+        if (node == nullptr) {
+            return false;
+        }
+        fn(node->value);
+        return true;
+    }
+
+    /**
+     * Checks whether the given key is present.
+     *
+     * @param key The key to check
+     * @return true if the key is present, false otherwise
+     */
+    bool containsKey(const K& key) const {
+        std::size_t hash = hashOf(key);
+        auto guard = epochs_.pin();
+        return find(key, hash) != nullptr;
+    }
+
+    /**
+     * Inserts or replaces a key-value pair.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        std::size_t hash = hashOf(key);
+        Stripe& stripe = stripeFor(hash);
+        Table* table;
+        bool collect_due = false;
+        bool too_full = false;
+        {
+            std::lock_guard<std::mutex> guard(stripe.lock);
+            table = table_.load(std::memory_order_relaxed);  // stable while a stripe is held
+            std::atomic<Node*>* link = &table->buckets[hash & table->mask];
+            Node* node = link->load(std::memory_order_relaxed);
+            while (node != nullptr && !(node->hash == hash && node->key == key)) {
+                link = &node->next;
+                node = link->load(std::memory_order_relaxed);
+            }
+            if (node != nullptr) {
+                link->store(new Node(key, value, hash, node->next.load(std::memory_order_relaxed)),
+                            std::memory_order_seq_cst);
+                epochs_.retire(node);
+                collect_due = ++stripe.retires >= kCollectEvery;
+                if (collect_due) {
+                    stripe.retires = 0;
+                }
+            } else {
+                auto& head = table->buckets[hash & table->mask];
+                head.store(new Node(key, value, hash, head.load(std::memory_order_relaxed)),
+                           std::memory_order_seq_cst);
+                // Keys spread evenly over stripes, so one stripe's count
+                // estimates the total.
+                too_full = ++stripe.count * kStripes > table->mask + 1;
+            }
+        }
+        if (collect_due) {
+            epochs_.collect();
+        }
+        if (too_full) {
+            grow(table);
+        }
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        std::size_t hash = hashOf(key);
+        Stripe& stripe = stripeFor(hash);
+        bool collect_due;
+        {
+            std::lock_guard<std::mutex> guard(stripe.lock);
+            Table* table = table_.load(std::memory_order_relaxed);
+            std::atomic<Node*>* link = &table->buckets[hash & table->mask];
+            Node* node = link->load(std::memory_order_relaxed);
+            while (node != nullptr && !(node->hash == hash && node->key == key)) {
+                link = &node->next;
+                node = link->load(std::memory_order_relaxed);
+            }
+            if (node == nullptr) {
+                return false;
+            }
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+            epochs_.retire(node);
+            stripe.count--;
+            collect_due = ++stripe.retires >= kCollectEvery;
+            if (collect_due) {
+                stripe.retires = 0;
+            }
+        }
+        if (collect_due) {
+            epochs_.collect();
+        }
+        return true;
+    }
+
+    /**
+     * Removes all entries. Readers still on the old table finish there, and
+     * the old table is freed once they have.
+     */
+    void clear() {
+        Table* old;
+        {
+            std::array<std::unique_lock<std::mutex>, kStripes> locks;
+            for (std::size_t i = 0; i < kStripes; i++) {
+                locks[i] = std::unique_lock<std::mutex>(stripes_[i].lock);
+                stripes_[i].count = 0;
+            }
+            old = table_.load(std::memory_order_relaxed);
+            table_.store(new Table(kStripes), std::memory_order_seq_cst);
+        }
+        epochs_.retire([old]() { deleteTable(old); });
+        epochs_.collect();
+    }
+
+    /**
+     * Returns the number of entries. Stripes are read one at a time, so
+     * concurrent writes may or may not be counted.
+     *
+     * @return The current size
+     */
+    std::size_t size() {
+        std::size_t total = 0;
+        for (Stripe& stripe : stripes_) {
+            std::lock_guard<std::mutex> guard(stripe.lock);
+            total += stripe.count;
+        }
+        return total;
+    }
+
+    /**
+     * Checks whether the map is empty.
+     *
+     * @return true if the map contains no entries, false otherwise
+     */
+    bool isEmpty() {
+        return size() == 0;
+    }
+
+    /**
+     * Frees retired nodes and tables that no reader can still be using.
+     *
+     * @return The number of retired objects still waiting to be freed
+     */
+    std::size_t reclaim() {
+        epochs_.collect();
+        return epochs_.pending();
+    }
+};
+
+#endif // CONCURRENT_HASH_MAP_H
@@ -0,0 +1,126 @@
+#include "ConcurrentHashMap.h"
+#include "LRUCache.h"
+#include "ShardedLRUCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Throughput of LRUCache, ShardedLRUCache and ConcurrentHashMap as the
+ * thread count grows.
+ *
+ * Every thread runs a mix of get() and put() on uniformly random keys from
+ * a preloaded key space for a fixed time. The caches are sized to hold the
+ * whole key space, so the comparison is between a global lock, 16 locks
+ * and lock-free reads rather than between hit rates.
+ *
+ * Usage:
+ *   concurrent_hash_map_bench [--keys 100000] [--get-ratio 0.9] [--seconds 1]
+ *                             [--max-threads 32]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread ConcurrentHashMapBenchmark.cpp -o concurrent_hash_map_bench
+ */
+
+namespace {
+
+struct Options {
+    int keys = 100000;
+    double get_ratio = 0.9;
+    double seconds = 1;
+    int max_threads = 32;
+};
+
+struct Xorshift {
+    std::uint64_t state;
+
+    explicit Xorshift(std::uint64_t seed) : state(seed * 0x9e3779b97f4a7c15ULL + 1) {}
+
+    std::uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+template <typename Cache>
+double run(Cache& cache, int threads, const Options& opts) {
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> total{0};
+    std::uint64_t get_threshold = static_cast<std::uint64_t>(opts.get_ratio * 1000);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            Xorshift rng(t + 1);
+            std::uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; i++) {
+                    std::uint64_t r = rng.next();
+                    int key = static_cast<int>((r >> 16) % opts.keys);
+                    if (r % 1000 < get_threshold) {
+                        cache.get(key);
+                    } else {
+                        cache.put(key, key);
+                    }
+                }
+                ops += 256;
+            }
+            total.fetch_add(ops);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds));
+    stop = true;
+    for (auto& w : workers) {
+        w.join();
+    }
+    return static_cast<double>(total.load()) / opts.seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--keys") {
+            opts.keys = std::stoi(argv[i + 1]);
+        } else if (flag == "--get-ratio") {
+            opts.get_ratio = std::stod(argv[i + 1]);
+        } else if (flag == "--seconds") {
+            opts.seconds = std::stod(argv[i + 1]);
+        } else if (flag == "--max-threads") {
+            opts.max_threads = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    LRUCache<int, int> lru(opts.keys);
+    ShardedLRUCache<int, int> sharded(opts.keys, 16);
+    ConcurrentHashMap<int, int> map;
+    for (int k = 0; k < opts.keys; k++) {
+        lru.put(k, k);
+        sharded.put(k, k);
+        map.put(k, k);
+    }
+
+    std::cout << "Mops/s, " << opts.get_ratio * 100 << "% gets over " << opts.keys << " keys ("
+              << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "LRUCache" << std::setw(16)
+              << "Sharded(16)" << std::setw(20) << "ConcurrentHashMap" << std::endl;
+    for (int threads = 1; threads <= opts.max_threads; threads *= 2) {
+        double a = run(lru, threads, opts);
+        double b = run(sharded, threads, opts);
+        double c = run(map, threads, opts);
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(12)
+                  << a << std::setw(16) << b << std::setw(20) << c << std::endl;
+    }
+    return 0;
+}
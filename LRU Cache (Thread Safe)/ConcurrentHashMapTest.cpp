@@ -0,0 +1,177 @@
+#include "ConcurrentHashMap.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for ConcurrentHashMap.
+ *
+ * Tests cover:
+ * - Basic put, get, replace and remove
+ * - Growing the table while keeping every entry
+ * - Replaced and removed entries are freed
+ * - Tables replaced by growing or clearing are freed without reclaim()
+ * - Lock-free readers running against writers on other keys
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread ConcurrentHashMapTest.cpp -o concurrent_hash_map_test
+ */
+
+namespace {
+
+std::atomic<int> live_values{0};
+
+// Counts its live instances, to check that retired nodes are freed.
+struct Tracked {
+    int id = 0;
+    Tracked() { live_values++; }
+    explicit Tracked(int i) : id(i) { live_values++; }
+    Tracked(const Tracked& other) : id(other.id) { live_values++; }
+    ~Tracked() { live_values--; }
+};
+
+} // namespace
+
+void testBasicOperations() {
+    std::cout << "Test 1: Put, Get, Replace and Remove" << std::endl;
+    ConcurrentHashMap<std::string, int> map;
+    assert(map.isEmpty());
+    assert(map.get("a") == nullptr);
+
+    map.put("a", 1);
+    map.put("b", 2);
+    map.put("a", 10);
+    assert(*map.get("a") == 10);
+    assert(map.containsKey("b"));
+    assert(map.size() == 2);
+
+    int seen = 0;
+    assert(map.read("b", [&seen](const int& value) { seen = value; }));
+    assert(seen == 2);
+
+    assert(map.remove("a"));
+    assert(!map.remove("a"));
+    assert(map.get("a") == nullptr);
+    assert(map.size() == 1);
+
+    map.clear();
+    assert(map.isEmpty());
+    assert(!map.containsKey("b"));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testGrowth() {
+    std::cout << "Test 2: Growing the Table" << std::endl;
+    ConcurrentHashMap<int, int> map;
+    for (int i = 0; i < 100000; i++) {
+        map.put(i, i * 3);
+    }
+    assert(map.size() == 100000);
+    for (int i = 0; i < 100000; i++) {
+        auto value = map.get(i);
+        assert(value != nullptr && *value == i * 3);
+    }
+    for (int i = 0; i < 100000; i += 2) {
+        assert(map.remove(i));
+    }
+    assert(map.size() == 50000);
+    assert(!map.containsKey(500));
+    assert(map.containsKey(501));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRetiredNodesAreFreed() {
+    std::cout << "Test 3: Replaced and Removed Entries Are Freed" << std::endl;
+    {
+        ConcurrentHashMap<int, Tracked> map;
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 1000; i++) {
+                map.put(i, Tracked(round));
+            }
+        }
+        for (int i = 0; i < 500; i++) {
+            map.remove(i);
+        }
+        assert(map.reclaim() == 0);
+        assert(live_values == 500);
+        assert(map.get(999)->id == 9);
+    }
+    assert(live_values == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testConcurrentReadersAndWriters() {
+    std::cout << "Test 4: Lock-Free Readers Against Writers" << std::endl;
+    ConcurrentHashMap<int, int> map;
+    // Keys 0..999 are stable; writers churn keys 1000 and up, which also
+    // makes the table grow under the readers.
+    for (int i = 0; i < 1000; i++) {
+        map.put(i, i);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&map, &stop, t]() {
+            while (!stop) {
+                for (int i = t; i < 1000; i += 4) {
+                    int value = -1;
+                    assert(map.read(i, [&value](const int& v) { value = v; }));
+                    assert(value == i);
+                }
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&map, t]() {
+            for (int i = 0; i < 20000; i++) {
+                int key = 1000 + t * 100000 + i;
+                map.put(key, key);
+                if (i % 2 == 0) {
+                    map.remove(key);
+                }
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(map.size() == 1000 + 2 * 10000);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testOldTablesAreFreed() {
+    std::cout << "Test 5: Grown and Cleared Tables Are Freed" << std::endl;
+    ConcurrentHashMap<int, Tracked> map;
+    for (int round = 0; round < 50; round++) {
+        // Inserts only, so no replace or remove ever triggers a collection.
+        for (int i = 0; i < 1000; i++) {
+            map.put(i, Tracked(i));
+        }
+        assert(live_values == 1000);  // the copies in outgrown tables are gone
+        map.clear();
+        assert(live_values == 0);
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Concurrent Hash Map Tests...\n" << std::endl;
+
+    testBasicOperations();
+    testGrowth();
+    testRetiredNodesAreFreed();
+    testConcurrentReadersAndWriters();
+    testOldTablesAreFreed();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,203 @@
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include "../Common/ThreadSlot.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Epoch-based memory reclamation.
+ *
+ * Readers pin the current epoch while they dereference shared pointers;
+ * writers unpublish an object and retire() it instead of deleting it. A
+ * retired object is freed once every thread that might still see it has
+ * unpinned, which is known when the global epoch has moved two steps past
+ * the epoch it was retired in. The global epoch advances only when every
+ * pinned thread has observed the current one.
+ *
+ * Pinning writes only the calling thread's own record (one cache line per
+ * thread), so readers never write a shared cache line. Retiring and
+ * collecting take a mutex and are meant for the write path.
+ *
+ * Ordering contract: writers unpublish with a seq_cst store (or RMW) and
+ * readers load published pointers with seq_cst loads after pin(). The pin
+ * is a seq_cst store too, so a collector that does not see a pin is ordered
+ * before that reader's loads, and the reader finds the new pointer. On x86
+ * and ARMv8 seq_cst loads cost the same as acquire loads.
+ *
+ * Each thread that pins gets a record on first use; records stay with the
+ * manager until it is destroyed, so long-lived thread pools suit it best.
+ */
+class EpochManager {
+private:
+    static constexpr std::uint64_t kQuiescent = 0;
+
+    struct alignas(64) Record {
+        std::atomic<std::uint64_t> epoch{kQuiescent};  // pinned epoch, or kQuiescent
+        unsigned nesting = 0;                          // only touched by the owning thread
+    };
+
+    struct Retired {
+        std::uint64_t epoch;
+        std::function<void()> deleter;
+    };
+
+    ThreadSlot slot_;
+    std::atomic<std::uint64_t> global_{1};
+    mutable std::mutex lock_;  // guards records_ and retired_
+    std::vector<std::unique_ptr<Record>> records_;
+    std::vector<Retired> retired_;
+
+    Record& localRecord() {
+        if (void* record = slot_.get()) {
+            return *static_cast<Record*>(record);
+        }
+        return registerThread();
+    }
+
+    Record& registerThread() {
+        std::lock_guard<std::mutex> guard(lock_);
+        records_.push_back(std::make_unique<Record>());
+        slot_.set(records_.back().get());
+        return *records_.back();
+    }
+
+    /**
+     * Advances the global epoch if every pinned thread has seen it.
+     * Caller holds lock_.
+     */
+    void tryAdvance() {
+        std::uint64_t epoch = global_.load(std::memory_order_seq_cst);
+        for (const auto& record : records_) {
+            std::uint64_t pinned = record->epoch.load(std::memory_order_seq_cst);
+            if (pinned != kQuiescent && pinned != epoch) {
+                return;
+            }
+        }
+        global_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    }
+
+public:
+    /**
+     * Keeps the calling thread pinned for its lifetime. Guards nest.
+     */
+    class Guard {
+    private:
+        friend class EpochManager;
+        Record* record_;
+
+        explicit Guard(Record* record) : record_(record) {}
+
+    public:
+        Guard(Guard&& other) noexcept : record_(other.record_) {
+            other.record_ = nullptr;
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+
+        ~Guard() {
+            if (record_ != nullptr && --record_->nesting == 0) {
+                record_->epoch.store(kQuiescent, std::memory_order_release);
+            }
+        }
+    };
+
+    EpochManager() = default;
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    /**
+     * Frees everything still retired. No thread may be pinned.
+     */
+    ~EpochManager() {
+        for (Retired& r : retired_) {
+            r.deleter();
+        }
+    }
+
+    /**
+     * Pins the current epoch. Pointers loaded while the guard lives stay
+     * valid until it is destroyed.
+     *
+     * @return A guard that unpins on destruction
+     */
+    Guard pin() {
+        Record& record = localRecord();
+        if (record.nesting++ == 0) {
+            record.epoch.store(global_.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        }
+        return Guard(&record);
+    }
+
+    /**
+     * Schedules deleter to run once no reader can still hold the retired
+     * object. The object must already be unreachable for new readers.
+     *
+     * @param deleter Frees the object
+     */
+    void retire(std::function<void()> deleter) {
+        std::lock_guard<std::mutex> guard(lock_);
+        retired_.push_back(Retired{global_.load(std::memory_order_seq_cst), std::move(deleter)});
+    }
+
+    /**
+     * Retires an object allocated with new.
+     *
+     * @param object The unpublished object
+     */
+    template <typename T>
+    void retire(T* object) {
+        retire([object]() { delete object; });
+    }
+
+    /**
+     * Tries to advance the epoch and frees the retired objects that are now
+     * safe. Deleters run after the lock is released.
+     *
+     * @return The number of objects freed
+     */
+    std::size_t collect() {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            // Two steps, so a retire with no reader pinned is freed at once.
+            tryAdvance();
+            tryAdvance();
+            std::uint64_t epoch = global_.load(std::memory_order_seq_cst);
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < retired_.size(); i++) {
+                if (retired_[i].epoch + 2 <= epoch) {
+                    ready.push_back(std::move(retired_[i].deleter));
+                } else {
+                    retired_[kept++] = std::move(retired_[i]);
+                }
+            }
+            retired_.resize(kept);
+        }
+        for (auto& deleter : ready) {
+            deleter();
+        }
+        return ready.size();
+    }
+
+    /**
+     * Returns the number of retired objects not yet freed.
+     *
+     * @return The pending count
+     */
+    std::size_t pending() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return retired_.size();
+    }
+};
+
+#endif // EPOCH_MANAGER_H
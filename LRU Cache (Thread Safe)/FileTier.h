@@ -0,0 +1,588 @@
+#ifndef FILE_TIER_H
+#define FILE_TIER_H
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Settings for FileTier.
+ */
+struct FileTierConfig {
+    std::string directory;                       // created if missing; old segments are deleted
+    std::uint64_t segment_bytes = 64ull << 20;   // a segment is sealed once it reaches this size
+    std::uint64_t max_bytes = 1ull << 30;        // oldest segments are dropped above this
+    double compact_below = 0.25;                 // sealed segments with less live data are rewritten
+    std::uint64_t max_pending_bytes = 64ull << 20;  // queued writes above this are dropped
+};
+
+/**
+ * Log-structured key-value store on local disk, used as the second tier of
+ * TieredCache.
+ *
+ * Writes are queued by putAsync() and appended in batches by one background
+ * thread to the active segment file. An in-memory index maps each key to the
+ * segment and offset of its latest record, and reads are a single pread.
+ *
+ * Record layout (native endianness):
+ *   u32 key_len | u32 value_len | key bytes | value bytes
+ *
+ * Space is reclaimed a segment at a time by the writer thread:
+ * - a sealed segment whose live bytes fall below compact_below of its size
+ *   has its live records copied to the active segment and is deleted;
+ * - while the tier is larger than max_bytes, the oldest segment is deleted
+ *   and its keys dropped, so the tier as a whole behaves like a FIFO.
+ *
+ * The tier is a cache: it starts empty and does not recover across restarts.
+ */
+class FileTier {
+private:
+    static constexpr std::uint64_t kHeaderBytes = 8;
+
+    struct Segment {
+        std::uint64_t id;
+        std::string path;
+        int fd;
+        std::uint64_t size = 0;
+        std::uint64_t live_bytes = 0;
+
+        Segment(std::uint64_t id, std::string path, int fd) : id(id), path(std::move(path)), fd(fd) {}
+
+        ~Segment() {
+            ::close(fd);
+        }
+    };
+
+    struct Location {
+        std::uint64_t segment;
+        std::uint64_t offset;  // of the record header
+        std::uint32_t value_len;
+
+        std::uint64_t recordBytes(std::size_t key_len) const {
+            return kHeaderBytes + key_len + value_len;
+        }
+    };
+
+    struct Pending {
+        std::uint64_t seq;
+        std::string value;
+    };
+
+    struct QueuedWrite {
+        std::string key;
+        std::uint64_t seq;
+        std::uint32_t value_len;
+    };
+
+    struct Record {
+        std::string key;
+        std::uint64_t offset;
+        std::uint32_t value_len;
+        std::size_t value_pos;  // position of the value in the segment buffer
+    };
+
+    FileTierConfig config_;
+    mutable std::mutex lock_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<std::string, Location> index_;
+    std::unordered_map<std::string, Pending> pending_;
+    std::deque<std::pair<std::string, std::uint64_t>> queue_;
+    std::map<std::uint64_t, std::shared_ptr<Segment>> segments_;  // oldest first
+    std::shared_ptr<Segment> active_;
+    std::uint64_t next_segment_id_ = 0;
+    std::uint64_t next_seq_ = 0;
+    std::uint64_t pending_bytes_ = 0;
+    std::uint64_t total_bytes_ = 0;
+    std::uint64_t dropped_writes_ = 0;
+    bool writing_ = false;
+    bool stop_ = false;
+    std::thread writer_;
+
+    static void writeAll(int fd, const char* data, std::size_t len, std::uint64_t offset) {
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "pwrite");
+            }
+            data += n;
+            len -= static_cast<std::size_t>(n);
+            offset += static_cast<std::uint64_t>(n);
+        }
+    }
+
+    static bool readAll(int fd, char* data, std::size_t len, std::uint64_t offset) {
+        while (len > 0) {
+            ssize_t n = ::pread(fd, data, len, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            len -= static_cast<std::size_t>(n);
+            offset += static_cast<std::uint64_t>(n);
+        }
+        return true;
+    }
+
+    static void appendRecord(std::string& buffer, const std::string& key, const std::string& value) {
+        std::uint32_t header[2] = {static_cast<std::uint32_t>(key.size()),
+                                   static_cast<std::uint32_t>(value.size())};
+        buffer.append(reinterpret_cast<const char*>(header), sizeof(header));
+        buffer.append(key);
+        buffer.append(value);
+    }
+
+    std::shared_ptr<Segment> openSegment() {
+        std::uint64_t id = next_segment_id_++;
+        std::string path = config_.directory + "/segment-" + std::to_string(id) + ".log";
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        auto segment = std::make_shared<Segment>(id, path, fd);
+        segments_[id] = segment;
+        return segment;
+    }
+
+    /**
+     * Drops a record's bytes from the live count of its segment. Caller holds lock_.
+     */
+    void markDead(const std::string& key, const Location& loc) {
+        auto it = segments_.find(loc.segment);
+        if (it != segments_.end()) {
+            it->second->live_bytes -= loc.recordBytes(key.size());
+        }
+    }
+
+    /**
+     * Points key at a freshly written record. Caller holds lock_.
+     */
+    void indexRecord(const std::string& key, const Location& loc, Segment& segment) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            markDead(key, it->second);
+            it->second = loc;
+        } else {
+            index_.emplace(key, loc);
+        }
+        segment.live_bytes += loc.recordBytes(key.size());
+    }
+
+    static std::vector<Record> parseSegment(const std::string& buffer) {
+        std::vector<Record> records;
+        std::size_t pos = 0;
+        while (pos + kHeaderBytes <= buffer.size()) {
+            std::uint32_t header[2];
+            std::memcpy(header, buffer.data() + pos, sizeof(header));
+            std::size_t key_pos = pos + kHeaderBytes;
+            if (key_pos + header[0] + header[1] > buffer.size()) {
+                break;
+            }
+            records.push_back(Record{buffer.substr(key_pos, header[0]), pos, header[1],
+                                     key_pos + header[0]});
+            pos = key_pos + header[0] + header[1];
+        }
+        return records;
+    }
+
+    static std::string readSegment(const Segment& segment, std::uint64_t size) {
+        std::string buffer(size, '\0');
+        if (!readAll(segment.fd, buffer.data(), size, 0)) {
+            buffer.clear();
+        }
+        return buffer;
+    }
+
+    /**
+     * Deletes a sealed segment, copying its live records to the active
+     * segment first if keep_live is set. Runs on the writer thread.
+     */
+    void retireSegment(std::shared_ptr<Segment> segment, bool keep_live) {
+        std::uint64_t size;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            size = segment->size;
+        }
+        std::string buffer = readSegment(*segment, size);
+        std::vector<Record> records = parseSegment(buffer);
+
+        std::string out;
+        std::vector<const Record*> copied;
+        std::shared_ptr<Segment> target;
+        std::uint64_t base = 0;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            target = active_;
+            base = target->size;
+            for (const Record& r : records) {
+                auto it = index_.find(r.key);
+                if (it == index_.end() || it->second.segment != segment->id ||
+                    it->second.offset != r.offset) {
+                    continue;
+                }
+                if (keep_live) {
+                    appendRecord(out, r.key, buffer.substr(r.value_pos, r.value_len));
+                    copied.push_back(&r);
+                } else {
+                    index_.erase(it);
+                }
+            }
+            if (!out.empty()) {
+                // Reserve the range so concurrent reads never see a half-written tail.
+                target->size += out.size();
+                total_bytes_ += out.size();
+            }
+        }
+        if (!out.empty()) {
+            try {
+                writeAll(target->fd, out.data(), out.size(), base);
+            } catch (const std::system_error&) {
+                copied.clear();  // the live records are dropped with the segment
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(lock_);
+        std::uint64_t pos = base;
+        for (const Record* r : copied) {
+            Location loc{target->id, pos, r->value_len};
+            pos += loc.recordBytes(r->key.size());
+            auto it = index_.find(r->key);
+            // Skip keys removed or rewritten while the copy was in flight.
+            if (it != index_.end() && it->second.segment == segment->id &&
+                it->second.offset == r->offset) {
+                it->second = loc;
+                target->live_bytes += loc.recordBytes(r->key.size());
+            }
+        }
+        // Whatever still points here was not copied; an unreadable segment
+        // has to be found by scanning the index.
+        if (records.empty()) {
+            for (auto it = index_.begin(); it != index_.end();) {
+                it = it->second.segment == segment->id ? index_.erase(it) : std::next(it);
+            }
+        }
+        for (const Record& r : records) {
+            auto it = index_.find(r.key);
+            if (it != index_.end() && it->second.segment == segment->id) {
+                index_.erase(it);
+            }
+        }
+        segments_.erase(segment->id);
+        total_bytes_ -= segment->size;
+        ::unlink(segment->path.c_str());
+    }
+
+    void maintain() {
+        while (true) {
+            std::shared_ptr<Segment> victim;
+            bool keep_live = false;
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                if (active_->size >= config_.segment_bytes) {
+                    active_ = openSegment();
+                }
+                if (total_bytes_ > config_.max_bytes && segments_.begin()->second != active_) {
+                    victim = segments_.begin()->second;
+                } else {
+                    for (auto& [id, segment] : segments_) {
+                        if (segment != active_ && segment->live_bytes <
+                            static_cast<std::uint64_t>(config_.compact_below * segment->size)) {
+                            victim = segment;
+                            keep_live = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (!victim) {
+                return;
+            }
+            retireSegment(victim, keep_live);
+        }
+    }
+
+    void writerLoop() {
+        while (true) {
+            std::string buffer;
+            std::vector<QueuedWrite> written;
+            std::shared_ptr<Segment> segment;
+            std::uint64_t base = 0;
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                work_cv_.wait(guard, [this]() { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                writing_ = true;
+                while (!queue_.empty()) {
+                    auto& [key, seq] = queue_.front();
+                    auto it = pending_.find(key);
+                    if (it != pending_.end() && it->second.seq == seq) {
+                        appendRecord(buffer, key, it->second.value);
+                        written.push_back(QueuedWrite{std::move(key), seq,
+                            static_cast<std::uint32_t>(it->second.value.size())});
+                    }
+                    queue_.pop_front();
+                }
+                segment = active_;
+                base = segment->size;
+                segment->size += buffer.size();
+                total_bytes_ += buffer.size();
+            }
+
+            bool ok = true;
+            try {
+                writeAll(segment->fd, buffer.data(), buffer.size(), base);
+            } catch (const std::system_error&) {
+                ok = false;  // e.g. disk full: the batch is lost, as a cache may forget
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                std::uint64_t pos = base;
+                for (const QueuedWrite& w : written) {
+                    Location loc{segment->id, pos, w.value_len};
+                    pos += loc.recordBytes(w.key.size());
+                    // Only index the record if it is still the latest write for the key.
+                    auto it = pending_.find(w.key);
+                    if (it != pending_.end() && it->second.seq == w.seq) {
+                        pending_bytes_ -= w.key.size() + it->second.value.size();
+                        pending_.erase(it);
+                        if (ok) {
+                            indexRecord(w.key, loc, *segment);
+                        } else {
+                            dropped_writes_++;
+                        }
+                    }
+                }
+            }
+            try {
+                maintain();
+            } catch (const std::system_error&) {
+                // Reclamation is retried after the next batch.
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                writing_ = false;
+            }
+            idle_cv_.notify_all();
+        }
+    }
+
+public:
+    /**
+     * Opens the tier and starts its writer thread.
+     *
+     * @param config Directory, segment size, size limit and compaction threshold
+     * @throws std::invalid_argument if the directory is empty, a size is 0,
+     *         or max_bytes is smaller than two segments
+     * @throws std::system_error if the directory or first segment cannot be created
+     */
+    explicit FileTier(const FileTierConfig& config) : config_(config) {
+        if (config.directory.empty()) {
+            throw std::invalid_argument("Directory must not be empty");
+        }
+        if (config.segment_bytes == 0 || config.max_pending_bytes == 0) {
+            throw std::invalid_argument("Segment and pending sizes must be greater than 0");
+        }
+        if (config.max_bytes < 2 * config.segment_bytes) {
+            throw std::invalid_argument("Size limit must hold at least two segments");
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(config.directory, ec);
+        if (ec) {
+            throw std::system_error(ec, "create_directories " + config.directory);
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(config.directory)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("segment-", 0) == 0 && entry.path().extension() == ".log") {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+        active_ = openSegment();
+        writer_ = std::thread([this]() { writerLoop(); });
+    }
+
+    FileTier(const FileTier&) = delete;
+    FileTier& operator=(const FileTier&) = delete;
+
+    /**
+     * Writes out everything queued, stops the writer and closes the segments.
+     * Segment files are left on disk.
+     */
+    ~FileTier() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            stop_ = true;
+        }
+        work_cv_.notify_one();
+        writer_.join();
+    }
+
+    /**
+     * Queues a key-value pair to be appended. Until it is written, get()
+     * serves it from memory. If more than max_pending_bytes are queued the
+     * write is dropped, as a cache may forget entries.
+     *
+     * @param key The key
+     * @param value The value
+     * @return true if the write was queued, false if it was dropped
+     */
+    bool putAsync(const std::string& key, const std::string& value) {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            if (pending_bytes_ + key.size() + value.size() > config_.max_pending_bytes) {
+                dropped_writes_++;
+                return false;
+            }
+            std::uint64_t seq = next_seq_++;
+            auto it = pending_.find(key);
+            if (it != pending_.end()) {
+                pending_bytes_ -= it->second.value.size();
+                it->second = Pending{seq, value};
+                pending_bytes_ += value.size();
+            } else {
+                pending_.emplace(key, Pending{seq, value});
+                pending_bytes_ += key.size() + value.size();
+            }
+            queue_.emplace_back(key, seq);
+        }
+        work_cv_.notify_one();
+        return true;
+    }
+
+    /**
+     * Looks a key up: first among queued writes, then on disk.
+     *
+     * @param key The key
+     * @return The value, or nullptr if the tier does not hold the key
+     */
+    std::shared_ptr<std::string> get(const std::string& key) const {
+        std::shared_ptr<Segment> segment;
+        Location loc{};
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            auto p = pending_.find(key);
+            if (p != pending_.end()) {
+                return std::make_shared<std::string>(p->second.value);
+            }
+            auto it = index_.find(key);
+            if (it == index_.end()) {
+                return nullptr;
+            }
+            loc = it->second;
+            segment = segments_.at(loc.segment);
+        }
+        // The segment's fd stays open while we hold the shared_ptr, even if
+        // the writer retires the segment meanwhile.
+        auto value = std::make_shared<std::string>(loc.value_len, '\0');
+        if (!readAll(segment->fd, value->data(), loc.value_len,
+                     loc.offset + kHeaderBytes + key.size())) {
+            return nullptr;
+        }
+        return value;
+    }
+
+    /**
+     * Removes a key, including any queued write for it.
+     *
+     * @param key The key
+     * @return true if the tier held the key
+     */
+    bool remove(const std::string& key) {
+        std::lock_guard<std::mutex> guard(lock_);
+        bool found = false;
+        auto p = pending_.find(key);
+        if (p != pending_.end()) {
+            pending_bytes_ -= key.size() + p->second.value.size();
+            pending_.erase(p);
+            found = true;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            markDead(key, it->second);
+            index_.erase(it);
+            found = true;
+        }
+        return found;
+    }
+
+    /**
+     * Blocks until every write queued so far is on disk and indexed.
+     */
+    void flush() {
+        std::unique_lock<std::mutex> guard(lock_);
+        idle_cv_.wait(guard, [this]() { return queue_.empty() && !writing_; });
+    }
+
+    /**
+     * Returns the number of keys held on disk or queued.
+     *
+     * @return The key count
+     */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::size_t n = index_.size();
+        for (const auto& [key, pending] : pending_) {
+            if (index_.find(key) == index_.end()) {
+                n++;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Returns the bytes currently used by segment files.
+     *
+     * @return The on-disk size
+     */
+    std::uint64_t diskBytes() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return total_bytes_;
+    }
+
+    /**
+     * Returns the number of segment files.
+     *
+     * @return The segment count
+     */
+    std::size_t segmentCount() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return segments_.size();
+    }
+
+    /**
+     * Returns how many writes were dropped because the queue was full.
+     *
+     * @return The dropped write count
+     */
+    std::uint64_t droppedWrites() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return dropped_writes_;
+    }
+};
+
+#endif // FILE_TIER_H
@@ -0,0 +1,208 @@
+#ifndef HOT_KEY_TRACKER_H
+#define HOT_KEY_TRACKER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Settings for HotKeyTracker.
+ */
+struct HotKeyConfig {
+    std::size_t counters = 256;     // keys tracked; bounds memory and accuracy
+    unsigned sample_every = 16;     // offer 1 in N accesses to the tracker
+    std::uint64_t halve_every = 0;  // halve all counts after this many samples (0 = never)
+};
+
+/**
+ * A key reported by HotKeyTracker.
+ *
+ * @tparam K The key type
+ */
+template <typename K>
+struct HotKey {
+    K key;
+    std::uint64_t count;  // estimated accesses, scaled up by the sampling rate
+    std::uint64_t error;  // count may overestimate the true value by at most this much
+};
+
+/**
+ * Streaming top-K tracker using the Space-Saving algorithm.
+ *
+ * Keeps a fixed number of counters. A tracked key increments its counter;
+ * an untracked key takes over the smallest counter and inherits its count as
+ * the error bound. Every key accessed more than total / counters times is
+ * guaranteed to be tracked.
+ *
+ * To keep overhead off the caller's hot path, only one in sample_every calls
+ * to offer() is counted; the others cost a thread-local random number. With
+ * halve_every set, counts decay so the result follows recent traffic.
+ *
+ * Time Complexity:
+ * - offer: O(1) when not sampled, O(log counters) when sampled
+ * - top(k): O(counters log counters)
+ *
+ * Space Complexity: O(counters)
+ *
+ * @tparam K The key type
+ * @tparam Hash The hash functor for K
+ */
+template <typename K, typename Hash = std::hash<K>>
+class HotKeyTracker {
+private:
+    struct Counter {
+        K key;
+        std::uint64_t count;
+        std::uint64_t error;
+    };
+
+    HotKeyConfig config_;
+    mutable std::mutex lock_;
+    std::vector<Counter> heap_;  // min-heap on count
+    std::unordered_map<K, std::size_t, Hash> index_;  // key -> position in heap_
+    std::uint64_t samples_ = 0;
+
+    static bool sampled(unsigned every) {
+        thread_local std::uint64_t state = 0x9e3779b97f4a7c15ULL ^
+            reinterpret_cast<std::uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state % every == 0;
+    }
+
+    void swapAt(std::size_t a, std::size_t b) {
+        std::swap(heap_[a], heap_[b]);
+        index_[heap_[a].key] = a;
+        index_[heap_[b].key] = b;
+    }
+
+    void siftDown(std::size_t i) {
+        while (true) {
+            std::size_t smallest = i;
+            std::size_t l = 2 * i + 1;
+            std::size_t r = l + 1;
+            if (l < heap_.size() && heap_[l].count < heap_[smallest].count) {
+                smallest = l;
+            }
+            if (r < heap_.size() && heap_[r].count < heap_[smallest].count) {
+                smallest = r;
+            }
+            if (smallest == i) {
+                return;
+            }
+            swapAt(i, smallest);
+            i = smallest;
+        }
+    }
+
+    void siftUp(std::size_t i) {
+        while (i > 0) {
+            std::size_t parent = (i - 1) / 2;
+            if (heap_[parent].count <= heap_[i].count) {
+                return;
+            }
+            swapAt(i, parent);
+            i = parent;
+        }
+    }
+
+public:
+    /**
+     * Initializes a tracker.
+     *
+     * @param config Counter count, sampling rate and decay interval
+     * @throws std::invalid_argument if counters or sample_every is 0
+     */
+    explicit HotKeyTracker(const HotKeyConfig& config = HotKeyConfig()) : config_(config) {
+        if (config.counters == 0) {
+            throw std::invalid_argument("Counter count must be greater than 0");
+        }
+        if (config.sample_every == 0) {
+            throw std::invalid_argument("Sampling rate must be greater than 0");
+        }
+        heap_.reserve(config.counters);
+        index_.reserve(config.counters);
+    }
+
+    /**
+     * Reports one access to the key. Only a sample of calls is counted.
+     *
+     * @param key The accessed key
+     */
+    void offer(const K& key) {
+        if (config_.sample_every > 1 && !sampled(config_.sample_every)) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            heap_[it->second].count++;
+            siftDown(it->second);
+        } else if (heap_.size() < config_.counters) {
+            heap_.push_back(Counter{key, 1, 0});
+            index_[key] = heap_.size() - 1;
+            siftUp(heap_.size() - 1);
+        } else {
+            Counter& victim = heap_[0];
+            index_.erase(victim.key);
+            victim.error = victim.count;
+            victim.count++;
+            victim.key = key;
+            index_[key] = 0;
+            siftDown(0);
+        }
+
+        if (config_.halve_every != 0 && ++samples_ >= config_.halve_every) {
+            samples_ = 0;
+            // Halving preserves the heap order.
+            for (Counter& c : heap_) {
+                c.count /= 2;
+                c.error /= 2;
+            }
+        }
+    }
+
+    /**
+     * Returns the k most frequent keys, most frequent first.
+     *
+     * @param k The number of keys to return
+     * @return Up to k keys with estimated counts and error bounds
+     */
+    std::vector<HotKey<K>> top(std::size_t k) const {
+        std::vector<HotKey<K>> result;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            result.reserve(heap_.size());
+            for (const Counter& c : heap_) {
+                result.push_back(HotKey<K>{c.key, c.count * config_.sample_every,
+                                           c.error * config_.sample_every});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const HotKey<K>& a, const HotKey<K>& b) {
+            return a.count > b.count;
+        });
+        if (result.size() > k) {
+            result.resize(k);
+        }
+        return result;
+    }
+
+    /**
+     * Forgets all tracked keys.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> guard(lock_);
+        heap_.clear();
+        index_.clear();
+        samples_ = 0;
+    }
+};
+
+#endif // HOT_KEY_TRACKER_H
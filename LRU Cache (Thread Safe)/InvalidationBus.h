@@ -0,0 +1,470 @@
+#ifndef INVALIDATION_BUS_H
+#define INVALIDATION_BUS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * What an invalidation message drops.
+ */
+enum class InvalidationKind : std::uint8_t {
+    Key = 0,  // one key
+    Tag = 1,  // every entry carrying a tag
+    All = 2,  // everything; also delivered when a receiver falls too far behind
+};
+
+/**
+ * One message on an InvalidationBus.
+ */
+struct Invalidation {
+    InvalidationKind kind;
+    std::string name;  // key or tag; empty for All
+};
+
+/**
+ * Cross-process cache invalidation channel: a broadcast ring in a POSIX
+ * shared-memory segment.
+ *
+ * Any process (or thread) may publish; publishers are serialized by a
+ * robust, process-shared mutex. Every attached instance reads the ring with
+ * its own cursor and never writes to it, so receivers do not contend with
+ * each other or slow the publisher: a publish is a mutex, a slot write and
+ * one release store, whatever the number of receivers.
+ *
+ * Slots are seqlocks. A publisher marks the slot busy, writes the payload
+ * and stores the message's sequence number; a reader copies the payload and
+ * keeps it only if the sequence number is unchanged. The ring never waits
+ * for readers. A reader that falls more than a ring behind has missed
+ * messages, so it is handed one All invalidation instead and skips to the
+ * newest message (losing invalidations must never leave stale entries).
+ *
+ * drainInto() applies what arrived to a cache in batches: all key
+ * invalidations up to the next All are removed with one removeAll() call,
+ * i.e. one lock acquisition per (shard of the) cache.
+ *
+ * Time Complexity:
+ * - publish: O(name length)
+ * - poll: O(messages read)
+ *
+ * Keys and tags are byte strings of at most kMaxName bytes.
+ */
+class InvalidationBus {
+public:
+    static constexpr std::size_t kMaxName = 240;
+
+private:
+    static constexpr std::uint64_t kMagic = 0x31535542564e4900ULL;  // "\0INVBUS1"
+    static constexpr std::size_t kWords = kMaxName / 8;
+
+    struct Header {
+        std::atomic<std::uint64_t> magic;  // published last by the creator
+        std::uint64_t segment_bytes;
+        std::uint64_t slot_count;          // power of two
+        std::atomic<std::uint64_t> published;
+        pthread_mutex_t mutex;             // serializes publishers
+    };
+
+    // Payload fields are atomics so that a reader racing a publisher that
+    // laps it reads torn data (which the seqlock rejects) rather than
+    // committing a data race.
+    struct Slot {
+        std::atomic<std::uint64_t> seq;   // message number + 1; 0 while being written
+        std::atomic<std::uint64_t> meta;  // kind << 32 | length
+        std::atomic<std::uint64_t> words[kWords];
+    };
+
+    std::string name_;
+    int fd_ = -1;
+    char* base_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    Header* header_ = nullptr;
+    Slot* slots_ = nullptr;
+    std::uint64_t mask_ = 0;
+    std::uint64_t cursor_ = 0;
+    std::uint64_t overruns_ = 0;
+
+    static std::size_t headerBytes() {
+        return (sizeof(Header) + 63) & ~std::size_t{63};
+    }
+
+    void map(std::size_t bytes) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        base_ = static_cast<char*>(p);
+        mapped_bytes_ = bytes;
+        header_ = reinterpret_cast<Header*>(base_);
+    }
+
+    void unmap() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_bytes_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void initialize(std::size_t segment_bytes, std::size_t slot_count) {
+        Header* h = header_;
+        h->segment_bytes = segment_bytes;
+        h->slot_count = slot_count;
+        h->published.store(0, std::memory_order_relaxed);
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int rc = pthread_mutex_init(&h->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), "pthread_mutex_init");
+        }
+        // ftruncate zero-fills, so every slot starts with seq 0.
+    }
+
+    void attachSlots() {
+        slots_ = reinterpret_cast<Slot*>(base_ + headerBytes());
+        mask_ = header_->slot_count - 1;
+    }
+
+    /**
+     * Holds the publisher mutex. A publisher that died mid-write never
+     * advanced `published`, so its half-written slot is simply rewritten.
+     */
+    class PublishLock {
+    public:
+        explicit PublishLock(Header* header) : header_(header) {
+            int rc = pthread_mutex_lock(&header_->mutex);
+            if (rc == EOWNERDEAD) {
+                pthread_mutex_consistent(&header_->mutex);
+            } else if (rc != 0) {
+                throw std::system_error(rc, std::generic_category(), "pthread_mutex_lock");
+            }
+        }
+
+        ~PublishLock() {
+            pthread_mutex_unlock(&header_->mutex);
+        }
+
+        PublishLock(const PublishLock&) = delete;
+        PublishLock& operator=(const PublishLock&) = delete;
+
+    private:
+        Header* header_;
+    };
+
+    static void checkName(const std::string& name) {
+        if (name.size() > kMaxName) {
+            throw std::invalid_argument("Invalidation key or tag is longer than " +
+                                        std::to_string(kMaxName) + " bytes");
+        }
+    }
+
+    /**
+     * Writes one message at the next position. Caller holds the publisher
+     * mutex.
+     */
+    void writeSlot(InvalidationKind kind, const std::string& name) {
+        std::uint64_t position = header_->published.load(std::memory_order_relaxed);
+        Slot& slot = slots_[position & mask_];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.meta.store(static_cast<std::uint64_t>(kind) << 32 | name.size(), std::memory_order_relaxed);
+        for (std::size_t w = 0; w * 8 < name.size(); w++) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, name.data() + w * 8, std::min<std::size_t>(8, name.size() - w * 8));
+            slot.words[w].store(word, std::memory_order_relaxed);
+        }
+        slot.seq.store(position + 1, std::memory_order_release);
+        header_->published.store(position + 1, std::memory_order_release);
+    }
+
+    void overrun(std::vector<Invalidation>& batch) {
+        overruns_++;
+        batch.push_back(Invalidation{InvalidationKind::All, std::string()});
+        cursor_ = header_->published.load(std::memory_order_acquire);
+    }
+
+public:
+    /**
+     * Creates the named bus, or attaches to it if another process already
+     * created it (slot_count is then ignored). A new instance receives only
+     * messages published after it attached.
+     *
+     * @param name The shm_open name, e.g. "/app-invalidations"
+     * @param slot_count Ring size in messages (256 bytes each); a power of two
+     * @throws std::invalid_argument if the name does not start with '/' or
+     *         slot_count is not a power of two
+     * @throws std::system_error if the segment cannot be opened or mapped
+     * @throws std::runtime_error if an existing segment is not initialized in time
+     */
+    explicit InvalidationBus(const std::string& name, std::size_t slot_count = 1 << 16)
+        : name_(name) {
+        if (name.size() < 2 || name[0] != '/') {
+            throw std::invalid_argument("Segment name must start with '/'");
+        }
+        if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0) {
+            throw std::invalid_argument("Slot count must be a power of two");
+        }
+
+        fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd_ >= 0) {
+            std::size_t segment_bytes = headerBytes() + slot_count * sizeof(Slot);
+            try {
+                if (::ftruncate(fd_, static_cast<off_t>(segment_bytes)) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "ftruncate");
+                }
+                map(segment_bytes);
+                initialize(segment_bytes, slot_count);
+                header_->magic.store(kMagic, std::memory_order_release);
+            } catch (...) {
+                unmap();
+                ::shm_unlink(name.c_str());
+                throw;
+            }
+            attachSlots();
+            return;
+        }
+        if (errno != EEXIST) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+
+        fd_ = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        try {
+            // The creator sizes the segment and then publishes the magic.
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            struct stat st {};
+            while (true) {
+                if (::fstat(fd_, &st) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "fstat");
+                }
+                if (static_cast<std::size_t>(st.st_size) >= sizeof(Header)) {
+                    if (base_ == nullptr) {
+                        map(static_cast<std::size_t>(st.st_size));
+                    }
+                    if (header_->magic.load(std::memory_order_acquire) == kMagic) {
+                        break;
+                    }
+                }
+                if (std::chrono::steady_clock::now() > deadline) {
+                    throw std::runtime_error("Invalidation bus " + name + " was never initialized");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } catch (...) {
+            unmap();
+            throw;
+        }
+        attachSlots();
+        cursor_ = header_->published.load(std::memory_order_acquire);
+    }
+
+    InvalidationBus(const InvalidationBus&) = delete;
+    InvalidationBus& operator=(const InvalidationBus&) = delete;
+
+    /**
+     * Unmaps the segment. The segment itself persists until unlink().
+     */
+    ~InvalidationBus() {
+        unmap();
+    }
+
+    /**
+     * Removes the segment name. Processes that have it mapped keep working;
+     * the memory is released when the last one detaches.
+     *
+     * @param name The shm_open name passed to the constructor
+     * @return true if the name existed
+     */
+    static bool unlink(const std::string& name) {
+        return ::shm_unlink(name.c_str()) == 0;
+    }
+
+    /**
+     * Publishes one invalidation to every attached instance, this one
+     * included. Safe to call from any thread.
+     *
+     * @param kind What to invalidate
+     * @param name The key or tag; ignored for All
+     * @throws std::invalid_argument if name is longer than kMaxName
+     */
+    void publish(InvalidationKind kind, const std::string& name) {
+        publish({Invalidation{kind, name}});
+    }
+
+    /**
+     * Publishes a key invalidation.
+     *
+     * @param key The key
+     * @throws std::invalid_argument if key is longer than kMaxName
+     */
+    void publishKey(const std::string& key) {
+        publish(InvalidationKind::Key, key);
+    }
+
+    /**
+     * Publishes a tag invalidation.
+     *
+     * @param tag The tag
+     * @throws std::invalid_argument if tag is longer than kMaxName
+     */
+    void publishTag(const std::string& tag) {
+        publish(InvalidationKind::Tag, tag);
+    }
+
+    /**
+     * Publishes an invalidation of everything.
+     */
+    void publishAll() {
+        publish(InvalidationKind::All, std::string());
+    }
+
+    /**
+     * Publishes several invalidations under one acquisition of the publisher
+     * mutex. Safe to call from any thread.
+     *
+     * @param messages The invalidations, delivered in order
+     * @throws std::invalid_argument if a name is longer than kMaxName; nothing
+     *         is published then
+     */
+    void publish(const std::vector<Invalidation>& messages) {
+        for (const Invalidation& message : messages) {
+            checkName(message.name);
+        }
+        PublishLock guard(header_);
+        for (const Invalidation& message : messages) {
+            writeSlot(message.kind,
+                      message.kind == InvalidationKind::All ? std::string() : message.name);
+        }
+    }
+
+    /**
+     * Reads the messages published since the last poll, up to max_messages.
+     * If this instance fell more than a ring behind, the missed messages are
+     * replaced by a single All. Uses this instance's cursor: poll from one
+     * thread per instance.
+     *
+     * @param batch Receives the messages (appended)
+     * @param max_messages Upper bound on messages read by this call
+     * @return The number of messages appended
+     */
+    std::size_t poll(std::vector<Invalidation>& batch, std::size_t max_messages = 4096) {
+        std::size_t start = batch.size();
+        std::uint64_t head = header_->published.load(std::memory_order_acquire);
+        if (head - cursor_ > header_->slot_count) {
+            overrun(batch);
+            return batch.size() - start;
+        }
+        std::uint64_t words[kWords];
+        while (cursor_ < head && batch.size() - start < max_messages) {
+            const Slot& slot = slots_[cursor_ & mask_];
+            std::uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq != cursor_ + 1) {
+                overrun(batch);
+                break;
+            }
+            std::uint64_t meta = slot.meta.load(std::memory_order_relaxed);
+            std::size_t length = std::min<std::size_t>(meta & 0xffffffffu, kMaxName);
+            for (std::size_t w = 0; w * 8 < length; w++) {
+                words[w] = slot.words[w].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) {
+                overrun(batch);
+                break;
+            }
+            batch.push_back(Invalidation{static_cast<InvalidationKind>(meta >> 32),
+                                         std::string(reinterpret_cast<const char*>(words), length)});
+            cursor_++;
+        }
+        return batch.size() - start;
+    }
+
+    /**
+     * Applies pending invalidations to a cache keyed by std::string, such
+     * as LRUCache or ShardedLRUCache. Consecutive key invalidations are
+     * removed with one removeAll() call; All clears the cache.
+     *
+     * @param cache The cache to invalidate
+     * @param on_tag Called with each tag invalidation; if empty, the cache's
+     *        invalidateTag() is called instead
+     * @param max_messages Upper bound on messages applied by this call
+     * @return The number of messages applied
+     */
+    template <typename Cache>
+    std::size_t drainInto(Cache& cache, const std::function<void(const std::string&)>& on_tag = nullptr,
+                          std::size_t max_messages = 4096) {
+        std::vector<Invalidation> batch;
+        std::size_t count = poll(batch, max_messages);
+        std::vector<std::string> keys;
+        auto flush = [&]() {
+            if (!keys.empty()) {
+                cache.removeAll(keys);
+                keys.clear();
+            }
+        };
+        for (Invalidation& message : batch) {
+            switch (message.kind) {
+            case InvalidationKind::Key:
+                keys.push_back(std::move(message.name));
+                break;
+            case InvalidationKind::Tag:
+                flush();
+                if (on_tag) {
+                    on_tag(message.name);
+                } else {
+                    cache.invalidateTag(message.name);
+                }
+                break;
+            case InvalidationKind::All:
+                keys.clear();
+                cache.clear();
+                break;
+            }
+        }
+        flush();
+        return count;
+    }
+
+    /**
+     * Returns the number of messages ever published on this bus.
+     *
+     * @return The published message count
+     */
+    std::uint64_t publishedCount() const {
+        return header_->published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns how many times this instance fell behind and was handed an All.
+     *
+     * @return The overrun count
+     */
+    std::uint64_t overruns() const {
+        return overruns_;
+    }
+};
+
+#endif // INVALIDATION_BUS_H
@@ -0,0 +1,235 @@
+#include "InvalidationBus.h"
+#include "LRUCache.h"
+#include "ShardedLRUCache.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Test cases for InvalidationBus.
+ *
+ * Tests cover:
+ * - Publishing and polling keys, tags and All
+ * - Applying invalidations to caches in batches
+ * - Receivers that fall a ring behind, under concurrent publishing
+ * - Publishing from another process
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread InvalidationBusTest.cpp -o invalidation_bus_test
+ */
+
+namespace {
+
+std::string busName(const char* test) {
+    return std::string("/invalidation-bus-test-") + test + "-" + std::to_string(::getpid());
+}
+
+} // namespace
+
+void testPublishAndPoll() {
+    std::cout << "Test 1: Publishing and Polling Keys, Tags and All" << std::endl;
+    std::string name = busName("basic");
+    InvalidationBus publisher(name, 64);
+    publisher.publishKey("early");
+
+    // A receiver sees only what is published after it attached.
+    InvalidationBus receiver(name);
+    publisher.publishKey("user:42");
+    publisher.publishTag("table:orders");
+    publisher.publishAll();
+    publisher.publish({{InvalidationKind::Key, std::string(InvalidationBus::kMaxName, 'k')},
+                       {InvalidationKind::Key, std::string("a\0b", 3)}});
+
+    std::vector<Invalidation> batch;
+    assert(receiver.poll(batch) == 5);
+    assert(batch[0].kind == InvalidationKind::Key && batch[0].name == "user:42");
+    assert(batch[1].kind == InvalidationKind::Tag && batch[1].name == "table:orders");
+    assert(batch[2].kind == InvalidationKind::All && batch[2].name.empty());
+    assert(batch[3].name == std::string(InvalidationBus::kMaxName, 'k'));
+    assert(batch[4].name == std::string("a\0b", 3));
+    assert(receiver.poll(batch) == 0);
+
+    // The publisher's own instance receives everything since it was created.
+    batch.clear();
+    assert(publisher.poll(batch, 2) == 2);
+    assert(batch[0].name == "early" && batch[1].name == "user:42");
+    assert(publisher.publishedCount() == 6);
+
+    bool threw = false;
+    try {
+        publisher.publishKey(std::string(InvalidationBus::kMaxName + 1, 'k'));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(publisher.publishedCount() == 6);
+    InvalidationBus::unlink(name);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testDrainIntoCache() {
+    std::cout << "Test 2: Applying Invalidations to Caches in Batches" << std::endl;
+    std::string name = busName("drain");
+    InvalidationBus publisher(name, 1024);
+    InvalidationBus receiver(name);
+    ShardedLRUCache<std::string, int> sharded(1000, 8);
+    LRUCache<std::string, int> single(1000);
+    for (int i = 0; i < 100; i++) {
+        sharded.put("k" + std::to_string(i), i);
+        single.put("k" + std::to_string(i), i);
+    }
+
+    std::vector<Invalidation> messages;
+    for (int i = 0; i < 100; i += 2) {
+        messages.push_back({InvalidationKind::Key, "k" + std::to_string(i)});
+    }
+    messages.push_back({InvalidationKind::Tag, "user:7"});
+    publisher.publish(messages);
+
+    std::vector<std::string> tags;
+    assert(receiver.drainInto(sharded, [&tags](const std::string& tag) { tags.push_back(tag); }) == 51);
+    assert(sharded.size() == 50);
+    assert(!sharded.containsKey("k0") && sharded.containsKey("k1"));
+    assert(tags.size() == 1 && tags[0] == "user:7");
+
+    // Without a handler, tags go to the cache's invalidateTag().
+    sharded.put("order:1", 1, {"user:7"});
+    sharded.put("order:2", 2, {"user:8"});
+    publisher.publishTag("user:7");
+    assert(receiver.drainInto(sharded) == 1);
+    assert(!sharded.containsKey("order:1") && sharded.containsKey("order:2"));
+
+    // removeAll directly: one lock acquisition, absent keys skipped.
+    assert(single.removeAll({"k1", "k3", "missing"}) == 2);
+    assert(single.size() == 98 && !single.containsKey("k1"));
+
+    publisher.publishAll();
+    publisher.publishKey("k99");
+    single.put("k99", 99);
+    InvalidationBus second(name, 1024);
+    publisher.publishAll();
+    assert(second.drainInto(single) == 1);
+    assert(single.isEmpty());
+    InvalidationBus::unlink(name);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testOverrun() {
+    std::cout << "Test 3: Falling a Ring Behind Under Concurrent Publishing" << std::endl;
+    std::string name = busName("overrun");
+    InvalidationBus publisher(name, 8);
+    InvalidationBus receiver(name);
+
+    for (int i = 0; i < 20; i++) {
+        publisher.publishKey("k" + std::to_string(i));
+    }
+    std::vector<Invalidation> batch;
+    assert(receiver.poll(batch) == 1);
+    assert(batch[0].kind == InvalidationKind::All);
+    assert(receiver.overruns() == 1);
+    publisher.publishKey("after");
+    batch.clear();
+    assert(receiver.poll(batch) == 1 && batch[0].name == "after");
+
+    InvalidationBus::unlink(name);
+
+    // Two publisher threads race a reader that keeps up only part of the
+    // time: every message it keeps must be intact.
+    std::string lap_name = busName("lap");
+    InvalidationBus lap_receiver(lap_name, 256);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < 2; t++) {
+        publishers.emplace_back([&lap_name, t]() {
+            InvalidationBus bus(lap_name);
+            for (int i = 0; i < 20000; i++) {
+                bus.publishKey("t" + std::to_string(t) + ":" + std::to_string(i) +
+                               std::string(i % 100, 'x'));
+                if (i % 32 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::thread reader([&]() {
+        std::vector<Invalidation> received;
+        std::size_t kept = 0;
+        while (!done.load()) {
+            received.clear();
+            lap_receiver.poll(received, 64);
+            for (const Invalidation& message : received) {
+                if (message.kind == InvalidationKind::Key) {
+                    // "t<thread>:<i>" followed by i % 100 x's
+                    std::size_t colon = message.name.find(':');
+                    int i = std::stoi(message.name.substr(colon + 1));
+                    std::size_t prefix = std::min(message.name.find('x'), message.name.size());
+                    assert(message.name.size() - prefix == static_cast<std::size_t>(i % 100));
+                    kept++;
+                }
+            }
+        }
+        std::cout << "  kept " << kept << " messages, " << lap_receiver.overruns() << " overruns" << std::endl;
+    });
+    for (auto& t : publishers) {
+        t.join();
+    }
+    done.store(true);
+    reader.join();
+    assert(lap_receiver.publishedCount() == 40000);
+    InvalidationBus::unlink(lap_name);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testCrossProcess() {
+    std::cout << "Test 4: Publishing From Another Process" << std::endl;
+    std::string name = busName("fork");
+    InvalidationBus receiver(name, 1 << 14);
+    ShardedLRUCache<std::string, int> cache(20000, 16);
+    for (int i = 0; i < 10000; i++) {
+        cache.put("key" + std::to_string(i), i);
+    }
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        InvalidationBus child(name);
+        std::vector<Invalidation> messages;
+        for (int i = 0; i < 10000; i += 2) {
+            messages.push_back({InvalidationKind::Key, "key" + std::to_string(i)});
+            if (messages.size() == 100) {
+                child.publish(messages);
+                messages.clear();
+            }
+        }
+        ::_exit(0);
+    }
+    std::size_t applied = 0;
+    while (applied < 5000) {
+        applied += receiver.drainInto(cache);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(receiver.overruns() == 0);
+    assert(cache.size() == 5000);
+    assert(!cache.containsKey("key0") && cache.containsKey("key1"));
+    InvalidationBus::unlink(name);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Invalidation Bus Tests...\n" << std::endl;
+
+    testPublishAndPoll();
+    testDrainIntoCache();
+    testOverrun();
+    testCrossProcess();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
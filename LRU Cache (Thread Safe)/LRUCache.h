@@ -1,12 +1,35 @@
 #ifndef LRU_CACHE_H
 #define LRU_CACHE_H
 
+#include "HotKeyTracker.h"
+#include "MissRatioSampler.h"
 #include <unordered_map>
 #include <list>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <utility>
 #include <shared_mutex>
+#include <mutex>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <sstream>
+#include <string>
+#include <unordered_set>
+
+/**
+ * A value together with the version it was read at, from
+ * LRUCache::getVersioned().
+ */
+template <typename V>
+struct VersionedValue {
+    std::shared_ptr<V> value;   // nullptr if the key is absent
+    std::uint64_t version = 0;  // 0 if the key is absent
+};
 
 /**
  * Thread-safe LRU (Least Recently Used) Cache implementation.
@@ -18,36 +41,226 @@
  * - get(const K& key): O(1)
  * - put(const K& key, const V& value): O(1)
  * - remove(const K& key): O(1)
+ * - compute / computeIfPresent / merge / compareAndSet: O(1), one write
+ *   lock and one map probe
+ *
+ * Each entry stores the full hash of its key. The map hashes keys through
+ * that stored value, so rehashing and eviction never call Hash again, and
+ * callers that already hashed a key (e.g. to pick a shard) can pass the
+ * hash to the get/put/remove/containsKey overloads.
+ *
+ * Entries may carry string tags. A tag index maps each tag to its entries,
+ * so invalidateTag() drops them all in one pass under one lock. For very
+ * large tags, invalidateTagLazily() only bumps the tag's generation: each
+ * entry remembers the generations of its tags when it was written, and
+ * lookups treat an entry whose tag has moved on as absent (and remove it).
+ * Untagged entries pay one empty-vector check per lookup.
  *
  * Space Complexity: O(capacity)
  *
  * @tparam K The type of keys maintained by this cache
  * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
  */
-template <typename K, typename V>
+template <typename K, typename V, typename Hash = std::hash<K>>
 class LRUCache {
 private:
+    struct Node;
+
+    // Index entry for one tag. Lives while any entry carries the tag.
+    struct TagEntry {
+        std::string name;
+        std::uint64_t generation = 0;       // bumped by invalidateTagLazily()
+        std::unordered_set<Node*> members;
+    };
+
+    struct TagLink {
+        TagEntry* tag;
+        std::uint64_t generation;  // the tag's generation when the entry was written
+    };
+
     struct Node {
         K key;
         V value;
         std::shared_ptr<Node> prev;
         std::shared_ptr<Node> next;
+        std::size_t hash = 0;          // Hash{}(key)
+        std::uint64_t seq = 0;         // insertion order, to skip entries added during an iteration
+        std::uint64_t version = 0;     // bumped on every write, for compareAndSet()
+        std::uint64_t visit_mark = 0;  // id of the last iteration that visited this node
+        std::vector<TagLink> tags;
 
         Node() : key(), value() {}
-        Node(const K& k, const V& v) : key(k), value(v) {}
+        Node(const K& k, const V& v, std::size_t h) : key(k), value(v), hash(h) {}
+        Node(const K& k, V&& v, std::size_t h) : key(k), value(std::move(v)), hash(h) {}
+    };
+
+    // Map key: the node's own key (or the caller's, for lookups) with its hash.
+    struct KeyRef {
+        // Mutable so that a one-probe insert can repoint a map key from the
+        // caller's key to the new node's copy; both compare equal.
+        mutable const K* key;
+        std::size_t hash;
+    };
+
+    struct KeyRefHash {
+        std::size_t operator()(const KeyRef& ref) const noexcept {
+            return ref.hash;
+        }
     };
 
-    int capacity_;
-    std::unordered_map<K, std::shared_ptr<Node>> map_;
+    struct KeyRefEqual {
+        bool operator()(const KeyRef& a, const KeyRef& b) const {
+            return a.hash == b.hash && *a.key == *b.key;
+        }
+    };
+
+    using Map = std::unordered_map<KeyRef, std::shared_ptr<Node>, KeyRefHash, KeyRefEqual>;
+    using TagMap = std::unordered_map<std::string, std::unique_ptr<TagEntry>>;
+
+    static constexpr int kEvictionBatch = 64;  // excess entries evicted per operation after a shrink
+
+    std::atomic<int> capacity_;
+    Map map_;
+    TagMap tags_;
     std::shared_ptr<Node> head_;  // sentinel node for beginning of list
     std::shared_ptr<Node> tail_;  // sentinel node for end of list
     mutable std::shared_mutex lock_;
+    std::unique_ptr<HotKeyTracker<K>> hot_keys_owner_;
+    std::atomic<HotKeyTracker<K>*> hot_keys_{nullptr};  // set once, read without lock_
+    std::unique_ptr<MissRatioSampler> miss_ratio_owner_;
+    std::atomic<MissRatioSampler*> miss_ratio_{nullptr};  // set once, read without lock_
+    std::function<void(const K&, const V&)> eviction_listener_;
+    std::uint64_t next_seq_ = 1;
+    std::uint64_t next_version_ = 1;               // 0 means absent
+    std::uint64_t generation_ = 0;                 // bumped by clear()
+    mutable std::mutex iteration_lock_;            // one chunked iteration at a time
+    mutable std::shared_ptr<Node> cursor_;         // iteration marker node, if any
+    mutable std::uint64_t iteration_mark_ = 0;
+    Hash hasher_;
+
+    void recordAccess(const K& key) {
+        HotKeyTracker<K>* tracker = hot_keys_.load(std::memory_order_acquire);
+        if (tracker != nullptr) {
+            tracker->offer(key);
+        }
+    }
+
+    void recordLookup(std::size_t hash) {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler != nullptr) {
+            sampler->offer(hash);
+        }
+    }
 
-    void removeNode(std::shared_ptr<Node> node) {
+    static void removeNode(const std::shared_ptr<Node>& node) {
         node->prev->next = node->next;
         node->next->prev = node->prev;
     }
 
+    /**
+     * Checks whether any of the entry's tags was lazily invalidated after
+     * the entry was written.
+     */
+    static bool isStale(const Node& node) {
+        for (const TagLink& link : node.tags) {
+            if (link.tag->generation != link.generation) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Adds the entry to each tag's index entry. Caller holds the write lock.
+     */
+    void attachTags(Node* node, const std::vector<std::string>& tags) {
+        for (const std::string& name : tags) {
+            auto& entry = tags_[name];
+            if (!entry) {
+                entry = std::make_unique<TagEntry>();
+                entry->name = name;
+            }
+            if (entry->members.insert(node).second) {
+                node->tags.push_back(TagLink{entry.get(), entry->generation});
+            }
+        }
+    }
+
+    /**
+     * Removes the entry from the tag index, dropping tags left with no
+     * entries. Caller holds the write lock.
+     */
+    void detachTags(Node* node) {
+        for (const TagLink& link : node->tags) {
+            link.tag->members.erase(node);
+            if (link.tag->members.empty()) {
+                tags_.erase(link.tag->name);
+            }
+        }
+        node->tags.clear();
+    }
+
+    /**
+     * Drops the links of every node from first to the end of its chain, one
+     * node at a time. Nodes point at each other through shared_ptr, so a
+     * detached list would otherwise never be freed, and letting the chain
+     * unwind through the destructors would recurse once per node.
+     */
+    static void releaseChain(std::shared_ptr<Node> node) {
+        while (node) {
+            auto next = std::move(node->next);
+            node->prev.reset();
+            node = std::move(next);
+        }
+    }
+
+    // position is taken by value: callers may pass a link (e.g. head_->next)
+    // that this function rewrites.
+    static void insertBefore(std::shared_ptr<Node> position, const std::shared_ptr<Node>& node) {
+        node->prev = position->prev;
+        node->next = position;
+        position->prev->next = node;
+        position->prev = node;
+    }
+
+    /**
+     * Returns the least recently used entry, stepping over an iteration
+     * cursor. Only valid when the cache is not empty.
+     */
+    std::shared_ptr<Node> lruNode() const {
+        auto node = head_->next;
+        return node == cursor_ ? node->next : node;
+    }
+
+    /**
+     * Evicts the least recently used entry. Caller holds the write lock and
+     * the cache is not empty.
+     */
+    void evictLru() {
+        auto lru_node = lruNode();
+        removeNode(lru_node);
+        map_.erase(KeyRef{&lru_node->key, lru_node->hash});
+        detachTags(lru_node.get());
+        if (eviction_listener_) {
+            eviction_listener_(lru_node->key, lru_node->value);
+        }
+    }
+
+    /**
+     * Evicts up to max_evictions entries above capacity, left over from a
+     * setCapacity() shrink. Caller holds the write lock.
+     *
+     * @return The number of entries still above capacity
+     */
+    int evictExcess(int max_evictions) {
+        int capacity = capacity_.load(std::memory_order_relaxed);
+        for (int i = 0; i < max_evictions && static_cast<int>(map_.size()) > capacity; i++) {
+            evictLru();
+        }
+        return std::max(0, static_cast<int>(map_.size()) - capacity);
+    }
+
     void addNodeToEnd(std::shared_ptr<Node> node) {
         node->prev = tail_->prev;
         node->next = tail_;
@@ -55,6 +268,73 @@ private:
         tail_->prev = node;
     }
 
+    // What a read-modify-write does with the entry.
+    enum class Action { Keep, Store, Remove };
+
+    /**
+     * Runs a read-modify-write under one write lock with one map probe: an
+     * absent key gets a placeholder slot that is filled or erased once fn
+     * has decided. fn(current, next) sees the entry's node (nullptr if
+     * absent), sets next when it returns Store, and must not call back into
+     * the cache. A kept or stored entry becomes most recently used.
+     *
+     * @return A copy of the resulting value, or nullptr if there is none
+     */
+    template <typename Fn>
+    std::shared_ptr<V> modify(const K& key, std::size_t hash, Fn&& fn) {
+        recordAccess(key);
+        std::optional<V> next;
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        auto [it, inserted] = map_.try_emplace(KeyRef{&key, hash}, nullptr);
+        if (!inserted && isStale(*it->second)) {
+            // Lazily invalidated: drop the entry and reuse its slot as a placeholder.
+            removeNode(it->second);
+            detachTags(it->second.get());
+            it->first.key = &key;
+            it->second = nullptr;
+            inserted = true;
+        }
+        Action action;
+        try {
+            action = fn(inserted ? nullptr : it->second.get(), next);
+        } catch (...) {
+            if (inserted) {
+                map_.erase(it);
+            }
+            throw;
+        }
+        if (inserted) {
+            if (action != Action::Store) {
+                map_.erase(it);
+                return nullptr;
+            }
+            auto node = std::make_shared<Node>(key, std::move(*next), hash);
+            node->seq = next_seq_++;
+            node->version = next_version_++;
+            it->first.key = &node->key;
+            it->second = node;
+            addNodeToEnd(node);
+            auto result = std::make_shared<V>(node->value);
+            evictExcess(kEvictionBatch);  // the new entry is most recent, so never the victim
+            return result;
+        }
+        auto node = it->second;
+        if (action == Action::Remove) {
+            removeNode(node);
+            map_.erase(it);
+            detachTags(node.get());
+            return nullptr;
+        }
+        if (action == Action::Store) {
+            node->value = std::move(*next);
+            node->version = next_version_++;
+        }
+        removeNode(node);
+        addNodeToEnd(node);
+        evictExcess(kEvictionBatch);
+        return std::make_shared<V>(node->value);
+    }
+
 public:
     /**
      * Initializes an LRU Cache with the specified capacity.
@@ -80,17 +360,42 @@ public:
      * @return A shared_ptr to the value if found, nullptr otherwise
      */
     std::shared_ptr<V> get(const K& key) {
+        return get(key, hasher_(key));
+    }
+
+    /**
+     * Retrieves a value using a hash the caller has already computed.
+     *
+     * @param key The key whose value is to be retrieved
+     * @param hash Hash{}(key)
+     * @return A shared_ptr to the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key, std::size_t hash) {
+        recordAccess(key);
+        recordLookup(hash);
         std::shared_lock<std::shared_mutex> read_lock(lock_);
-        auto it = map_.find(key);
+        auto it = map_.find(KeyRef{&key, hash});
         if (it == map_.end()) {
             return nullptr;
         }
-        auto node = it->second;
         read_lock.unlock();
 
         std::unique_lock<std::shared_mutex> write_lock(lock_);
+        // Look the key up again: it may have been removed, evicted or
+        // cleared between the two locks.
+        it = map_.find(KeyRef{&key, hash});
+        if (it == map_.end()) {
+            return nullptr;
+        }
+        auto node = it->second;
         removeNode(node);
+        if (isStale(*node)) {
+            map_.erase(it);
+            detachTags(node.get());
+            return nullptr;
+        }
         addNodeToEnd(node);
+        evictExcess(kEvictionBatch);
         return std::make_shared<V>(node->value);
     }
 
@@ -103,48 +408,385 @@ public:
      * @param value The value to be associated with the key
      */
     void put(const K& key, const V& value) {
+        put(key, hasher_(key), value);
+    }
+
+    /**
+     * Inserts or updates a key-value pair using a hash the caller has
+     * already computed.
+     *
+     * @param key The key to be inserted or updated
+     * @param hash Hash{}(key)
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, std::size_t hash, const V& value) {
+        put(key, hash, value, std::vector<std::string>());
+    }
+
+    /**
+     * Inserts or updates a key-value pair carrying tags, for
+     * invalidateTag(). The entry's tags are replaced by these; the plain
+     * put() overloads leave it untagged.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     * @param tags The entry's tags; duplicates are ignored
+     */
+    void put(const K& key, const V& value, const std::vector<std::string>& tags) {
+        put(key, hasher_(key), value, tags);
+    }
+
+    /**
+     * Inserts or updates a tagged key-value pair using a hash the caller
+     * has already computed.
+     *
+     * @param key The key to be inserted or updated
+     * @param hash Hash{}(key)
+     * @param value The value to be associated with the key
+     * @param tags The entry's tags; duplicates are ignored
+     */
+    void put(const K& key, std::size_t hash, const V& value, const std::vector<std::string>& tags) {
+        recordAccess(key);
         std::unique_lock<std::shared_mutex> write_lock(lock_);
-        auto it = map_.find(key);
+        auto it = map_.find(KeyRef{&key, hash});
         if (it != map_.end()) {
             auto node = it->second;
             node->value = value;
+            node->version = next_version_++;
+            if (!node->tags.empty()) {
+                detachTags(node.get());
+            }
+            attachTags(node.get(), tags);
             removeNode(node);
             addNodeToEnd(node);
         } else {
-            if (static_cast<int>(map_.size()) >= capacity_) {
-                auto lru_node = head_->next;
-                removeNode(lru_node);
-                map_.erase(lru_node->key);
+            if (static_cast<int>(map_.size()) >= capacity_.load(std::memory_order_relaxed)) {
+                evictLru();
             }
-            auto new_node = std::make_shared<Node>(key, value);
+            auto new_node = std::make_shared<Node>(key, value, hash);
+            new_node->seq = next_seq_++;
+            new_node->version = next_version_++;
+            attachTags(new_node.get(), tags);
             addNodeToEnd(new_node);
-            map_[key] = new_node;
+            map_.emplace(KeyRef{&new_node->key, hash}, new_node);
         }
+        evictExcess(kEvictionBatch);
     }
 
     /**
      * Removes the entry associated with the given key.
      *
      * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        return remove(key, hasher_(key));
+    }
+
+    /**
+     * Removes an entry using a hash the caller has already computed.
+     *
+     * @param key The key of the entry to be removed
+     * @param hash Hash{}(key)
+     * @return true if an entry was removed, false if the key was absent
      */
-    void remove(const K& key) {
+    bool remove(const K& key, std::size_t hash) {
         std::unique_lock<std::shared_mutex> write_lock(lock_);
-        auto it = map_.find(key);
-        if (it != map_.end()) {
-            auto node = it->second;
-            removeNode(node);
+        auto it = map_.find(KeyRef{&key, hash});
+        if (it == map_.end()) {
+            return false;
+        }
+        auto node = it->second;
+        removeNode(node);
+        map_.erase(it);
+        bool stale = isStale(*node);
+        detachTags(node.get());
+        return !stale;
+    }
+
+    /**
+     * Removes several keys under one write-lock acquisition. Keys are
+     * hashed before the lock is taken, and the removed entries are
+     * destroyed after it is released.
+     *
+     * @param keys The keys of the entries to be removed
+     * @return The number of entries removed
+     */
+    int removeAll(const std::vector<K>& keys) {
+        std::vector<std::size_t> hashes;
+        hashes.reserve(keys.size());
+        for (const K& key : keys) {
+            hashes.push_back(hasher_(key));
+        }
+        return removeAll(keys, hashes);
+    }
+
+    /**
+     * Removes several keys using hashes the caller has already computed.
+     *
+     * @param keys The keys of the entries to be removed
+     * @param hashes hashes[i] == Hash{}(keys[i])
+     * @return The number of entries removed, not counting lazily
+     *         invalidated ones
+     * @throws std::invalid_argument if keys and hashes differ in length
+     */
+    int removeAll(const std::vector<K>& keys, const std::vector<std::size_t>& hashes) {
+        if (keys.size() != hashes.size()) {
+            throw std::invalid_argument("Keys and hashes must have the same length");
+        }
+        std::vector<std::shared_ptr<Node>> removed;
+        int live = 0;
+        {
+            std::unique_lock<std::shared_mutex> write_lock(lock_);
+            for (std::size_t i = 0; i < keys.size(); i++) {
+                auto it = map_.find(KeyRef{&keys[i], hashes[i]});
+                if (it == map_.end()) {
+                    continue;
+                }
+                removeNode(it->second);
+                live += isStale(*it->second) ? 0 : 1;
+                detachTags(it->second.get());
+                removed.push_back(std::move(it->second));
+                map_.erase(it);
+            }
+        }
+        return live;
+    }
+
+    /**
+     * Retrieves a value with its version, for a later compareAndSet(). Also
+     * marks the key as recently used.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return The value and its version; nullptr and 0 if the key is absent
+     */
+    VersionedValue<V> getVersioned(const K& key) {
+        return getVersioned(key, hasher_(key));
+    }
+
+    /**
+     * Retrieves a value with its version using a hash the caller has
+     * already computed.
+     *
+     * @param key The key whose value is to be retrieved
+     * @param hash Hash{}(key)
+     * @return The value and its version; nullptr and 0 if the key is absent
+     */
+    VersionedValue<V> getVersioned(const K& key, std::size_t hash) {
+        recordAccess(key);
+        recordLookup(hash);
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        auto it = map_.find(KeyRef{&key, hash});
+        if (it == map_.end()) {
+            return VersionedValue<V>();
+        }
+        auto node = it->second;
+        removeNode(node);
+        if (isStale(*node)) {
             map_.erase(it);
+            detachTags(node.get());
+            return VersionedValue<V>();
+        }
+        addNodeToEnd(node);
+        evictExcess(kEvictionBatch);
+        return VersionedValue<V>{std::make_shared<V>(node->value), node->version};
+    }
+
+    /**
+     * Atomically replaces a key's value with fn(current): one write lock,
+     * one map probe.
+     *
+     * @param key The key to compute
+     * @param fn Called as fn(const V* current), with nullptr if the key is
+     *        absent; returns std::optional<V>, where nullopt removes the
+     *        entry (or leaves the key absent). Must not call back into the cache.
+     * @return The new value, or nullptr if the key is now absent
+     * @throws Whatever fn throws; the cache is left unchanged
+     */
+    template <typename F>
+    std::shared_ptr<V> compute(const K& key, F&& fn) {
+        return compute(key, hasher_(key), std::forward<F>(fn));
+    }
+
+    /**
+     * compute() using a hash the caller has already computed.
+     */
+    template <typename F>
+    std::shared_ptr<V> compute(const K& key, std::size_t hash, F&& fn) {
+        return modify(key, hash, [&fn](const Node* current, std::optional<V>& next) {
+            next = fn(current != nullptr ? &current->value : nullptr);
+            return next ? Action::Store : Action::Remove;
+        });
+    }
+
+    /**
+     * Atomically replaces the value of a present key with fn(current).
+     * Absent keys are left absent and fn is not called.
+     *
+     * @param key The key to compute
+     * @param fn Called as fn(const V& current); returns std::optional<V>,
+     *        where nullopt removes the entry. Must not call back into the cache.
+     * @return The new value, or nullptr if the key is now absent
+     * @throws Whatever fn throws; the cache is left unchanged
+     */
+    template <typename F>
+    std::shared_ptr<V> computeIfPresent(const K& key, F&& fn) {
+        return computeIfPresent(key, hasher_(key), std::forward<F>(fn));
+    }
+
+    /**
+     * computeIfPresent() using a hash the caller has already computed.
+     */
+    template <typename F>
+    std::shared_ptr<V> computeIfPresent(const K& key, std::size_t hash, F&& fn) {
+        return modify(key, hash, [&fn](const Node* current, std::optional<V>& next) {
+            if (current == nullptr) {
+                return Action::Remove;
+            }
+            next = fn(current->value);
+            return next ? Action::Store : Action::Remove;
+        });
+    }
+
+    /**
+     * Stores value if the key is absent, otherwise replaces the current
+     * value with fn(current, value), e.g. to add to a counter.
+     *
+     * @param key The key to merge into
+     * @param value The value to store or merge
+     * @param fn Called as fn(const V& current, const V& value); returns
+     *        std::optional<V>, where nullopt removes the entry. Must not call
+     *        back into the cache.
+     * @return The new value, or nullptr if the entry was removed
+     * @throws Whatever fn throws; the cache is left unchanged
+     */
+    template <typename F>
+    std::shared_ptr<V> merge(const K& key, const V& value, F&& fn) {
+        return merge(key, hasher_(key), value, std::forward<F>(fn));
+    }
+
+    /**
+     * merge() using a hash the caller has already computed.
+     */
+    template <typename F>
+    std::shared_ptr<V> merge(const K& key, std::size_t hash, const V& value, F&& fn) {
+        return modify(key, hash, [&fn, &value](const Node* current, std::optional<V>& next) {
+            if (current == nullptr) {
+                next = value;
+            } else {
+                next = fn(current->value, value);
+            }
+            return next ? Action::Store : Action::Remove;
+        });
+    }
+
+    /**
+     * Stores value only if the entry is still at the expected version.
+     * Every write gives the entry a new version, unique across the cache's
+     * lifetime, so a key that was removed and re-added does not match.
+     *
+     * @param key The key to update
+     * @param expected_version A version from getVersioned(), or 0 to store
+     *        only if the key is absent
+     * @param value The new value
+     * @return true if the value was stored
+     */
+    bool compareAndSet(const K& key, std::uint64_t expected_version, const V& value) {
+        return compareAndSet(key, hasher_(key), expected_version, value);
+    }
+
+    /**
+     * compareAndSet() using a hash the caller has already computed.
+     */
+    bool compareAndSet(const K& key, std::size_t hash, std::uint64_t expected_version, const V& value) {
+        bool stored = false;
+        modify(key, hash, [&](const Node* current, std::optional<V>& next) {
+            std::uint64_t version = current != nullptr ? current->version : 0;
+            if (version != expected_version) {
+                return current != nullptr ? Action::Keep : Action::Remove;
+            }
+            next = value;
+            stored = true;
+            return Action::Store;
+        });
+        return stored;
+    }
+
+    /**
+     * Removes every entry carrying a tag, in one pass under one write lock.
+     * The removed entries are destroyed after the lock is released.
+     *
+     * @param tag The tag
+     * @return The number of entries removed, not counting lazily
+     *         invalidated ones
+     */
+    int invalidateTag(const std::string& tag) {
+        std::vector<std::shared_ptr<Node>> removed;
+        int live = 0;
+        {
+            std::unique_lock<std::shared_mutex> write_lock(lock_);
+            auto tag_it = tags_.find(tag);
+            if (tag_it == tags_.end()) {
+                return 0;
+            }
+            // detachTags() erases the tag itself once its last member goes.
+            std::vector<Node*> members(tag_it->second->members.begin(), tag_it->second->members.end());
+            removed.reserve(members.size());
+            for (Node* member : members) {
+                auto it = map_.find(KeyRef{&member->key, member->hash});
+                removeNode(it->second);
+                live += isStale(*member) ? 0 : 1;
+                detachTags(member);
+                removed.push_back(std::move(it->second));
+                map_.erase(it);
+            }
+        }
+        return live;
+    }
+
+    /**
+     * Invalidates every entry carrying a tag in O(1) by bumping the tag's
+     * generation. Those entries are treated as absent from now on and are
+     * removed when next looked up or evicted; until then they count towards
+     * size(). Entries written with the tag afterwards are unaffected.
+     *
+     * @param tag The tag
+     */
+    void invalidateTagLazily(const std::string& tag) {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        auto it = tags_.find(tag);
+        if (it != tags_.end()) {
+            it->second->generation++;
         }
     }
 
     /**
      * Removes all entries from the cache.
+     *
+     * The write lock is held only to swap the map out and detach the list,
+     * which takes constant time. The old entries are then destroyed by the
+     * calling thread after the lock is released, so other threads are not
+     * blocked while a large cache is freed.
      */
     void clear() {
-        std::unique_lock<std::shared_mutex> write_lock(lock_);
-        map_.clear();
-        head_->next = tail_;
-        tail_->prev = head_;
+        Map old_map;
+        TagMap old_tags;
+        std::shared_ptr<Node> old_first;
+        {
+            std::unique_lock<std::shared_mutex> write_lock(lock_);
+            old_map.swap(map_);
+            old_tags.swap(tags_);
+            if (head_->next != tail_) {
+                old_first = head_->next;
+                old_first->prev = nullptr;
+                tail_->prev->next = nullptr;
+            }
+            head_->next = tail_;
+            tail_->prev = head_;
+            cursor_ = nullptr;  // an iteration in progress sees the new generation and stops
+            generation_++;
+        }
+        releaseChain(std::move(old_first));
     }
 
     /**
@@ -154,8 +796,20 @@ public:
      * @return true if the key is in the cache, false otherwise
      */
     bool containsKey(const K& key) const {
+        return containsKey(key, hasher_(key));
+    }
+
+    /**
+     * Checks for a key using a hash the caller has already computed.
+     *
+     * @param key The key to check
+     * @param hash Hash{}(key)
+     * @return true if the key is in the cache, false otherwise
+     */
+    bool containsKey(const K& key, std::size_t hash) const {
         std::shared_lock<std::shared_mutex> read_lock(lock_);
-        return map_.find(key) != map_.end();
+        auto it = map_.find(KeyRef{&key, hash});
+        return it != map_.end() && !isStale(*it->second);
     }
 
     /**
@@ -184,7 +838,134 @@ public:
      * @return The maximum number of entries this cache can hold
      */
     int getCapacity() const {
-        return capacity_;
+        return capacity_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Changes the capacity of a live cache.
+     *
+     * Growing takes effect immediately. When shrinking, at most a small
+     * batch of least recently used entries is evicted here; the rest of the
+     * excess is evicted in batches by subsequent get/put calls, or by
+     * trimToCapacity(). No call holds the lock for the whole excess, so
+     * a large shrink does not cause a latency spike. Until the excess is
+     * gone, size() may exceed getCapacity().
+     *
+     * @param capacity The new maximum number of entries
+     * @throws std::invalid_argument if capacity <= 0
+     */
+    void setCapacity(int capacity) {
+        if (capacity <= 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        capacity_.store(capacity, std::memory_order_relaxed);
+        evictExcess(kEvictionBatch);
+    }
+
+    /**
+     * Evicts up to max_evictions entries left above capacity by a shrink.
+     * Meant for a maintenance loop that calls it until it returns 0.
+     *
+     * @param max_evictions The most entries to evict under this lock hold
+     * @return The number of entries still above capacity
+     */
+    int trimToCapacity(int max_evictions = kEvictionBatch) {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        return evictExcess(max_evictions);
+    }
+
+    /**
+     * Registers a callback invoked with every entry evicted to make room for
+     * a new one (not for remove() or clear()). The callback runs on the thread
+     * that called put(), while the cache lock is held, so no other operation
+     * can observe the entry as gone before the callback has handled it. It
+     * must be short and must not call back into the cache. Must be set before
+     * the cache is shared between threads.
+     *
+     * @param listener The callback, or an empty function to remove it
+     */
+    void setEvictionListener(std::function<void(const K&, const V&)> listener) {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        eviction_listener_ = std::move(listener);
+    }
+
+    /**
+     * Starts counting the most frequently accessed keys. Accesses made by
+     * get() and put() are sampled into a Space-Saving tracker outside the
+     * cache lock; until this is called, tracking costs one atomic load.
+     *
+     * @param config Counter count, sampling rate and decay interval
+     * @throws std::invalid_argument if the config is invalid
+     * @throws std::logic_error if tracking is already enabled
+     */
+    void enableHotKeyTracking(const HotKeyConfig& config = HotKeyConfig()) {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        if (hot_keys_owner_) {
+            throw std::logic_error("Hot key tracking is already enabled");
+        }
+        hot_keys_owner_ = std::make_unique<HotKeyTracker<K>>(config);
+        hot_keys_.store(hot_keys_owner_.get(), std::memory_order_release);
+    }
+
+    /**
+     * Returns the most frequently accessed keys, most frequent first.
+     *
+     * @param k The number of keys to return
+     * @return Up to k keys with estimated access counts, empty if tracking is disabled
+     */
+    std::vector<HotKey<K>> hotKeys(std::size_t k) const {
+        HotKeyTracker<K>* tracker = hot_keys_.load(std::memory_order_acquire);
+        if (tracker == nullptr) {
+            return {};
+        }
+        return tracker->top(k);
+    }
+
+    /**
+     * Starts estimating the miss-ratio curve. Lookups made by get() are
+     * fed to a SHARDS sampler outside the cache lock; until this is called,
+     * sampling costs one atomic load.
+     *
+     * @param config Initial sampling rate and sampled key bound
+     * @throws std::invalid_argument if the config is invalid
+     * @throws std::logic_error if sampling is already enabled
+     */
+    void enableMissRatioSampling(const MissRatioConfig& config = MissRatioConfig()) {
+        std::unique_lock<std::shared_mutex> write_lock(lock_);
+        if (miss_ratio_owner_) {
+            throw std::logic_error("Miss ratio sampling is already enabled");
+        }
+        miss_ratio_owner_ = std::make_unique<MissRatioSampler>(config);
+        miss_ratio_.store(miss_ratio_owner_.get(), std::memory_order_release);
+    }
+
+    /**
+     * Estimates the miss ratio get() would have at each capacity.
+     *
+     * @param capacities Capacities in entries
+     * @return One point per capacity, empty if sampling is disabled
+     */
+    std::vector<MissRatioPoint> missRatioCurve(const std::vector<std::size_t>& capacities) const {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler == nullptr) {
+            return {};
+        }
+        return sampler->curve(capacities);
+    }
+
+    /**
+     * Estimates the miss-ratio curve at powers of two up to the largest
+     * reuse distance seen.
+     *
+     * @return The curve, empty if sampling is disabled
+     */
+    std::vector<MissRatioPoint> missRatioCurve() const {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler == nullptr) {
+            return {};
+        }
+        return sampler->curve();
     }
 
     /**
@@ -193,24 +974,115 @@ public:
      * @return String representation in format: LRUCache{key1=value1, key2=value2, ...}
      */
     std::string toString() const {
-        std::shared_lock<std::shared_mutex> read_lock(lock_);
         std::ostringstream oss;
-        oss << "LRUCache{";
-        auto current = head_->next;
+        writeTo(oss);
+        return oss.str();
+    }
+
+    /**
+     * Visits every entry from least to most recently used without holding
+     * the lock for the whole walk. The lock is taken once per chunk of at
+     * most chunk_size list steps, the chunk's entries are copied, and sink
+     * is called with them after the lock is released.
+     *
+     * A marker node in the list remembers the position between chunks, so
+     * concurrent get/put/remove keep working. Guarantees:
+     * - every entry present for the whole iteration is visited exactly once,
+     *   with the value it had when its chunk was copied;
+     * - entries inserted after the iteration started are not visited;
+     * - clear() ends the iteration early.
+     * Iterations on the same cache run one at a time.
+     *
+     * @param sink Called as sink(const K&, const V&) for each visited entry
+     * @param chunk_size The maximum list steps per lock hold
+     * @throws std::invalid_argument if chunk_size is 0
+     */
+    template <typename Sink>
+    void forEachChunked(Sink&& sink, std::size_t chunk_size = 1024) const {
+        if (chunk_size == 0) {
+            throw std::invalid_argument("Chunk size must be greater than 0");
+        }
+        std::lock_guard<std::mutex> iteration_guard(iteration_lock_);
+        auto cursor = std::make_shared<Node>();
+        std::uint64_t start_seq;
+        std::uint64_t mark;
+        std::uint64_t generation;
+        {
+            std::unique_lock<std::shared_mutex> write_lock(lock_);
+            start_seq = next_seq_;
+            mark = ++iteration_mark_;
+            generation = generation_;
+            cursor_ = cursor;
+            insertBefore(head_->next, cursor);
+        }
+
+        std::vector<std::pair<K, V>> chunk;
+        chunk.reserve(chunk_size);
+        bool done = false;
+        while (!done) {
+            {
+                std::unique_lock<std::shared_mutex> write_lock(lock_);
+                if (generation_ != generation) {
+                    return;
+                }
+                auto node = cursor->next;
+                for (std::size_t steps = 0; steps < chunk_size && node != tail_; steps++) {
+                    // Skip entries added after the start, entries already
+                    // visited that a get/put moved ahead of the cursor, and
+                    // lazily invalidated entries.
+                    if (node->seq < start_seq && node->visit_mark != mark && !isStale(*node)) {
+                        node->visit_mark = mark;
+                        chunk.emplace_back(node->key, node->value);
+                    }
+                    node = node->next;
+                }
+                removeNode(cursor);
+                if (node == tail_) {
+                    cursor_ = nullptr;
+                    done = true;
+                } else {
+                    insertBefore(node, cursor);
+                }
+            }
+            try {
+                for (const auto& entry : chunk) {
+                    sink(entry.first, entry.second);
+                }
+            } catch (...) {
+                std::unique_lock<std::shared_mutex> write_lock(lock_);
+                if (!done && generation_ == generation) {
+                    removeNode(cursor);
+                    cursor_ = nullptr;
+                }
+                throw;
+            }
+            chunk.clear();
+        }
+    }
+
+    /**
+     * Streams the toString() representation to any output stream, using
+     * forEachChunked so writers are never blocked for the whole dump.
+     *
+     * @param os The destination stream
+     * @param chunk_size The maximum list steps per lock hold
+     */
+    void writeTo(std::ostream& os, std::size_t chunk_size = 1024) const {
+        os << "LRUCache{";
         bool first = true;
-        while (current != tail_) {
+        forEachChunked([&os, &first](const K& key, const V& value) {
             if (!first) {
-                oss << ", ";
+                os << ", ";
             }
-            oss << current->key << "=" << current->value;
-            current = current->next;
+            os << key << "=" << value;
             first = false;
-        }
-        oss << "}";
-        return oss.str();
+        }, chunk_size);
+        os << "}";
     }
 
-    ~LRUCache() = default;
+    ~LRUCache() {
+        releaseChain(std::move(head_));
+    }
 };
 
 #endif // LRU_CACHE_H
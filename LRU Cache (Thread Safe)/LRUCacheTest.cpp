@@ -1,8 +1,16 @@
 #include "LRUCache.h"
+#include "ShardedLRUCache.h"
 #include <iostream>
 #include <cassert>
 #include <thread>
 #include <vector>
+#include <atomic>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <optional>
+#include <stdexcept>
 
 /**
  * Google Test-style test cases for LRUCache implementation.
@@ -145,6 +153,33 @@ void testConcurrentAccess() {
     t1.join();
     t2.join();
 
+    assert(cache.size() <= 100);
+
+    // get() relinks its entry after trading the shared lock for the unique
+    // lock; a remove or eviction in between must not corrupt the list.
+    auto reader = [&cache]() {
+        for (int round = 0; round < 2000; round++) {
+            for (int i = 0; i < 10; i++) {
+                auto value = cache.get(i);
+                assert(value == nullptr || *value == i);
+            }
+        }
+    };
+    auto writer = [&cache]() {
+        for (int round = 0; round < 2000; round++) {
+            for (int i = 0; i < 10; i++) {
+                cache.remove(i);
+                cache.put(i, i);
+            }
+        }
+    };
+    std::thread r1(reader);
+    std::thread r2(reader);
+    std::thread w(writer);
+    r1.join();
+    r2.join();
+    w.join();
+
     assert(cache.size() <= 100);
     std::cout << "✓ Passed (Cache size: " << cache.size() << ")\n" << std::endl;
 }
@@ -162,6 +197,478 @@ void testToString() {
     std::cout << "✓ Passed\n" << std::endl;
 }
 
+void testHotKeys() {
+    std::cout << "Test 11: Hot Key Tracking" << std::endl;
+    LRUCache<int, int> cache(1000);
+    assert(cache.hotKeys(3).empty());
+
+    HotKeyConfig config;
+    config.counters = 16;
+    config.sample_every = 1;
+    cache.enableHotKeyTracking(config);
+
+    // Keys 0, 1, 2 take most of the traffic; 500 others are touched once each.
+    for (int i = 0; i < 500; i++) {
+        cache.put(1000 + i, i);
+        cache.get(0);
+        cache.get(0);
+        cache.get(0);
+        cache.get(1);
+        cache.get(1);
+        cache.get(2);
+    }
+    auto hot = cache.hotKeys(3);
+    assert(hot.size() == 3);
+    assert(hot[0].key == 0 && hot[1].key == 1 && hot[2].key == 2);
+    assert(hot[0].count >= 1500 && hot[0].count - hot[0].error <= 1500);
+
+    bool threw = false;
+    try {
+        cache.enableHotKeyTracking(config);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testEvictionListener() {
+    std::cout << "Test 12: Eviction Listener" << std::endl;
+    LRUCache<int, std::string> cache(2);
+    std::vector<std::pair<int, std::string>> evicted;
+    cache.setEvictionListener([&evicted](const int& key, const std::string& value) {
+        evicted.emplace_back(key, value);
+    });
+
+    cache.put(1, "one");
+    cache.put(2, "two");
+    cache.put(2, "TWO");   // update, no eviction
+    cache.put(3, "three"); // evicts 1
+    cache.remove(2);       // removal is not an eviction
+    assert(evicted.size() == 1);
+    assert(evicted[0].first == 1 && evicted[0].second == "one");
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testChunkedIteration() {
+    std::cout << "Test 13: Chunked Iteration Under Concurrent Writes" << std::endl;
+    LRUCache<int, int> cache(20000);
+    for (int i = 0; i < 10000; i++) {
+        cache.put(i, i);
+    }
+
+    // Reorder stable keys and churn others while iterating in small chunks.
+    std::atomic<bool> stop{false};
+    std::thread writer([&cache, &stop]() {
+        for (int i = 0; !stop.load(); i++) {
+            cache.get(i % 10000);
+            cache.put(10000 + i % 5000, i);
+            cache.remove(10000 + (i * 7) % 5000);
+        }
+    });
+    std::vector<int> visits(15000, 0);
+    cache.forEachChunked([&visits](const int& key, const int&) {
+        visits[key]++;
+    }, 16);
+    stop = true;
+    writer.join();
+
+    for (int i = 0; i < 10000; i++) {
+        assert(visits[i] == 1);
+    }
+    for (int i = 10000; i < 15000; i++) {
+        assert(visits[i] <= 1);
+    }
+
+    // Streaming output matches toString() and leaves no marker behind.
+    LRUCache<int, int> small(3);
+    small.put(1, 10);
+    small.put(2, 20);
+    std::ostringstream oss;
+    small.writeTo(oss, 1);
+    assert(oss.str() == "LRUCache{1=10, 2=20}");
+    small.put(3, 30);
+    small.put(4, 40);
+    assert(small.toString() == "LRUCache{2=20, 3=30, 4=40}");
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSetCapacity() {
+    std::cout << "Test 14: Online Capacity Resize" << std::endl;
+    LRUCache<int, int> cache(1000);
+    for (int i = 0; i < 1000; i++) {
+        cache.put(i, i);
+    }
+
+    // Shrinking evicts one bounded batch now and the rest incrementally.
+    cache.setCapacity(100);
+    assert(cache.getCapacity() == 100);
+    assert(cache.size() < 1000 && cache.size() > 100);
+    int remaining = cache.size() - 100;
+    while (remaining > 0) {
+        int next = cache.trimToCapacity(50);
+        assert(next == std::max(0, remaining - 50));
+        remaining = next;
+    }
+    assert(cache.size() == 100);
+    assert(cache.get(899) == nullptr);
+    assert(cache.get(900) != nullptr && cache.get(999) != nullptr);
+
+    // Ordinary puts also drain the excess.
+    cache.setCapacity(10);
+    for (int i = 0; i < 5; i++) {
+        cache.put(2000 + i, i);
+    }
+    assert(cache.size() == 10);
+
+    cache.setCapacity(20);
+    for (int i = 0; i < 10; i++) {
+        cache.put(3000 + i, i);
+    }
+    assert(cache.size() == 20);
+
+    bool threw = false;
+    try {
+        cache.setCapacity(0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+namespace {
+
+std::atomic<int> live_values{0};
+
+// Counts its live instances, to check that cleared entries are freed.
+struct Tracked {
+    int id = 0;
+    Tracked() { live_values++; }
+    explicit Tracked(int i) : id(i) { live_values++; }
+    Tracked(const Tracked& other) : id(other.id) { live_values++; }
+    Tracked& operator=(const Tracked& other) = default;
+    ~Tracked() { live_values--; }
+};
+
+} // namespace
+
+void testClearReleasesEntries() {
+    std::cout << "Test 15: Clear Releases Entries Outside the Lock" << std::endl;
+    {
+        LRUCache<int, Tracked> cache(200000);
+        for (int i = 0; i < 200000; i++) {
+            cache.put(i, Tracked(i));
+        }
+        cache.remove(7);
+
+        std::atomic<bool> stop{false};
+        std::thread reader([&cache, &stop]() {
+            while (!stop) {
+                for (int i = 0; i < 1000; i++) {
+                    auto value = cache.get(i);
+                    assert(value == nullptr || value->id == i);
+                }
+            }
+        });
+        cache.clear();
+        stop = true;
+        reader.join();
+
+        // Only the reader's short-lived copies could still be alive.
+        assert(cache.size() == 0);
+        assert(live_values <= 2);  // head and tail sentinels
+
+        cache.put(1, Tracked(1));
+        assert(cache.get(1)->id == 1);
+        cache.clear();
+        cache.clear();
+        assert(cache.isEmpty());
+    }
+    assert(live_values == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+namespace {
+
+std::atomic<int> hash_calls{0};
+
+struct CountingHash {
+    std::size_t operator()(int key) const {
+        hash_calls++;
+        return std::hash<int>{}(key);
+    }
+};
+
+} // namespace
+
+void testPrecomputedHash() {
+    std::cout << "Test 16: Precomputed Hash Overloads" << std::endl;
+    LRUCache<int, int, CountingHash> cache(1000);
+    // Growing the map past several rehashes and evicting never calls Hash.
+    for (int i = 0; i < 5000; i++) {
+        cache.put(i, std::hash<int>{}(i), i * 2);
+    }
+    assert(hash_calls == 0);
+    assert(cache.size() == 1000);
+    assert(*cache.get(4999, std::hash<int>{}(4999)) == 9998);
+    assert(cache.containsKey(4000, std::hash<int>{}(4000)));
+    assert(cache.remove(4000, std::hash<int>{}(4000)));
+    assert(hash_calls == 0);
+
+    // The plain overloads hash exactly once per call.
+    assert(*cache.get(4999) == 9998);
+    cache.put(6000, 1);
+    assert(!cache.containsKey(4000));
+    assert(hash_calls == 3);
+
+    // The sharded cache reuses the same hash for the shard and the entry.
+    hash_calls = 0;
+    ShardedLRUCache<int, int, CountingHash> sharded(1000, 8);
+    for (int i = 0; i < 2000; i++) {
+        sharded.put(i, i);
+    }
+    assert(hash_calls == 2000);
+    assert(*sharded.get(1999, std::hash<int>{}(1999)) == 1999);
+    assert(hash_calls == 2000);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMissRatioCurve() {
+    std::cout << "Test 17: Miss-Ratio Curve Sampling" << std::endl;
+    // Skewed reads over 20000 keys, replayed look-aside (put on miss).
+    std::mt19937_64 rng(3);
+    std::vector<int> trace;
+    for (int i = 0; i < 300000; i++) {
+        std::uint64_t r = rng();
+        trace.push_back(static_cast<int>((r % 20000) % ((r >> 32) % 20000 + 1)));
+    }
+    auto replay = [&trace](LRUCache<int, int>& cache) {
+        int misses = 0;
+        for (int key : trace) {
+            if (cache.get(key) == nullptr) {
+                misses++;
+                cache.put(key, key);
+            }
+        }
+        return static_cast<double>(misses) / trace.size();
+    };
+
+    LRUCache<int, int> sampled(100);
+    assert(sampled.missRatioCurve().empty());
+    MissRatioConfig config;
+    config.sampling_rate = 0.1;
+    sampled.enableMissRatioSampling(config);
+    replay(sampled);
+    std::vector<MissRatioPoint> curve = sampled.missRatioCurve({100, 1000, 5000, 20000});
+    assert(curve.size() == 4);
+
+    // The estimate for every capacity is close to the real LRU miss ratio.
+    for (const MissRatioPoint& point : curve) {
+        LRUCache<int, int> actual(static_cast<int>(point.capacity));
+        assert(std::fabs(point.miss_ratio - replay(actual)) < 0.03);
+    }
+    // Non-increasing, and every key fits at 20000: only cold misses remain.
+    for (std::size_t i = 1; i < curve.size(); i++) {
+        assert(curve[i].miss_ratio <= curve[i - 1].miss_ratio);
+    }
+    assert(!sampled.missRatioCurve().empty());
+
+    bool threw = false;
+    try {
+        sampled.enableMissRatioSampling();
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A tight key bound lowers the rate instead of growing.
+    ShardedLRUCache<int, int> sharded(1000, 4);
+    config.sampling_rate = 1.0;
+    config.max_keys = 256;
+    sharded.enableMissRatioSampling(config);
+    for (int key : trace) {
+        if (sharded.get(key) == nullptr) {
+            sharded.put(key, key);
+        }
+    }
+    curve = sharded.missRatioCurve({1000});
+    assert(curve.size() == 1 && curve[0].miss_ratio > 0.0 && curve[0].miss_ratio < 1.0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testAtomicUpdates() {
+    std::cout << "Test 18: Compute, Merge and Compare-and-Set" << std::endl;
+    LRUCache<std::string, int> cache(3);
+
+    // compute inserts, updates and removes.
+    auto v = cache.compute("a", [](const int* current) -> std::optional<int> {
+        return current == nullptr ? 1 : *current + 1;
+    });
+    assert(v != nullptr && *v == 1);
+    v = cache.compute("a", [](const int* current) -> std::optional<int> { return *current + 1; });
+    assert(*v == 2 && *cache.get("a") == 2);
+    assert(cache.compute("a", [](const int*) -> std::optional<int> { return std::nullopt; }) == nullptr);
+    assert(!cache.containsKey("a"));
+    assert(cache.compute("none", [](const int*) -> std::optional<int> { return std::nullopt; }) == nullptr);
+    assert(cache.isEmpty());
+
+    // computeIfPresent never inserts.
+    bool called = false;
+    assert(cache.computeIfPresent("b", [&called](const int&) -> std::optional<int> {
+        called = true;
+        return 5;
+    }) == nullptr);
+    assert(!called && !cache.containsKey("b"));
+    cache.put("b", 5);
+    assert(*cache.computeIfPresent("b", [](const int& c) -> std::optional<int> { return c * 2; }) == 10);
+
+    // A throwing function leaves the cache unchanged.
+    bool threw = false;
+    try {
+        cache.compute("c", [](const int*) -> std::optional<int> { throw std::runtime_error("boom"); });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && !cache.containsKey("c") && cache.size() == 1);
+
+    // Inserting through compute evicts like put.
+    cache.put("c", 3);
+    cache.put("d", 4);
+    cache.merge("e", 1, [](const int& c, const int& d) -> std::optional<int> { return c + d; });
+    assert(cache.size() == 3 && !cache.containsKey("b"));
+    assert(*cache.merge("e", 4, [](const int& c, const int& d) -> std::optional<int> { return c + d; }) == 5);
+
+    // compareAndSet succeeds only at the version that was read.
+    auto read = cache.getVersioned("e");
+    assert(read.value != nullptr && *read.value == 5 && read.version != 0);
+    assert(cache.compareAndSet("e", read.version, 6));
+    assert(!cache.compareAndSet("e", read.version, 7));
+    assert(*cache.get("e") == 6);
+    auto missing = cache.getVersioned("zzz");
+    assert(missing.value == nullptr && missing.version == 0);
+    assert(cache.compareAndSet("f", 0, 1));   // 0: only if absent
+    assert(!cache.compareAndSet("f", 0, 2));
+    assert(!cache.compareAndSet("gone", 12345, 1) && !cache.containsKey("gone"));
+    // A removed and re-added key gets a new version.
+    read = cache.getVersioned("f");
+    cache.remove("f");
+    cache.put("f", 1);
+    assert(!cache.compareAndSet("f", read.version, 9));
+
+    // Concurrent merges and CAS loops lose no increments.
+    ShardedLRUCache<std::string, long> counters(100, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&counters]() {
+            for (int i = 0; i < 2000; i++) {
+                counters.merge("hits", 1L, [](const long& c, const long& d) -> std::optional<long> {
+                    return c + d;
+                });
+                while (true) {
+                    auto current = counters.getVersioned("cas");
+                    long next = current.value ? *current.value + 1 : 1;
+                    if (counters.compareAndSet("cas", current.version, next)) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(*counters.get("hits") == 8000);
+    assert(*counters.get("cas") == 8000);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testTags() {
+    std::cout << "Test 19: Tag-Based Invalidation" << std::endl;
+    LRUCache<std::string, int> cache(100);
+    cache.put("order:1", 1, {"user:7", "table:orders"});
+    cache.put("order:2", 2, {"user:7", "table:orders", "user:7"});
+    cache.put("order:3", 3, {"user:8", "table:orders"});
+    cache.put("plain", 4);
+
+    assert(cache.invalidateTag("user:7") == 2);
+    assert(!cache.containsKey("order:1") && !cache.containsKey("order:2"));
+    assert(cache.containsKey("order:3") && cache.size() == 2);
+    assert(cache.invalidateTag("user:7") == 0);
+    assert(cache.invalidateTag("unknown") == 0);
+
+    // Removal, eviction and untagged puts take entries out of the index.
+    cache.put("order:3", 30);
+    assert(cache.invalidateTag("table:orders") == 0 && cache.containsKey("order:3"));
+    cache.put("order:4", 4, {"t"});
+    assert(cache.remove("order:4"));
+    assert(cache.invalidateTag("t") == 0);
+    LRUCache<int, int> small(2);
+    small.put(1, 1, {"t"});
+    small.put(2, 2, {"t"});
+    small.put(3, 3);  // evicts 1
+    assert(small.invalidateTag("t") == 1 && small.size() == 1 && small.containsKey(3));
+
+    // Lazy invalidation: entries written before the bump read as absent.
+    for (int i = 0; i < 10; i++) {
+        cache.put("big:" + std::to_string(i), i, {"big"});
+    }
+    cache.invalidateTagLazily("big");
+    cache.put("big:new", 100, {"big"});
+    assert(cache.size() == 13);  // stale entries still count until touched
+    assert(cache.get("big:0") == nullptr);
+    assert(cache.size() == 12);
+    assert(!cache.containsKey("big:1"));
+    assert(cache.getVersioned("big:2").value == nullptr);
+    assert(!cache.remove("big:3"));
+    assert(cache.compute("big:4", [](const int* current) -> std::optional<int> {
+        assert(current == nullptr);
+        return 40;
+    }) != nullptr);
+    assert(*cache.get("big:4") == 40);
+    assert(*cache.get("big:new") == 100);
+    std::string dump = cache.toString();
+    assert(dump.find("big:5") == std::string::npos && dump.find("big:new") != std::string::npos);
+    assert(cache.invalidateTag("big") == 1);  // only big:new was live
+    assert(cache.containsKey("big:4") && !cache.containsKey("big:6"));
+
+    // Sharded, with writers racing an invalidator.
+    ShardedLRUCache<std::string, int> sharded(10000, 8);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; t++) {
+        writers.emplace_back([&sharded, t]() {
+            for (int i = 0; i < 3000; i++) {
+                std::string key = std::to_string(t) + ":" + std::to_string(i);
+                sharded.put(key, i, {"user:" + std::to_string(i % 10), "all"});
+                sharded.get(key);
+            }
+        });
+    }
+    std::thread invalidator([&sharded, &done]() {
+        int round = 0;
+        while (!done.load()) {
+            if (round++ % 2 == 0) {
+                sharded.invalidateTag("user:3");
+            } else {
+                sharded.invalidateTagLazily("user:4");
+            }
+        }
+    });
+    for (auto& t : writers) {
+        t.join();
+    }
+    done.store(true);
+    invalidator.join();
+    sharded.invalidateTag("user:3");
+    sharded.invalidateTagLazily("user:4");
+    assert(!sharded.containsKey("0:3") && !sharded.containsKey("1:14"));
+    assert(sharded.containsKey("2:5"));
+    assert(sharded.invalidateTag("all") == 9000 - 900 * 2);
+    assert(!sharded.containsKey("2:5"));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
 int main() {
     std::cout << "Running LRU Cache Tests...\n" << std::endl;
 
@@ -175,6 +682,15 @@ int main() {
     testSize();
     testConcurrentAccess();
     testToString();
+    testHotKeys();
+    testEvictionListener();
+    testChunkedIteration();
+    testSetCapacity();
+    testClearReleasesEntries();
+    testPrecomputedHash();
+    testMissRatioCurve();
+    testAtomicUpdates();
+    testTags();
 
     std::cout << "\nAll tests passed!" << std::endl;
     return 0;
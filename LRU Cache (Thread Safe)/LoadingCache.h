@@ -0,0 +1,213 @@
+#ifndef LOADING_CACHE_H
+#define LOADING_CACHE_H
+
+#include "ShardedLRUCache.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+/**
+ * Settings for LoadingCache.
+ */
+struct LoadingCacheConfig {
+    std::chrono::nanoseconds ttl = std::chrono::seconds(60);
+    // Probabilistic early refresh (XFetch). 0 disables it; 1 is the usual
+    // setting, larger values refresh earlier.
+    double early_refresh_beta = 0.0;
+    // Draws u in (0, 1] for the early refresh rule. Empty uses a
+    // thread-local generator; tests set it to get fixed decisions.
+    std::function<double()> uniform;
+};
+
+/**
+ * Counters reported by LoadingCache::getStats().
+ */
+struct LoadingCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t loads = 0;            // misses and expired entries
+    std::uint64_t early_refreshes = 0;  // hits that reloaded before expiry
+};
+
+/**
+ * Read-through cache with a time-to-live and optional probabilistic early
+ * refresh, built on ShardedLRUCache.
+ *
+ * get(key, loader) returns the cached value while it is fresh and calls
+ * loader otherwise. Every entry records how long its load took.
+ *
+ * With early_refresh_beta > 0, a hit on an entry that expires in
+ * `remaining` reloads anyway when
+ *
+ *     load_time * beta * -ln(u) >= remaining,   u uniform in (0, 1]
+ *
+ * (the XFetch rule). Far from expiry this almost never happens; as expiry
+ * nears, and the slower the load, the more likely each hit is to refresh.
+ * With many callers one of them usually reloads shortly before expiry, so
+ * the popular key never expires under load and callers do not all reload
+ * at once. The decision is local to each caller: no lock, flag or message.
+ *
+ * Several callers may refresh the same key concurrently; the last put wins.
+ *
+ * @tparam K The type of keys maintained by this cache
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
+ * @tparam Clock A steady clock with a static now(); tests substitute a fake
+ */
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename Clock = std::chrono::steady_clock>
+class LoadingCache {
+private:
+    struct Entry {
+        std::shared_ptr<V> value;
+        typename Clock::time_point expires_at;
+        std::chrono::nanoseconds load_time{0};
+    };
+
+    ShardedLRUCache<K, Entry, Hash> cache_;
+    LoadingCacheConfig config_;
+    Hash hasher_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> loads_{0};
+    std::atomic<std::uint64_t> early_refreshes_{0};
+
+    double uniform() const {
+        if (config_.uniform) {
+            return config_.uniform();
+        }
+        thread_local std::mt19937_64 rng(std::random_device{}());
+        // (0, 1], so the logarithm is finite.
+        return 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    }
+
+    template <typename Loader>
+    std::shared_ptr<V> load(const K& key, std::size_t hash, Loader&& loader) {
+        typename Clock::time_point start = Clock::now();
+        auto value = std::make_shared<V>(loader(key));
+        typename Clock::time_point end = Clock::now();
+        auto load_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        cache_.put(key, hash, Entry{value, end + config_.ttl, load_time});
+        return value;
+    }
+
+public:
+    /**
+     * Initializes a loading cache.
+     *
+     * @param capacity The maximum number of entries
+     * @param shard_count The number of independently locked shards
+     * @param config TTL and early refresh settings
+     * @throws std::invalid_argument if capacity or shard_count <= 0, ttl <= 0
+     *         or early_refresh_beta < 0
+     */
+    LoadingCache(int capacity, int shard_count, const LoadingCacheConfig& config = LoadingCacheConfig())
+        : cache_(capacity, shard_count), config_(config) {
+        if (config.ttl <= std::chrono::nanoseconds::zero()) {
+            throw std::invalid_argument("TTL must be greater than 0");
+        }
+        if (!(config.early_refresh_beta >= 0.0)) {
+            throw std::invalid_argument("Early refresh beta must not be negative");
+        }
+    }
+
+    /**
+     * Decides whether a hit should refresh early (the XFetch rule).
+     *
+     * @param remaining Time until the entry expires
+     * @param load_time How long the entry's last load took
+     * @param beta Scales how early refreshes happen; 0 never refreshes early
+     * @param u A uniform random number in (0, 1]
+     * @return true if the caller should reload now
+     */
+    static bool shouldRefreshEarly(std::chrono::nanoseconds remaining,
+                                   std::chrono::nanoseconds load_time, double beta, double u) {
+        if (beta <= 0.0) {
+            return false;
+        }
+        double lead = static_cast<double>(load_time.count()) * beta * -std::log(u);
+        return lead >= static_cast<double>(remaining.count());
+    }
+
+    /**
+     * Returns the cached value, loading it if it is absent, expired, or
+     * chosen for early refresh.
+     *
+     * @param key The key whose value is to be retrieved
+     * @param loader Called as loader(key) and returns a V
+     * @return A shared_ptr to the value
+     * @throws Whatever loader throws; the cache is left unchanged
+     */
+    template <typename Loader>
+    std::shared_ptr<V> get(const K& key, Loader&& loader) {
+        std::size_t hash = hasher_(key);
+        auto entry = cache_.get(key, hash);
+        if (entry) {
+            typename Clock::time_point now = Clock::now();
+            if (now < entry->expires_at) {
+                auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(entry->expires_at - now);
+                if (shouldRefreshEarly(remaining, entry->load_time, config_.early_refresh_beta, uniform())) {
+                    early_refreshes_.fetch_add(1, std::memory_order_relaxed);
+                    return load(key, hash, std::forward<Loader>(loader));
+                }
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return entry->value;
+            }
+        }
+        loads_.fetch_add(1, std::memory_order_relaxed);
+        return load(key, hash, std::forward<Loader>(loader));
+    }
+
+    /**
+     * Returns the cached value if it is present and fresh, without loading.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to the value, or nullptr
+     */
+    std::shared_ptr<V> getIfPresent(const K& key) {
+        auto entry = cache_.get(key);
+        if (!entry || Clock::now() >= entry->expires_at) {
+            return nullptr;
+        }
+        return entry->value;
+    }
+
+    /**
+     * Stores a value with a fresh TTL. It is treated as instant to load.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        cache_.put(key, Entry{std::make_shared<V>(value), Clock::now() + config_.ttl,
+                              std::chrono::nanoseconds::zero()});
+    }
+
+    /**
+     * Removes a key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        return cache_.remove(key);
+    }
+
+    /**
+     * Returns hit, load and early refresh counts.
+     *
+     * @return A snapshot of the counters
+     */
+    LoadingCacheStats getStats() const {
+        LoadingCacheStats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.loads = loads_.load(std::memory_order_relaxed);
+        stats.early_refreshes = early_refreshes_.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+#endif // LOADING_CACHE_H
@@ -0,0 +1,211 @@
+#include "LoadingCache.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for LoadingCache.
+ *
+ * Tests cover:
+ * - Read-through loading and TTL expiry
+ * - The early refresh rule
+ * - Early refresh keeps a hot key from expiring, on a fake clock with
+ *   fixed random draws
+ * - Concurrent callers loading and refreshing one key
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread LoadingCacheTest.cpp -o loading_cache_test
+ */
+
+using namespace std::chrono;
+
+namespace {
+
+/**
+ * A clock that only moves when told to.
+ */
+struct FakeClock {
+    using duration = nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static inline time_point current{};
+
+    static time_point now() {
+        return current;
+    }
+
+    static void advance(nanoseconds d) {
+        current += d;
+    }
+};
+
+} // namespace
+
+void testLoadAndExpiry() {
+    std::cout << "Test 1: Read-Through Loading and TTL Expiry" << std::endl;
+    LoadingCacheConfig config;
+    config.ttl = milliseconds(50);
+    LoadingCache<std::string, int, std::hash<std::string>, FakeClock> cache(100, 4, config);
+    int loads = 0;
+    auto loader = [&loads](const std::string& key) {
+        loads++;
+        return static_cast<int>(key.size());
+    };
+
+    assert(*cache.get("abc", loader) == 3);
+    assert(*cache.get("abc", loader) == 3);
+    assert(loads == 1);
+    assert(*cache.getIfPresent("abc") == 3);
+
+    FakeClock::advance(milliseconds(49));
+    assert(*cache.getIfPresent("abc") == 3);
+    FakeClock::advance(milliseconds(1));
+    assert(cache.getIfPresent("abc") == nullptr);
+    assert(*cache.get("abc", loader) == 3);
+    assert(loads == 2);
+
+    cache.put("x", 7);
+    assert(*cache.get("x", loader) == 7);
+    assert(cache.remove("x"));
+    assert(cache.getIfPresent("x") == nullptr);
+
+    // A failing loader leaves nothing behind.
+    bool threw = false;
+    try {
+        cache.get("bad", [](const std::string&) -> int { throw std::runtime_error("down"); });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(cache.getIfPresent("bad") == nullptr);
+
+    LoadingCacheStats stats = cache.getStats();
+    assert(stats.hits == 2);
+    assert(stats.loads == 3);
+    assert(stats.early_refreshes == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRefreshRule() {
+    std::cout << "Test 2: Early Refresh Rule" << std::endl;
+    using Cache = LoadingCache<int, int>;
+    nanoseconds load = milliseconds(10);
+
+    // Disabled: never refreshes, however close to expiry.
+    assert(!Cache::shouldRefreshEarly(nanoseconds(1), load, 0.0, 1e-9));
+
+    // The chance of refreshing, exp(-remaining / (load * beta)), rises as
+    // expiry nears and with slower loads.
+    auto rate = [](nanoseconds remaining, nanoseconds load_time, double beta) {
+        int refreshes = 0;
+        for (int i = 1; i <= 10000; i++) {
+            double u = i / 10000.0;
+            refreshes += Cache::shouldRefreshEarly(remaining, load_time, beta, u);
+        }
+        return refreshes / 10000.0;
+    };
+    assert(rate(milliseconds(100), load, 1.0) < 0.001);
+    assert(rate(milliseconds(10), load, 1.0) > 0.3 && rate(milliseconds(10), load, 1.0) < 0.4);
+    assert(rate(milliseconds(1), load, 1.0) > 0.9);
+    assert(rate(milliseconds(10), milliseconds(20), 1.0) > rate(milliseconds(10), load, 1.0));
+    assert(rate(milliseconds(10), load, 2.0) > rate(milliseconds(10), load, 1.0));
+    // A load that took no time never refreshes early.
+    assert(rate(milliseconds(1), nanoseconds(0), 1.0) == 0.0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testHotKeyNeverExpires() {
+    std::cout << "Test 3: Early Refresh Keeps a Hot Key Fresh" << std::endl;
+    using Cache = LoadingCache<int, int, std::hash<int>, FakeClock>;
+    auto loader = [](int key) {
+        FakeClock::advance(milliseconds(10));
+        return key;
+    };
+    // One get per millisecond for 350 ms; returns the number of gets.
+    auto run = [&loader](Cache& cache) {
+        FakeClock::current = FakeClock::time_point{};
+        cache.get(1, loader);  // loads in [0, 10] ms, expires at 110 ms
+        int gets = 0;
+        while (FakeClock::now() < FakeClock::time_point{} + milliseconds(350)) {
+            FakeClock::advance(milliseconds(1));
+            assert(*cache.get(1, loader) == 1);
+            gets++;
+        }
+        return gets;
+    };
+
+    LoadingCacheConfig config;
+    config.ttl = milliseconds(100);
+    config.early_refresh_beta = 1.0;
+    // -ln(u) = 1.55: every hit refreshes once 15.5 ms or less remain.
+    config.uniform = []() { return std::exp(-1.55); };
+    Cache early(10, 1, config);
+    int gets = run(early);
+    LoadingCacheStats stats = early.getStats();
+    // Refreshes at 95, 190 and 285 ms, each 15 ms before expiry; the next
+    // would be at 380 ms.
+    assert(stats.loads == 1);  // only the first miss; never expired
+    assert(stats.early_refreshes == 3);
+    assert(stats.hits == static_cast<std::uint64_t>(gets) - 3);
+
+    // u = 1 never refreshes early, so the key expires at 110, 220 and 330 ms.
+    config.uniform = []() { return 1.0; };
+    Cache late(10, 1, config);
+    run(late);
+    stats = late.getStats();
+    assert(stats.loads == 4);
+    assert(stats.early_refreshes == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testConcurrentCallers() {
+    std::cout << "Test 4: Concurrent Callers Load and Refresh One Key" << std::endl;
+    LoadingCacheConfig config;
+    config.ttl = milliseconds(20);
+    config.early_refresh_beta = 1.0;
+    LoadingCache<int, int> cache(100, 4, config);
+    auto loader = [](int key) {
+        std::this_thread::sleep_for(milliseconds(1));
+        return key * 2;
+    };
+
+    std::atomic<std::uint64_t> gets{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache, &loader, &gets]() {
+            for (int i = 0; i < 200; i++) {
+                assert(*cache.get(7, loader) == 14);
+                gets++;
+                std::this_thread::sleep_for(microseconds(500));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // Every get is counted exactly once, whatever the timing.
+    LoadingCacheStats stats = cache.getStats();
+    assert(stats.hits + stats.loads + stats.early_refreshes == gets);
+    assert(stats.loads >= 1);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Loading Cache Tests...\n" << std::endl;
+
+    testLoadAndExpiry();
+    testRefreshRule();
+    testHotKeyNeverExpires();
+    testConcurrentCallers();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
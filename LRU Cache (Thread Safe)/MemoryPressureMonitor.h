@@ -0,0 +1,303 @@
+#ifndef MEMORY_PRESSURE_MONITOR_H
+#define MEMORY_PRESSURE_MONITOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Settings for MemoryPressureMonitor.
+ */
+struct MemoryPressureConfig {
+    // Linux PSI file; pressure when "some avg10" reaches psi_threshold percent.
+    // Empty to ignore PSI.
+    std::string psi_path = "/proc/pressure/memory";
+    double psi_threshold = 10.0;
+    // cgroup v2 memory.events file, e.g. /sys/fs/cgroup/memory.events;
+    // pressure when its "high" or "max" count rose since the last poll.
+    // Empty to ignore.
+    std::string events_path;
+
+    std::chrono::milliseconds poll_interval{1000};
+    double shrink_step = 0.1;         // capacity fraction removed per pressured poll
+    double grow_step = 0.05;          // capacity fraction restored per calm poll
+    double min_fraction = 0.5;        // never shrink below this fraction of the original
+    int calm_polls = 5;               // calm polls in a row before restoring starts
+    int evictions_per_poll = 4096;    // per cache (per shard if sharded), 64 per lock hold
+};
+
+/**
+ * Counters reported by MemoryPressureMonitor::getStats().
+ */
+struct MemoryPressureStats {
+    double level = 1.0;                 // current capacity fraction applied to every cache
+    std::uint64_t polls = 0;
+    std::uint64_t pressured_polls = 0;
+    std::uint64_t evictions = 0;        // entries trimmed by the monitor
+};
+
+/**
+ * Shrinks registered caches while the host or cgroup is under memory
+ * pressure and restores them once it subsides.
+ *
+ * Every poll reads the pressure signals. Under pressure the level (a
+ * fraction of each cache's original capacity) drops by shrink_step, down to
+ * min_fraction; after calm_polls calm polls in a row it rises by grow_step
+ * per poll back to 1. Each level change calls setCapacity() on every cache.
+ *
+ * Shrinking is incremental: setCapacity() only lowers the limit, and the
+ * monitor then trims at most evictions_per_poll entries per cache per poll
+ * with trimToCapacity(), which takes the cache lock for 64 evictions at a
+ * time. Readers and writers interleave with the trimming, and the cache's
+ * own operations evict the rest a batch at a time.
+ *
+ * Registered caches must outlive the monitor or be unregistered first. The
+ * monitor owns the capacity of registered caches: changes made by others
+ * are overwritten at the next level change.
+ */
+class MemoryPressureMonitor {
+private:
+    struct Registration {
+        int id;
+        int base_capacity;
+        std::function<void(int)> set_capacity;
+        std::function<int(int)> trim;  // returns entries still over capacity
+    };
+
+    MemoryPressureConfig config_;
+    mutable std::mutex lock_;
+    std::condition_variable stop_cv_;
+    std::vector<Registration> caches_;
+    int next_id_ = 0;
+    double level_ = 1.0;
+    int calm_streak_ = 0;
+    std::uint64_t last_events_ = 0;
+    bool events_seen_ = false;
+    MemoryPressureStats stats_;
+    bool stop_ = false;
+    std::thread poller_;
+
+    static int scaled(int base, double level) {
+        return std::max(1, static_cast<int>(base * level));
+    }
+
+    bool psiPressure() const {
+        if (config_.psi_path.empty()) {
+            return false;
+        }
+        std::ifstream in(config_.psi_path);
+        std::string line;
+        while (std::getline(in, line)) {
+            // some avg10=1.23 avg60=0.50 avg300=0.10 total=12345
+            if (line.rfind("some ", 0) != 0) {
+                continue;
+            }
+            std::size_t pos = line.find("avg10=");
+            if (pos != std::string::npos) {
+                return std::stod(line.substr(pos + 6)) >= config_.psi_threshold;
+            }
+        }
+        return false;
+    }
+
+    bool eventsPressure() {
+        if (config_.events_path.empty()) {
+            return false;
+        }
+        std::ifstream in(config_.events_path);
+        std::string name;
+        std::uint64_t count;
+        std::uint64_t total = 0;
+        bool found = false;
+        while (in >> name >> count) {
+            if (name == "high" || name == "max") {
+                total += count;
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        bool rose = events_seen_ && total > last_events_;
+        last_events_ = total;
+        events_seen_ = true;
+        return rose;
+    }
+
+    void applyLevel() {
+        for (const Registration& cache : caches_) {
+            cache.set_capacity(scaled(cache.base_capacity, level_));
+        }
+    }
+
+    void pollLoop() {
+        std::unique_lock<std::mutex> guard(lock_);
+        while (!stop_) {
+            guard.unlock();
+            poll();
+            guard.lock();
+            stop_cv_.wait_for(guard, config_.poll_interval, [this]() { return stop_; });
+        }
+    }
+
+public:
+    /**
+     * Initializes a monitor. Nothing is read until poll() or start().
+     *
+     * @param config Pressure sources, steps and limits
+     * @throws std::invalid_argument if a step or min_fraction is outside
+     *         (0, 1], or calm_polls, evictions_per_poll or poll_interval <= 0
+     */
+    explicit MemoryPressureMonitor(const MemoryPressureConfig& config = MemoryPressureConfig())
+        : config_(config) {
+        auto fraction = [](double f) { return f > 0.0 && f <= 1.0; };
+        if (!fraction(config.shrink_step) || !fraction(config.grow_step) ||
+            !fraction(config.min_fraction)) {
+            throw std::invalid_argument("Steps and minimum fraction must be in (0, 1]");
+        }
+        if (config.calm_polls <= 0 || config.evictions_per_poll <= 0 ||
+            config.poll_interval.count() <= 0) {
+            throw std::invalid_argument("Calm polls, evictions and interval must be greater than 0");
+        }
+    }
+
+    MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+    MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    /**
+     * Stops polling. Registered caches keep their current capacity.
+     */
+    ~MemoryPressureMonitor() {
+        stop();
+    }
+
+    /**
+     * Registers a cache with setCapacity(), getCapacity() and
+     * trimToCapacity(), such as LRUCache or ShardedLRUCache. Its current
+     * capacity is taken as the original and scaled to the current level.
+     *
+     * @param cache The cache; must outlive the monitor or be unregistered
+     * @return An id for unregisterCache()
+     */
+    template <typename Cache>
+    int registerCache(Cache& cache) {
+        std::lock_guard<std::mutex> guard(lock_);
+        Registration registration{next_id_++, cache.getCapacity(),
+                                  [&cache](int capacity) { cache.setCapacity(capacity); },
+                                  [&cache](int max_evictions) { return cache.trimToCapacity(max_evictions); }};
+        registration.set_capacity(scaled(registration.base_capacity, level_));
+        caches_.push_back(std::move(registration));
+        return caches_.back().id;
+    }
+
+    /**
+     * Stops managing a cache and gives it back its original capacity.
+     *
+     * @param id The id returned by registerCache()
+     * @return true if the cache was registered
+     */
+    bool unregisterCache(int id) {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = std::find_if(caches_.begin(), caches_.end(),
+                               [id](const Registration& r) { return r.id == id; });
+        if (it == caches_.end()) {
+            return false;
+        }
+        it->set_capacity(it->base_capacity);
+        caches_.erase(it);
+        return true;
+    }
+
+    /**
+     * Reads the pressure signals once, adjusts the level and trims. start()
+     * calls this every poll_interval; call it directly to drive the monitor
+     * from an existing maintenance loop instead.
+     *
+     * @return true if memory was under pressure
+     */
+    bool poll() {
+        std::lock_guard<std::mutex> guard(lock_);
+        bool pressure = psiPressure();
+        pressure = eventsPressure() || pressure;  // always read, to track the counter
+        stats_.polls++;
+        double level = level_;
+        if (pressure) {
+            stats_.pressured_polls++;
+            calm_streak_ = 0;
+            level = std::max(config_.min_fraction, level_ - config_.shrink_step);
+        } else if (++calm_streak_ >= config_.calm_polls) {
+            level = std::min(1.0, level_ + config_.grow_step);
+        }
+        if (level != level_) {
+            level_ = level;
+            applyLevel();
+        }
+        for (const Registration& cache : caches_) {
+            int budget = config_.evictions_per_poll;
+            int before = cache.trim(0);  // only reads the excess
+            while (budget > 0 && before > 0) {
+                int batch = std::min(budget, 64);
+                int after = cache.trim(batch);
+                // Concurrent writers move the excess too; count only shrinkage.
+                stats_.evictions += static_cast<std::uint64_t>(std::max(0, before - after));
+                if (after >= before) {
+                    break;
+                }
+                before = after;
+                budget -= batch;
+            }
+        }
+        stats_.level = level_;
+        return pressure;
+    }
+
+    /**
+     * Starts polling on a background thread.
+     *
+     * @throws std::logic_error if already started
+     */
+    void start() {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (poller_.joinable()) {
+            throw std::logic_error("Memory pressure monitor is already running");
+        }
+        stop_ = false;
+        poller_ = std::thread([this]() { pollLoop(); });
+    }
+
+    /**
+     * Stops the background thread, if running.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            if (!poller_.joinable()) {
+                return;
+            }
+            stop_ = true;
+        }
+        stop_cv_.notify_one();
+        poller_.join();
+    }
+
+    /**
+     * Returns the current level and counters.
+     *
+     * @return A snapshot of the stats
+     */
+    MemoryPressureStats getStats() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return stats_;
+    }
+};
+
+#endif // MEMORY_PRESSURE_MONITOR_H
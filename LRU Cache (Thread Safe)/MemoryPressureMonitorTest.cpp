@@ -0,0 +1,248 @@
+#include "MemoryPressureMonitor.h"
+#include "ShardedLRUCache.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+/**
+ * Test cases for MemoryPressureMonitor.
+ *
+ * Tests cover:
+ * - Shrinking under PSI pressure, trimmed incrementally
+ * - Restoring capacity once pressure subsides
+ * - cgroup memory.events as the signal
+ * - Background polling and unregistering
+ * - One read of each cache's excess per poll, not one per batch
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread MemoryPressureMonitorTest.cpp -o memory_pressure_monitor_test
+ */
+
+namespace {
+
+const std::string kPsiPath = "/tmp/memory_pressure_test.psi";
+const std::string kEventsPath = "/tmp/memory_pressure_test.events";
+
+void writePsi(double some_avg10) {
+    std::ofstream out(kPsiPath, std::ios::trunc);
+    out << "some avg10=" << some_avg10 << " avg60=0.00 avg300=0.00 total=100\n"
+        << "full avg10=0.00 avg60=0.00 avg300=0.00 total=10\n";
+}
+
+void writeEvents(int high, int max) {
+    std::ofstream out(kEventsPath, std::ios::trunc);
+    out << "low 0\nhigh " << high << "\nmax " << max << "\noom 0\noom_kill 0\n";
+}
+
+MemoryPressureConfig psiConfig() {
+    MemoryPressureConfig config;
+    config.psi_path = kPsiPath;
+    config.shrink_step = 0.25;
+    config.grow_step = 0.25;
+    config.min_fraction = 0.5;
+    config.calm_polls = 2;
+    config.evictions_per_poll = 1000;
+    return config;
+}
+
+/**
+ * A cache that only counts: size entries against a capacity, and the
+ * trimToCapacity() calls made on it.
+ */
+struct CountingCache {
+    int capacity = 0;
+    int size = 0;
+    int trims = 0;
+    int reads = 0;  // trimToCapacity(0) calls
+
+    int getCapacity() const { return capacity; }
+
+    void setCapacity(int c) { capacity = c; }
+
+    int trimToCapacity(int max_evictions) {
+        trims++;
+        reads += max_evictions == 0;
+        size -= std::min(max_evictions, std::max(0, size - capacity));
+        return std::max(0, size - capacity);
+    }
+};
+
+} // namespace
+
+void testShrinkUnderPressure() {
+    std::cout << "Test 1: Shrink Under PSI Pressure" << std::endl;
+    LRUCache<int, int> cache(10000);
+    for (int i = 0; i < 10000; i++) {
+        cache.put(i, i);
+    }
+    MemoryPressureMonitor monitor(psiConfig());
+    monitor.registerCache(cache);
+
+    writePsi(2.5);  // below the 10% threshold
+    assert(!monitor.poll());
+    assert(cache.getCapacity() == 10000);
+
+    writePsi(42.0);
+    assert(monitor.poll());
+    assert(cache.getCapacity() == 7500);
+    // setCapacity() evicts one batch of 64, then the monitor trims at most
+    // evictions_per_poll per poll.
+    assert(cache.size() == 10000 - 64 - 1000);
+    assert(monitor.poll());
+    assert(cache.getCapacity() == 5000);
+    assert(cache.size() == 10000 - 2 * (64 + 1000));
+    assert(monitor.poll());
+    assert(cache.getCapacity() == 5000);  // min_fraction
+    for (int i = 0; i < 5; i++) {
+        monitor.poll();
+    }
+    assert(cache.size() == 5000);
+    assert(cache.get(9999) != nullptr);  // the most recent entries stay
+    assert(cache.get(0) == nullptr);
+
+    MemoryPressureStats stats = monitor.getStats();
+    assert(stats.level == 0.5);
+    assert(stats.pressured_polls == 8);
+    assert(stats.evictions == 5000 - 2 * 64);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRestoreAfterPressure() {
+    std::cout << "Test 2: Restore Capacity When Pressure Subsides" << std::endl;
+    ShardedLRUCache<int, int> cache(8000, 4);
+    MemoryPressureMonitor monitor(psiConfig());
+    monitor.registerCache(cache);
+
+    writePsi(50.0);
+    monitor.poll();
+    monitor.poll();
+    assert(cache.getCapacity() == 4000);
+
+    writePsi(0.0);
+    monitor.poll();
+    assert(cache.getCapacity() == 4000);  // one calm poll is not enough
+    monitor.poll();
+    assert(cache.getCapacity() == 6000);
+    writePsi(50.0);
+    monitor.poll();  // pressure again resets the calm streak
+    assert(cache.getCapacity() == 4000);
+    writePsi(0.0);
+    for (int i = 0; i < 4; i++) {
+        monitor.poll();
+    }
+    assert(cache.getCapacity() == 8000);
+    assert(monitor.getStats().level == 1.0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testCgroupEvents() {
+    std::cout << "Test 3: cgroup memory.events Signal" << std::endl;
+    MemoryPressureConfig config = psiConfig();
+    config.psi_path.clear();
+    config.events_path = kEventsPath;
+    LRUCache<int, int> cache(1000);
+    MemoryPressureMonitor monitor(config);
+    monitor.registerCache(cache);
+
+    writeEvents(7, 0);
+    assert(!monitor.poll());  // the first read is only a baseline
+    assert(!monitor.poll());
+    writeEvents(9, 0);
+    assert(monitor.poll());
+    assert(cache.getCapacity() == 750);
+    assert(!monitor.poll());
+    writeEvents(9, 1);
+    assert(monitor.poll());
+    assert(cache.getCapacity() == 500);
+
+    // A missing file is no signal, not an error.
+    MemoryPressureConfig missing;
+    missing.psi_path = "/nonexistent/pressure";
+    missing.events_path = "/nonexistent/memory.events";
+    MemoryPressureMonitor idle(missing);
+    assert(!idle.poll());
+
+    bool threw = false;
+    try {
+        MemoryPressureConfig bad;
+        bad.min_fraction = 0.0;
+        MemoryPressureMonitor invalid(bad);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testBackgroundPolling() {
+    std::cout << "Test 4: Background Polling and Unregistering" << std::endl;
+    MemoryPressureConfig config = psiConfig();
+    config.poll_interval = std::chrono::milliseconds(5);
+    LRUCache<int, int> cache(2000);
+    MemoryPressureMonitor monitor(config);
+    int id = monitor.registerCache(cache);
+
+    writePsi(80.0);
+    monitor.start();
+    std::thread writer([&cache]() {
+        for (int i = 0; i < 200000; i++) {
+            cache.put(i % 5000, i);
+            cache.get(i % 3000);
+        }
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cache.getCapacity() != 1000 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    writer.join();
+    assert(cache.getCapacity() == 1000);
+    monitor.stop();
+    monitor.stop();  // idempotent
+    assert(cache.size() <= 1000 + 64);
+
+    assert(monitor.unregisterCache(id));
+    assert(!monitor.unregisterCache(id));
+    assert(cache.getCapacity() == 2000);
+    std::remove(kPsiPath.c_str());
+    std::remove(kEventsPath.c_str());
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testExcessReadOncePerPoll() {
+    std::cout << "Test 5: Excess Read Once per Poll" << std::endl;
+    CountingCache cache{2000, 2000};
+    MemoryPressureMonitor monitor(psiConfig());
+    monitor.registerCache(cache);
+
+    writePsi(42.0);
+    assert(monitor.poll());
+    assert(cache.capacity == 1500 && cache.size == 1500);
+    // 500 over: one read, then batches of 64 until the excess is gone.
+    assert(cache.reads == 1);
+    assert(cache.trims == 1 + 8);
+    assert(monitor.getStats().evictions == 500);
+
+    writePsi(2.5);
+    cache.trims = cache.reads = 0;
+    assert(!monitor.poll());
+    assert(cache.reads == 1 && cache.trims == 1);  // nothing over capacity
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Memory Pressure Monitor Tests...\n" << std::endl;
+
+    testShrinkUnderPressure();
+    testRestoreAfterPressure();
+    testCgroupEvents();
+    testBackgroundPolling();
+    testExcessReadOncePerPoll();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,284 @@
+#ifndef MISS_RATIO_SAMPLER_H
+#define MISS_RATIO_SAMPLER_H
+
+#include "../Metrics/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Settings for MissRatioSampler.
+ */
+struct MissRatioConfig {
+    double sampling_rate = 0.01;     // initial fraction of keys sampled, in (0, 1]
+    std::size_t max_keys = 8192;     // sampled keys kept; the rate drops to stay under it
+};
+
+/**
+ * One point of a miss-ratio curve.
+ */
+struct MissRatioPoint {
+    std::size_t capacity;  // entries
+    double miss_ratio;     // estimated LRU miss ratio at that capacity
+};
+
+/**
+ * Online LRU miss-ratio curve estimation by spatial sampling (SHARDS).
+ *
+ * A key is sampled when its mixed hash falls below a threshold, so every
+ * access to a sampled key is seen and every access to any other key costs
+ * one comparison. For sampled accesses the sampler computes the reuse
+ * distance among sampled keys (distinct sampled keys touched since the
+ * key's previous access), scales it by 1 / rate to estimate the distance
+ * among all keys, and adds it to a histogram with the same log-linear
+ * buckets as Metrics' Histogram. An LRU cache of capacity C hits exactly
+ * the accesses with reuse distance < C, so the histogram gives the miss
+ * ratio at every capacity at once.
+ *
+ * Memory is bounded by max_keys: when more keys are sampled, the one with
+ * the largest hash is dropped and the threshold lowered to it (fixed-size
+ * SHARDS). Each access is weighted by 1 / rate at the time it was seen, so
+ * histogram counts stay comparable as the rate falls.
+ *
+ * Reuse distances come from a Fenwick tree over access times holding one
+ * mark per sampled key at its last access; times are renumbered when the
+ * tree fills.
+ *
+ * Time Complexity:
+ * - offer: O(1) when not sampled, O(log max_keys) amortized when sampled
+ * - curve: O(buckets + capacities)
+ *
+ * Space Complexity: O(max_keys)
+ */
+class MissRatioSampler {
+private:
+    static constexpr std::uint64_t kModulus = std::uint64_t{1} << 24;
+    static constexpr int kBucketCount = Histogram::kBucketCount;
+
+    MissRatioConfig config_;
+    std::atomic<std::uint64_t> threshold_;  // sample when spatialHash < threshold_
+    mutable std::mutex lock_;
+    std::unordered_map<std::uint64_t, std::uint32_t> last_access_;  // sampled key -> time
+    std::priority_queue<std::pair<std::uint32_t, std::uint64_t>> by_hash_;  // (spatialHash, key)
+    std::vector<std::uint32_t> tree_;  // Fenwick tree over times 1..tree_.size()-1
+    std::uint32_t now_ = 0;
+    std::vector<double> histogram_;    // weighted references by estimated reuse distance
+    double total_ = 0;                 // weighted references, first accesses included
+    std::uint64_t samples_ = 0;
+
+    static std::uint32_t spatialHash(std::size_t hash) {
+        // Fibonacci hashing: one multiply, top 24 bits.
+        return static_cast<std::uint32_t>((hash * 0x9e3779b97f4a7c15ULL) >> 40);
+    }
+
+    void treeAdd(std::uint32_t time, int delta) {
+        for (; time < tree_.size(); time += time & (~time + 1)) {
+            tree_[time] += delta;
+        }
+    }
+
+    std::uint32_t treeSum(std::uint32_t time) const {
+        std::uint32_t sum = 0;
+        for (; time > 0; time -= time & (~time + 1)) {
+            sum += tree_[time];
+        }
+        return sum;
+    }
+
+    /**
+     * Renumbers last-access times 1..n in order and rebuilds the tree.
+     */
+    void compactTimes() {
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> order;
+        order.reserve(last_access_.size());
+        for (const auto& entry : last_access_) {
+            order.emplace_back(entry.second, entry.first);
+        }
+        std::sort(order.begin(), order.end());
+        std::fill(tree_.begin(), tree_.end(), 0);
+        now_ = 0;
+        for (const auto& entry : order) {
+            last_access_[entry.second] = ++now_;
+            treeAdd(now_, 1);
+        }
+    }
+
+    /**
+     * Drops the sampled keys with the largest hashes until max_keys remain,
+     * lowering the threshold so they are not sampled again.
+     */
+    void shrink() {
+        while (last_access_.size() > config_.max_keys) {
+            std::uint32_t cut = by_hash_.top().first;
+            while (!by_hash_.empty() && by_hash_.top().first >= cut) {
+                std::uint64_t key = by_hash_.top().second;
+                by_hash_.pop();
+                auto it = last_access_.find(key);
+                treeAdd(it->second, -1);
+                last_access_.erase(it);
+            }
+            threshold_.store(cut, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    /**
+     * Initializes a sampler.
+     *
+     * @param config Initial sampling rate and key bound
+     * @throws std::invalid_argument if sampling_rate is not in (0, 1] or
+     *         max_keys is 0
+     */
+    explicit MissRatioSampler(const MissRatioConfig& config = MissRatioConfig())
+        : config_(config), histogram_(kBucketCount, 0.0) {
+        if (!(config.sampling_rate > 0.0 && config.sampling_rate <= 1.0)) {
+            throw std::invalid_argument("Sampling rate must be in (0, 1]");
+        }
+        if (config.max_keys == 0) {
+            throw std::invalid_argument("Sampled key bound must be greater than 0");
+        }
+        threshold_.store(std::max<std::uint64_t>(1, static_cast<std::uint64_t>(
+                             config.sampling_rate * kModulus)), std::memory_order_relaxed);
+        tree_.assign(4 * config.max_keys + 2, 0);
+        last_access_.reserve(config.max_keys + 1);
+    }
+
+    /**
+     * Reports one access. Only accesses to sampled keys do any work.
+     *
+     * @param hash The key's hash (remixed here, so identity hashes will do)
+     */
+    void offer(std::size_t hash) {
+        std::uint64_t h = hash;
+        std::uint32_t mod = spatialHash(hash);
+        if (mod >= threshold_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        std::uint64_t threshold = threshold_.load(std::memory_order_relaxed);
+        if (mod >= threshold) {
+            return;
+        }
+        double rate = static_cast<double>(threshold) / kModulus;
+        double weight = 1.0 / rate;
+        samples_++;
+        total_ += weight;
+
+        if (now_ + 1 >= tree_.size()) {
+            compactTimes();
+        }
+        std::uint32_t time = ++now_;
+        auto it = last_access_.find(h);
+        if (it == last_access_.end()) {
+            last_access_.emplace(h, time);
+            by_hash_.emplace(mod, h);
+            treeAdd(time, 1);
+            shrink();
+            return;
+        }
+        std::uint32_t distance = treeSum(time - 1) - treeSum(it->second);
+        histogram_[Histogram::bucketIndex(static_cast<std::uint64_t>(distance / rate))] += weight;
+        treeAdd(it->second, -1);
+        treeAdd(time, 1);
+        it->second = time;
+    }
+
+    /**
+     * Estimates the LRU miss ratio at each capacity.
+     *
+     * @param capacities Capacities in entries
+     * @return One point per capacity, in the given order; miss ratios are 1
+     *         before any sampled access
+     */
+    std::vector<MissRatioPoint> curve(const std::vector<std::size_t>& capacities) const {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::vector<MissRatioPoint> points;
+        for (std::size_t capacity : capacities) {
+            double hits = 0;
+            for (int i = 0; i < kBucketCount; i++) {
+                if (histogram_[i] == 0.0) {
+                    continue;
+                }
+                std::uint64_t lo = Histogram::bucketLowerBound(i);
+                std::uint64_t hi = i + 1 < kBucketCount ? Histogram::bucketLowerBound(i + 1)
+                                                        : UINT64_MAX;
+                if (capacity >= hi) {
+                    hits += histogram_[i];
+                } else if (capacity > lo) {
+                    // Distances are spread evenly over the bucket.
+                    hits += histogram_[i] * static_cast<double>(capacity - lo) / (hi - lo);
+                } else {
+                    break;
+                }
+            }
+            points.push_back(MissRatioPoint{capacity, total_ > 0 ? 1.0 - hits / total_ : 1.0});
+        }
+        return points;
+    }
+
+    /**
+     * Estimates the miss-ratio curve at powers of two up to the largest
+     * reuse distance seen.
+     *
+     * @return Points for capacities 1, 2, 4, ...
+     */
+    std::vector<MissRatioPoint> curve() const {
+        std::uint64_t largest = 1;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            for (int i = kBucketCount - 1; i >= 0; i--) {
+                if (histogram_[i] > 0.0) {
+                    largest = Histogram::bucketLowerBound(i + 1 < kBucketCount ? i + 1 : i);
+                    break;
+                }
+            }
+        }
+        std::vector<std::size_t> capacities;
+        for (std::uint64_t c = 1; c < largest * 2 && c != 0; c *= 2) {
+            capacities.push_back(static_cast<std::size_t>(c));
+        }
+        return curve(capacities);
+    }
+
+    /**
+     * Returns the current sampling rate, which only falls.
+     *
+     * @return The fraction of keys sampled
+     */
+    double samplingRate() const {
+        return static_cast<double>(threshold_.load(std::memory_order_relaxed)) / kModulus;
+    }
+
+    /**
+     * Returns the number of accesses that were sampled.
+     *
+     * @return The sampled access count
+     */
+    std::uint64_t sampledAccesses() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        return samples_;
+    }
+
+    /**
+     * Forgets all history, keeping the current sampling rate.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> guard(lock_);
+        last_access_.clear();
+        by_hash_ = {};
+        std::fill(tree_.begin(), tree_.end(), 0);
+        now_ = 0;
+        std::fill(histogram_.begin(), histogram_.end(), 0.0);
+        total_ = 0;
+        samples_ = 0;
+    }
+};
+
+#endif // MISS_RATIO_SAMPLER_H
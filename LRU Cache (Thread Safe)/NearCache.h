@@ -0,0 +1,246 @@
+#ifndef NEAR_CACHE_H
+#define NEAR_CACHE_H
+
+#include "ShardedLRUCache.h"
+#include "../Common/Hash.h"
+#include "../Common/ThreadSlot.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Settings for NearCache's per-thread caches.
+ */
+struct NearCacheConfig {
+    std::size_t sets = 256;  // power of two
+    std::size_t ways = 4;    // entries per set; sets * ways entries per thread
+};
+
+/**
+ * Counters reported by NearCache::getStats().
+ */
+struct NearCacheStats {
+    std::uint64_t near_hits = 0;        // served from the calling thread's own cache
+    std::uint64_t shared_lookups = 0;   // went to the shared cache
+};
+
+/**
+ * A ShardedLRUCache with a small set-associative cache per thread in front.
+ *
+ * A get() first looks in the calling thread's own cache, which no other
+ * thread touches, and only on a miss goes to the shared cache. Hot keys are
+ * then served without taking any shared lock.
+ *
+ * Staleness is bounded by epochs: every key maps to one of kEpochStripes
+ * counters, and put(), remove() and clear() bump the counters of the keys
+ * they change after changing the shared cache. A near entry remembers the
+ * counter value read before its shared lookup and is used only while the
+ * counter still has that value, so once a write has returned, every later
+ * get() on any thread sees it.
+ *
+ * Values are returned as shared_ptr<const V> shared with the near cache.
+ * All writes must go through this class; evictions in the shared cache do
+ * not invalidate near entries, which still hold the latest value.
+ *
+ * Each thread that calls get() gets its own near cache on first use, kept
+ * until the NearCache is destroyed.
+ *
+ * @tparam K The type of keys maintained by this cache
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class NearCache {
+private:
+    static constexpr std::size_t kEpochStripes = 1024;
+
+    struct Entry {
+        bool valid = false;
+        std::size_t hash = 0;
+        std::uint64_t epoch = 0;
+        std::uint64_t last_use = 0;
+        K key{};
+        std::shared_ptr<const V> value;
+    };
+
+    struct Local {
+        std::vector<Entry> entries;
+        std::uint64_t clock = 0;
+        std::atomic<std::uint64_t> hits{0};      // written by the owning thread only
+        std::atomic<std::uint64_t> lookups{0};
+    };
+
+    ShardedLRUCache<K, V, Hash> shared_;
+    NearCacheConfig config_;
+    ThreadSlot slot_;
+    std::array<std::atomic<std::uint64_t>, kEpochStripes> epochs_;
+    mutable std::mutex locals_lock_;
+    std::vector<std::unique_ptr<Local>> locals_;
+    Hash hasher_;
+
+    std::atomic<std::uint64_t>& epochFor(std::size_t hash) {
+        // Mixed, so keys with nearby hashes (std::hash of integers is the
+        // identity) spread over the stripes instead of sharing one.
+        return epochs_[fmix64(hash) % kEpochStripes];
+    }
+
+    Local& localCache() {
+        if (void* local = slot_.get()) {
+            return *static_cast<Local*>(local);
+        }
+        auto local = std::make_unique<Local>();
+        local->entries.resize(config_.sets * config_.ways);
+        std::lock_guard<std::mutex> guard(locals_lock_);
+        locals_.push_back(std::move(local));
+        slot_.set(locals_.back().get());
+        return *locals_.back();
+    }
+
+    static void bump(std::atomic<std::uint64_t>& epoch) {
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+public:
+    /**
+     * Initializes the shared cache and the near-cache settings.
+     *
+     * @param capacity The total number of entries in the shared cache
+     * @param shard_count The number of shards in the shared cache
+     * @param config Size of each thread's near cache
+     * @throws std::invalid_argument if capacity or shard_count <= 0, or sets
+     *         is not a power of two, or ways is 0
+     */
+    NearCache(int capacity, int shard_count, const NearCacheConfig& config = NearCacheConfig())
+        : shared_(capacity, shard_count), config_(config) {
+        if (config.sets == 0 || (config.sets & (config.sets - 1)) != 0) {
+            throw std::invalid_argument("Set count must be a power of two");
+        }
+        if (config.ways == 0) {
+            throw std::invalid_argument("Way count must be greater than 0");
+        }
+        for (auto& epoch : epochs_) {
+            epoch.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    NearCache(const NearCache&) = delete;
+    NearCache& operator=(const NearCache&) = delete;
+
+    /**
+     * Retrieves a value from the calling thread's near cache, or from the
+     * shared cache (marking it recently used there) and keeps it nearby.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to the value if found, nullptr otherwise
+     */
+    std::shared_ptr<const V> get(const K& key) {
+        std::size_t hash = hasher_(key);
+        std::uint64_t epoch = epochFor(hash).load(std::memory_order_acquire);
+        Local& local = localCache();
+        Entry* set = &local.entries[(hash & (config_.sets - 1)) * config_.ways];
+        Entry* victim = set;
+        local.clock++;
+        for (std::size_t w = 0; w < config_.ways; w++) {
+            Entry& entry = set[w];
+            if (entry.valid && entry.hash == hash && entry.key == key) {
+                if (entry.epoch == epoch) {
+                    entry.last_use = local.clock;
+                    local.hits.store(local.hits.load(std::memory_order_relaxed) + 1,
+                                     std::memory_order_relaxed);
+                    return entry.value;
+                }
+                victim = &entry;  // stale copy of this key: refill in place
+                break;
+            }
+            if (!entry.valid || (victim->valid && entry.last_use < victim->last_use)) {
+                victim = &entry;
+            }
+        }
+
+        local.lookups.store(local.lookups.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        std::shared_ptr<const V> value = shared_.get(key, hash);
+        if (!value) {
+            if (victim->valid && victim->hash == hash && victim->key == key) {
+                victim->valid = false;
+                victim->value.reset();
+            }
+            return nullptr;
+        }
+        victim->valid = true;
+        victim->hash = hash;
+        victim->key = key;
+        victim->epoch = epoch;  // read before the lookup, so any later write invalidates it
+        victim->last_use = local.clock;
+        victim->value = value;
+        return value;
+    }
+
+    /**
+     * Inserts or updates a key-value pair in the shared cache and
+     * invalidates every thread's near copy of it.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        std::size_t hash = hasher_(key);
+        shared_.put(key, hash, value);
+        bump(epochFor(hash));
+    }
+
+    /**
+     * Removes a key from the shared cache and invalidates near copies.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if the shared cache held the key
+     */
+    bool remove(const K& key) {
+        std::size_t hash = hasher_(key);
+        bool removed = shared_.remove(key, hash);
+        bump(epochFor(hash));
+        return removed;
+    }
+
+    /**
+     * Removes all entries and invalidates every near cache.
+     */
+    void clear() {
+        shared_.clear();
+        for (auto& epoch : epochs_) {
+            bump(epoch);
+        }
+    }
+
+    /**
+     * Returns the number of entries in the shared cache.
+     *
+     * @return The shared cache size
+     */
+    int size() const {
+        return shared_.size();
+    }
+
+    /**
+     * Returns near-cache hit and shared lookup counts across all threads.
+     *
+     * @return A snapshot of the counters
+     */
+    NearCacheStats getStats() const {
+        NearCacheStats stats;
+        std::lock_guard<std::mutex> guard(locals_lock_);
+        for (const auto& local : locals_) {
+            stats.near_hits += local->hits.load(std::memory_order_relaxed);
+            stats.shared_lookups += local->lookups.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+};
+
+#endif // NEAR_CACHE_H
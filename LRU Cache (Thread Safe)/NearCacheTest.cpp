@@ -0,0 +1,167 @@
+#include "NearCache.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for NearCache.
+ *
+ * Tests cover:
+ * - Repeated gets are served from the thread's near cache
+ * - put and remove are visible on every thread at once
+ * - Replacement within a set
+ * - No stale reads under concurrent writes
+ * - A write invalidating few near entries of other keys
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread NearCacheTest.cpp -o near_cache_test
+ */
+
+void testNearHits() {
+    std::cout << "Test 1: Repeated Gets Are Served Nearby" << std::endl;
+    NearCache<std::string, int> cache(100, 4);
+    cache.put("a", 1);
+    for (int i = 0; i < 10; i++) {
+        assert(*cache.get("a") == 1);
+    }
+    NearCacheStats stats = cache.getStats();
+    assert(stats.shared_lookups == 1);
+    assert(stats.near_hits == 9);
+
+    assert(cache.get("missing") == nullptr);
+    assert(cache.get("missing") == nullptr);  // misses are not cached
+    assert(cache.getStats().shared_lookups == 3);
+
+    bool threw = false;
+    try {
+        NearCacheConfig config;
+        config.sets = 3;
+        NearCache<int, int> invalid(10, 1, config);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testWritesInvalidate() {
+    std::cout << "Test 2: Writes Are Visible on Every Thread" << std::endl;
+    NearCache<int, int> cache(100, 4);
+    cache.put(1, 10);
+    assert(*cache.get(1) == 10);
+
+    std::thread other([&cache]() {
+        assert(*cache.get(1) == 10);  // now near on this thread too
+        cache.put(1, 11);
+    });
+    other.join();
+    assert(*cache.get(1) == 11);
+
+    std::thread remover([&cache]() {
+        assert(cache.remove(1));
+    });
+    remover.join();
+    assert(cache.get(1) == nullptr);
+
+    cache.put(2, 20);
+    assert(*cache.get(2) == 20);
+    cache.clear();
+    assert(cache.get(2) == nullptr);
+    assert(cache.size() == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSetReplacement() {
+    std::cout << "Test 3: Replacement Within a Set" << std::endl;
+    NearCacheConfig config;
+    config.sets = 1;
+    config.ways = 2;
+    NearCache<int, int> cache(100, 1, config);
+    for (int k = 0; k < 3; k++) {
+        cache.put(k, k);
+    }
+    cache.get(0);
+    cache.get(1);
+    cache.get(0);  // 1 is now the least recently used way
+    cache.get(2);  // replaces 1
+    std::uint64_t lookups = cache.getStats().shared_lookups;
+    cache.get(0);
+    cache.get(2);
+    assert(cache.getStats().shared_lookups == lookups);
+    cache.get(1);
+    assert(cache.getStats().shared_lookups == lookups + 1);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testNoStaleReads() {
+    std::cout << "Test 4: No Stale Reads Under Concurrent Writes" << std::endl;
+    NearCache<int, int> cache(1000, 8);
+    constexpr int kKeys = 16;
+    std::vector<std::atomic<int>> published(kKeys);
+    for (int k = 0; k < kKeys; k++) {
+        cache.put(k, 0);
+        published[k] = 0;
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                for (int k = 0; k < kKeys; k++) {
+                    // A get that starts after put(k, v) returned must see v or newer.
+                    int floor = published[k].load();
+                    auto value = cache.get(k);
+                    assert(value != nullptr && *value >= floor);
+                }
+            }
+        });
+    }
+    for (int v = 1; v <= 20000; v++) {
+        int k = v % kKeys;
+        cache.put(k, v);
+        published[k] = v;
+    }
+    stop = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    assert(cache.getStats().near_hits > 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testEpochStripesSpread() {
+    std::cout << "Test 5: A Write Invalidates Few Other Keys" << std::endl;
+    // std::hash<int> is the identity, so these keys have adjacent hashes.
+    NearCache<int, int> cache(1000, 4);
+    for (int i = 0; i < 100; i++) {
+        cache.put(i, i);
+    }
+    for (int i = 0; i < 100; i++) {
+        cache.get(i);
+    }
+    std::uint64_t before = cache.getStats().near_hits;
+    cache.put(100, 100);  // bumps one stripe
+    for (int i = 0; i < 100; i++) {
+        assert(*cache.get(i) == i);
+    }
+    // Only keys sharing the write's stripe go back to the shared cache.
+    assert(cache.getStats().near_hits - before >= 97);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Near Cache Tests...\n" << std::endl;
+
+    testNearHits();
+    testWritesInvalidate();
+    testSetReplacement();
+    testNoStaleReads();
+    testEpochStripesSpread();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,211 @@
+#ifndef READ_MOSTLY_CACHE_H
+#define READ_MOSTLY_CACHE_H
+
+#include "EpochManager.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Copy-on-write key-value cache for data that is read constantly and
+ * written rarely, such as configuration or feature flags.
+ *
+ * The entries live in an immutable snapshot published through an atomic
+ * pointer. A reader pins an epoch, loads the pointer and looks the key up:
+ * it takes no lock and writes no shared cache line. A writer copies the
+ * current snapshot, applies its change, publishes the copy and retires the
+ * old snapshot to an EpochManager, which frees it once no reader can still
+ * be using it.
+ *
+ * Writes cost O(size) and are serialized by a mutex, so batch them with
+ * update() where possible. There is no capacity or eviction: the data set
+ * is expected to be small and fully resident.
+ *
+ * Time Complexity:
+ * - get / read / containsKey: O(1), lock-free
+ * - put / remove / update / clear: O(size)
+ *
+ * @tparam K The type of keys maintained by this cache
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ReadMostlyCache {
+public:
+    using Map = std::unordered_map<K, V, Hash>;
+
+private:
+    struct Snapshot {
+        Map entries;
+        std::uint64_t version;
+    };
+
+    mutable EpochManager epochs_;
+    std::atomic<const Snapshot*> current_;
+    std::mutex write_lock_;
+
+    /**
+     * Publishes a new snapshot and retires the old one. Caller holds
+     * write_lock_.
+     */
+    void publish(Map entries) {
+        const Snapshot* old = current_.load(std::memory_order_relaxed);
+        current_.store(new Snapshot{std::move(entries), old->version + 1}, std::memory_order_seq_cst);
+        epochs_.retire(const_cast<Snapshot*>(old));
+        epochs_.collect();
+    }
+
+public:
+    ReadMostlyCache() : current_(new Snapshot{Map(), 0}) {}
+
+    ReadMostlyCache(const ReadMostlyCache&) = delete;
+    ReadMostlyCache& operator=(const ReadMostlyCache&) = delete;
+
+    ~ReadMostlyCache() {
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Retrieves a copy of the value associated with the given key.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to a copy of the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key) const {
+        auto guard = epochs_.pin();
+        const Snapshot* snapshot = current_.load(std::memory_order_seq_cst);
+        auto it = snapshot->entries.find(key);
+        if (it == snapshot->entries.end()) {
+            return nullptr;
+        }
+        return std::make_shared<V>(it->second);
+    }
+
+    /**
+     * Calls fn with a reference to the value in place, without copying it.
+     * The reference is valid only during the call.
+     *
+     * @param key The key whose value is to be read
+     * @param fn Called as fn(const V&) if the key is present
+     * @return true if the key was present
+     */
+    template <typename F>
+    bool read(const K& key, F&& fn) const {
+        auto guard = epochs_.pin();
+        const Snapshot* snapshot = current_.load(std::memory_order_seq_cst);
+        auto it = snapshot->entries.find(key);
+        if (it == snapshot->entries.end()) {
+            return false;
+        }
+        fn(it->second);
+        return true;
+    }
+
+    /**
+     * Checks whether the given key is present.
+     *
+     * @param key The key to check
+     * @return true if the key is present, false otherwise
+     */
+    bool containsKey(const K& key) const {
+        auto guard = epochs_.pin();
+        const Snapshot* snapshot = current_.load(std::memory_order_seq_cst);
+        return snapshot->entries.find(key) != snapshot->entries.end();
+    }
+
+    /**
+     * Inserts or updates a key-value pair.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        update([&key, &value](Map& entries) { entries[key] = value; });
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        std::lock_guard<std::mutex> guard(write_lock_);
+        const Snapshot* snapshot = current_.load(std::memory_order_relaxed);
+        if (snapshot->entries.find(key) == snapshot->entries.end()) {
+            return false;
+        }
+        Map entries = snapshot->entries;
+        entries.erase(key);
+        publish(std::move(entries));
+        return true;
+    }
+
+    /**
+     * Applies any number of changes as one new snapshot. Readers see either
+     * none or all of them.
+     *
+     * @param fn Called as fn(Map&) on a private copy of the entries
+     */
+    template <typename F>
+    void update(F&& fn) {
+        std::lock_guard<std::mutex> guard(write_lock_);
+        Map entries = current_.load(std::memory_order_relaxed)->entries;
+        fn(entries);
+        publish(std::move(entries));
+    }
+
+    /**
+     * Removes all entries.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> guard(write_lock_);
+        publish(Map());
+    }
+
+    /**
+     * Returns the number of entries in the current snapshot.
+     *
+     * @return The current size
+     */
+    int size() const {
+        auto guard = epochs_.pin();
+        return static_cast<int>(current_.load(std::memory_order_seq_cst)->entries.size());
+    }
+
+    /**
+     * Checks whether the cache is empty.
+     *
+     * @return true if the cache contains no entries, false otherwise
+     */
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the number of snapshots published so far.
+     *
+     * @return The current snapshot's version, 0 before the first write
+     */
+    std::uint64_t version() const {
+        auto guard = epochs_.pin();
+        return current_.load(std::memory_order_seq_cst)->version;
+    }
+
+    /**
+     * Frees old snapshots that no reader can still be using. Writes do
+     * this too; call it after a burst of writes if readers were pinned.
+     *
+     * @return The number of snapshots still waiting to be freed
+     */
+    std::size_t reclaim() {
+        epochs_.collect();
+        return epochs_.pending();
+    }
+};
+
+#endif // READ_MOSTLY_CACHE_H
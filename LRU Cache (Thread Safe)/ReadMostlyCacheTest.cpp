@@ -0,0 +1,183 @@
+#include "ReadMostlyCache.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for ReadMostlyCache and EpochManager.
+ *
+ * Tests cover:
+ * - Basic operations and batched updates
+ * - Reclamation waits for pinned readers
+ * - Old snapshots are freed
+ * - Lock-free readers running against writers
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread ReadMostlyCacheTest.cpp -o read_mostly_cache_test
+ */
+
+namespace {
+
+std::atomic<int> live_values{0};
+
+// Counts its live instances, to check that retired snapshots are freed.
+struct Tracked {
+    int id = 0;
+    Tracked() { live_values++; }
+    explicit Tracked(int i) : id(i) { live_values++; }
+    Tracked(const Tracked& other) : id(other.id) { live_values++; }
+    Tracked& operator=(const Tracked& other) = default;
+    ~Tracked() { live_values--; }
+};
+
+} // namespace
+
+void testBasicOperations() {
+    std::cout << "Test 1: Basic Operations and Batched Updates" << std::endl;
+    ReadMostlyCache<std::string, int> cache;
+    assert(cache.isEmpty());
+    assert(cache.get("a") == nullptr);
+
+    cache.put("a", 1);
+    cache.put("b", 2);
+    assert(*cache.get("a") == 1);
+    assert(cache.containsKey("b"));
+    assert(cache.version() == 2);
+
+    cache.update([](ReadMostlyCache<std::string, int>::Map& entries) {
+        entries["a"] = 10;
+        entries["c"] = 3;
+        entries.erase("b");
+    });
+    assert(cache.version() == 3);
+    assert(cache.size() == 2);
+    int seen = 0;
+    assert(cache.read("a", [&seen](const int& value) { seen = value; }));
+    assert(seen == 10);
+    assert(!cache.read("b", [](const int&) { assert(false); }));
+
+    assert(cache.remove("a"));
+    assert(!cache.remove("a"));
+    assert(cache.version() == 4);  // a failed remove publishes nothing
+    cache.clear();
+    assert(cache.isEmpty());
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testPinnedReaderDelaysReclamation() {
+    std::cout << "Test 2: Reclamation Waits for Pinned Readers" << std::endl;
+    EpochManager epochs;
+    std::atomic<bool> freed{false};
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+
+    std::thread reader([&]() {
+        auto guard = epochs.pin();
+        pinned = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned) {
+        std::this_thread::yield();
+    }
+
+    epochs.retire([&freed]() { freed = true; });
+    for (int i = 0; i < 10; i++) {
+        epochs.collect();
+    }
+    assert(!freed);
+    assert(epochs.pending() == 1);
+
+    release = true;
+    reader.join();
+    assert(epochs.collect() == 1);
+    assert(freed);
+
+    // Guards nest: the outer one keeps the thread pinned.
+    {
+        auto outer = epochs.pin();
+        {
+            auto inner = epochs.pin();
+        }
+        epochs.retire([&freed]() { freed = false; });
+        epochs.collect();
+        assert(freed);
+    }
+    epochs.collect();
+    assert(!freed);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSnapshotsAreFreed() {
+    std::cout << "Test 3: Old Snapshots Are Freed" << std::endl;
+    {
+        ReadMostlyCache<int, Tracked> cache;
+        for (int i = 0; i < 100; i++) {
+            cache.put(i % 10, Tracked(i));
+        }
+        assert(cache.reclaim() == 0);
+        assert(live_values == 10);
+        assert(cache.get(3)->id == 93);
+    }
+    assert(live_values == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testConcurrentReadersAndWriter() {
+    std::cout << "Test 4: Lock-Free Readers Against Writers" << std::endl;
+    ReadMostlyCache<int, int> cache;
+    cache.update([](ReadMostlyCache<int, int>::Map& entries) {
+        for (int k = 0; k < 100; k++) {
+            entries[k] = 0;
+        }
+    });
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&cache, &stop, t]() {
+            std::vector<int> last(100, 0);
+            while (!stop) {
+                for (int k = t; k < 100; k += 4) {
+                    // Every update raises all values together, so no reader
+                    // may see a key go backwards.
+                    int value = -1;
+                    cache.read(k, [&value](const int& v) { value = v; });
+                    assert(value >= last[k]);
+                    last[k] = value;
+                }
+            }
+        });
+    }
+
+    for (int round = 1; round <= 500; round++) {
+        cache.update([round](ReadMostlyCache<int, int>::Map& entries) {
+            for (auto& entry : entries) {
+                entry.second = round;
+            }
+        });
+    }
+    stop = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    assert(*cache.get(42) == 500);
+    assert(cache.reclaim() == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Read-Mostly Cache Tests...\n" << std::endl;
+
+    testBasicOperations();
+    testPinnedReaderDelaysReclamation();
+    testSnapshotsAreFreed();
+    testConcurrentReadersAndWriter();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,463 @@
+#ifndef SHARDED_LRU_CACHE_H
+#define SHARDED_LRU_CACHE_H
+
+#include "LRUCache.h"
+#include "../Common/Hash.h"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Sharded LRU Cache built from independent LRUCache instances.
+ *
+ * Keys are routed to one of N shards by hash, so operations on different
+ * shards never contend on the same lock. Each shard evicts independently,
+ * which makes eviction approximately (not globally) LRU.
+ *
+ * A key is hashed once: the same hash picks the shard and is stored in the
+ * shard's entry. Callers that already hold Hash{}(key) can pass it to the
+ * get/put/remove/containsKey overloads and skip hashing altogether.
+ *
+ * Time Complexity:
+ * - get / put / remove: O(1) plus one hash to pick the shard
+ * - size / clear: O(shards)
+ *
+ * Space Complexity: O(capacity)
+ *
+ * @tparam K The type of keys maintained by this cache
+ * @tparam V The type of mapped values
+ * @tparam Hash The hash functor for K, used for shard selection and by each shard
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ShardedLRUCache {
+private:
+    std::vector<std::unique_ptr<LRUCache<K, V, Hash>>> shards_;
+    std::atomic<int> capacity_;
+    std::unique_ptr<MissRatioSampler> miss_ratio_owner_;
+    std::atomic<MissRatioSampler*> miss_ratio_{nullptr};  // set once
+    Hash hasher_;
+
+    std::size_t shardIndex(std::size_t hash) const {
+        // Mix the high bits in so that weak hashes (e.g. identity for ints)
+        // still spread across shards.
+        return fmix64(hash) % shards_.size();
+    }
+
+    LRUCache<K, V, Hash>& shardFor(std::size_t hash) const {
+        return *shards_[shardIndex(hash)];
+    }
+
+public:
+    /**
+     * Initializes a sharded cache.
+     *
+     * @param capacity The total number of entries across all shards
+     * @param shard_count The number of independent shards
+     * @throws std::invalid_argument if capacity <= 0 or shard_count <= 0
+     */
+    ShardedLRUCache(int capacity, int shard_count) : capacity_(capacity) {
+        if (capacity <= 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        if (shard_count <= 0) {
+            throw std::invalid_argument("Shard count must be greater than 0");
+        }
+        if (shard_count > capacity) {
+            shard_count = capacity;
+        }
+        int per_shard = (capacity + shard_count - 1) / shard_count;
+        shards_.reserve(shard_count);
+        for (int i = 0; i < shard_count; i++) {
+            shards_.push_back(std::make_unique<LRUCache<K, V, Hash>>(per_shard));
+        }
+    }
+
+    /**
+     * Retrieves the value associated with the given key.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key) {
+        return get(key, hasher_(key));
+    }
+
+    /**
+     * Retrieves a value using a hash the caller has already computed.
+     *
+     * @param key The key whose value is to be retrieved
+     * @param hash Hash{}(key)
+     * @return A shared_ptr to the value if found, nullptr otherwise
+     */
+    std::shared_ptr<V> get(const K& key, std::size_t hash) {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler != nullptr) {
+            sampler->offer(hash);
+        }
+        return shardFor(hash).get(key, hash);
+    }
+
+    /**
+     * Inserts or updates a key-value pair in the owning shard.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        put(key, hasher_(key), value);
+    }
+
+    /**
+     * Inserts or updates a key-value pair using a hash the caller has
+     * already computed.
+     *
+     * @param key The key to be inserted or updated
+     * @param hash Hash{}(key)
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, std::size_t hash, const V& value) {
+        shardFor(hash).put(key, hash, value);
+    }
+
+    /**
+     * Inserts or updates a key-value pair carrying tags. See
+     * LRUCache::put(key, value, tags).
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     * @param tags The entry's tags
+     */
+    void put(const K& key, const V& value, const std::vector<std::string>& tags) {
+        std::size_t hash = hasher_(key);
+        shardFor(hash).put(key, hash, value, tags);
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        return remove(key, hasher_(key));
+    }
+
+    /**
+     * Removes an entry using a hash the caller has already computed.
+     *
+     * @param key The key of the entry to be removed
+     * @param hash Hash{}(key)
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key, std::size_t hash) {
+        return shardFor(hash).remove(key, hash);
+    }
+
+    /**
+     * Removes several keys, taking each shard's write lock once for all of
+     * that shard's keys.
+     *
+     * @param keys The keys of the entries to be removed
+     * @return The number of entries removed
+     */
+    int removeAll(const std::vector<K>& keys) {
+        std::vector<std::vector<K>> shard_keys(shards_.size());
+        std::vector<std::vector<std::size_t>> shard_hashes(shards_.size());
+        for (const K& key : keys) {
+            std::size_t hash = hasher_(key);
+            std::size_t index = shardIndex(hash);
+            shard_keys[index].push_back(key);
+            shard_hashes[index].push_back(hash);
+        }
+        int removed = 0;
+        for (std::size_t i = 0; i < shards_.size(); i++) {
+            if (!shard_keys[i].empty()) {
+                removed += shards_[i]->removeAll(shard_keys[i], shard_hashes[i]);
+            }
+        }
+        return removed;
+    }
+
+    /**
+     * Retrieves a value with its version, for a later compareAndSet().
+     *
+     * @param key The key whose value is to be retrieved
+     * @return The value and its version; nullptr and 0 if the key is absent
+     */
+    VersionedValue<V> getVersioned(const K& key) {
+        std::size_t hash = hasher_(key);
+        return shardFor(hash).getVersioned(key, hash);
+    }
+
+    /**
+     * Atomically replaces a key's value with fn(current) under the shard's
+     * write lock. See LRUCache::compute().
+     *
+     * @param key The key to compute
+     * @param fn Called as fn(const V* current); returns std::optional<V>
+     * @return The new value, or nullptr if the key is now absent
+     */
+    template <typename F>
+    std::shared_ptr<V> compute(const K& key, F&& fn) {
+        std::size_t hash = hasher_(key);
+        return shardFor(hash).compute(key, hash, std::forward<F>(fn));
+    }
+
+    /**
+     * Atomically replaces the value of a present key with fn(current). See
+     * LRUCache::computeIfPresent().
+     *
+     * @param key The key to compute
+     * @param fn Called as fn(const V& current); returns std::optional<V>
+     * @return The new value, or nullptr if the key is now absent
+     */
+    template <typename F>
+    std::shared_ptr<V> computeIfPresent(const K& key, F&& fn) {
+        std::size_t hash = hasher_(key);
+        return shardFor(hash).computeIfPresent(key, hash, std::forward<F>(fn));
+    }
+
+    /**
+     * Stores value if absent, otherwise fn(current, value). See
+     * LRUCache::merge().
+     *
+     * @param key The key to merge into
+     * @param value The value to store or merge
+     * @param fn Called as fn(const V& current, const V& value); returns std::optional<V>
+     * @return The new value, or nullptr if the entry was removed
+     */
+    template <typename F>
+    std::shared_ptr<V> merge(const K& key, const V& value, F&& fn) {
+        std::size_t hash = hasher_(key);
+        return shardFor(hash).merge(key, hash, value, std::forward<F>(fn));
+    }
+
+    /**
+     * Stores value only if the entry is still at the expected version. See
+     * LRUCache::compareAndSet().
+     *
+     * @param key The key to update
+     * @param expected_version A version from getVersioned(), or 0 for absent
+     * @param value The new value
+     * @return true if the value was stored
+     */
+    bool compareAndSet(const K& key, std::uint64_t expected_version, const V& value) {
+        std::size_t hash = hasher_(key);
+        return shardFor(hash).compareAndSet(key, hash, expected_version, value);
+    }
+
+    /**
+     * Removes every entry carrying a tag, one shard lock at a time.
+     *
+     * @param tag The tag
+     * @return The number of entries removed
+     */
+    int invalidateTag(const std::string& tag) {
+        int removed = 0;
+        for (auto& shard : shards_) {
+            removed += shard->invalidateTag(tag);
+        }
+        return removed;
+    }
+
+    /**
+     * Invalidates every entry carrying a tag by bumping the tag's
+     * generation in each shard. See LRUCache::invalidateTagLazily().
+     *
+     * @param tag The tag
+     */
+    void invalidateTagLazily(const std::string& tag) {
+        for (auto& shard : shards_) {
+            shard->invalidateTagLazily(tag);
+        }
+    }
+
+    /**
+     * Checks whether the given key is present in the cache.
+     *
+     * @param key The key to check
+     * @return true if the key is in the cache, false otherwise
+     */
+    bool containsKey(const K& key) const {
+        return containsKey(key, hasher_(key));
+    }
+
+    /**
+     * Checks for a key using a hash the caller has already computed.
+     *
+     * @param key The key to check
+     * @param hash Hash{}(key)
+     * @return true if the key is in the cache, false otherwise
+     */
+    bool containsKey(const K& key, std::size_t hash) const {
+        return shardFor(hash).containsKey(key, hash);
+    }
+
+    /**
+     * Removes all entries from every shard.
+     */
+    void clear() {
+        for (auto& shard : shards_) {
+            shard->clear();
+        }
+    }
+
+    /**
+     * Returns the number of entries across all shards. Shards are sampled
+     * one at a time, so the result is not a point-in-time snapshot.
+     *
+     * @return The current size of the cache
+     */
+    int size() const {
+        int total = 0;
+        for (const auto& shard : shards_) {
+            total += shard->size();
+        }
+        return total;
+    }
+
+    /**
+     * Returns the total capacity requested at construction.
+     *
+     * @return The maximum number of entries this cache can hold
+     */
+    int getCapacity() const {
+        return capacity_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Changes the total capacity, split evenly across shards. Each shard
+     * evicts its excess incrementally, as LRUCache::setCapacity does. With
+     * fewer entries than shards, every shard still keeps one entry.
+     *
+     * @param capacity The new total number of entries
+     * @throws std::invalid_argument if capacity <= 0
+     */
+    void setCapacity(int capacity) {
+        if (capacity <= 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        capacity_.store(capacity, std::memory_order_relaxed);
+        int shard_count = static_cast<int>(shards_.size());
+        int per_shard = (capacity + shard_count - 1) / shard_count;
+        for (auto& shard : shards_) {
+            shard->setCapacity(per_shard);
+        }
+    }
+
+    /**
+     * Evicts up to max_evictions_per_shard excess entries in each shard.
+     *
+     * @param max_evictions_per_shard The most entries to evict per shard lock hold
+     * @return The number of entries still above capacity, over all shards
+     */
+    int trimToCapacity(int max_evictions_per_shard = 64) {
+        int remaining = 0;
+        for (auto& shard : shards_) {
+            remaining += shard->trimToCapacity(max_evictions_per_shard);
+        }
+        return remaining;
+    }
+
+    /**
+     * Returns the number of shards.
+     *
+     * @return The shard count
+     */
+    int shardCount() const {
+        return static_cast<int>(shards_.size());
+    }
+
+    /**
+     * Starts hot key tracking in every shard. Each shard gets its own
+     * tracker with config.counters counters.
+     *
+     * @param config Counter count, sampling rate and decay interval
+     * @throws std::invalid_argument if the config is invalid
+     * @throws std::logic_error if tracking is already enabled
+     */
+    void enableHotKeyTracking(const HotKeyConfig& config = HotKeyConfig()) {
+        for (auto& shard : shards_) {
+            shard->enableHotKeyTracking(config);
+        }
+    }
+
+    /**
+     * Returns the most frequently accessed keys across all shards.
+     *
+     * @param k The number of keys to return
+     * @return Up to k keys with estimated access counts, most frequent first
+     */
+    std::vector<HotKey<K>> hotKeys(std::size_t k) const {
+        std::vector<HotKey<K>> merged;
+        for (const auto& shard : shards_) {
+            std::vector<HotKey<K>> top = shard->hotKeys(k);
+            merged.insert(merged.end(), top.begin(), top.end());
+        }
+        // A key lives in exactly one shard, so no counts need combining.
+        std::sort(merged.begin(), merged.end(), [](const HotKey<K>& a, const HotKey<K>& b) {
+            return a.count > b.count;
+        });
+        if (merged.size() > k) {
+            merged.resize(k);
+        }
+        return merged;
+    }
+
+    /**
+     * Starts estimating the miss-ratio curve of the whole cache. One
+     * sampler sees the lookups of every shard, so the curve is for total
+     * capacity; shards evict independently, so treat it as approximate.
+     *
+     * @param config Initial sampling rate and sampled key bound
+     * @throws std::invalid_argument if the config is invalid
+     * @throws std::logic_error if sampling is already enabled
+     */
+    void enableMissRatioSampling(const MissRatioConfig& config = MissRatioConfig()) {
+        auto sampler = std::make_unique<MissRatioSampler>(config);
+        MissRatioSampler* expected = nullptr;
+        if (!miss_ratio_.compare_exchange_strong(expected, sampler.get(), std::memory_order_acq_rel)) {
+            throw std::logic_error("Miss ratio sampling is already enabled");
+        }
+        miss_ratio_owner_ = std::move(sampler);
+    }
+
+    /**
+     * Estimates the miss ratio get() would have at each total capacity.
+     *
+     * @param capacities Capacities in entries
+     * @return One point per capacity, empty if sampling is disabled
+     */
+    std::vector<MissRatioPoint> missRatioCurve(const std::vector<std::size_t>& capacities) const {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler == nullptr) {
+            return {};
+        }
+        return sampler->curve(capacities);
+    }
+
+    /**
+     * Estimates the miss-ratio curve at powers of two up to the largest
+     * reuse distance seen.
+     *
+     * @return The curve, empty if sampling is disabled
+     */
+    std::vector<MissRatioPoint> missRatioCurve() const {
+        MissRatioSampler* sampler = miss_ratio_.load(std::memory_order_acquire);
+        if (sampler == nullptr) {
+            return {};
+        }
+        return sampler->curve();
+    }
+
+    ~ShardedLRUCache() = default;
+};
+
+#endif // SHARDED_LRU_CACHE_H
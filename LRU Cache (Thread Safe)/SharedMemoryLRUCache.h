@@ -0,0 +1,685 @@
+#ifndef SHARED_MEMORY_LRU_CACHE_H
+#define SHARED_MEMORY_LRU_CACHE_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * LRU cache that lives in a POSIX shared-memory segment.
+ *
+ * Every process that opens the same segment name sees the same entries, so
+ * pre-forked workers on one host share a single copy of the working set
+ * instead of one copy each.
+ *
+ * Nothing inside the segment is a pointer: links are byte offsets from the
+ * start of the mapping, so each process may map it at a different address.
+ * Memory is handed out by a slab allocator: the segment is cut into fixed
+ * size pages, each page is assigned to a size class and split into equal
+ * chunks, and every size class keeps its own LRU list. When a class has no
+ * free chunk it evicts its own least recently used entry, and a class that
+ * owns no page at all takes one over from the class holding the most pages.
+ *
+ * All operations are serialized by one robust, process-shared mutex. If a
+ * process dies while holding it, the next locker is told so by the kernel;
+ * if the dead holder was in the middle of a modification the table is reset
+ * to empty (a cache may always forget), otherwise it is used as is.
+ *
+ * Time Complexity:
+ * - get / put / remove: O(1) expected
+ * - clear: O(buckets + pages)
+ *
+ * Keys and values are byte strings; an entry (header, key and value) must fit
+ * in one page.
+ */
+class SharedMemoryLRUCache {
+private:
+    static constexpr std::uint64_t kMagic = 0x3155524c4d485300ULL;  // "\0SHMLRU1"
+    static constexpr int kMaxClasses = 64;
+    static constexpr std::uint64_t kMinChunk = 64;
+    static constexpr std::uint8_t kNoClass = 0xff;
+
+    struct SlabClass {
+        std::uint64_t chunk_size;
+        std::uint64_t free_head;
+        std::uint64_t lru_head;  // least recently used
+        std::uint64_t lru_tail;  // most recently used
+        std::uint64_t pages;
+        std::uint64_t items;
+    };
+
+    struct Header {
+        std::atomic<std::uint64_t> magic;  // published last by the creator
+        std::uint64_t segment_bytes;
+        std::uint64_t page_bytes;
+        std::uint64_t page_count;
+        std::uint64_t pages_used;
+        std::uint64_t pages_offset;
+        std::uint64_t page_class_offset;
+        std::uint64_t bucket_offset;
+        std::uint64_t bucket_count;
+        std::uint64_t item_count;
+        std::uint64_t evictions;
+        std::uint64_t recoveries;
+        std::uint32_t class_count;
+        std::atomic<std::uint32_t> mutating;
+        pthread_mutex_t mutex;
+        SlabClass classes[kMaxClasses];
+    };
+
+    struct Item {
+        std::uint64_t hnext;  // next item in the same hash bucket
+        std::uint64_t prev;   // LRU neighbours within the size class
+        std::uint64_t next;
+        std::uint64_t hash;
+        std::uint32_t key_len;
+        std::uint32_t value_len;
+        std::uint8_t cls;
+        std::uint8_t in_use;
+    };
+
+    /**
+     * Holds the segment mutex, repairing the table first if the previous
+     * holder died.
+     */
+    class SegmentLock {
+    public:
+        explicit SegmentLock(SharedMemoryLRUCache& cache) : header_(cache.header_) {
+            int rc = pthread_mutex_lock(&header_->mutex);
+            if (rc == EOWNERDEAD) {
+                if (header_->mutating.load(std::memory_order_relaxed) != 0) {
+                    cache.resetTable();
+                    header_->recoveries++;
+                    header_->mutating.store(0, std::memory_order_relaxed);
+                }
+                pthread_mutex_consistent(&header_->mutex);
+            } else if (rc != 0) {
+                throw std::system_error(rc, std::generic_category(), "pthread_mutex_lock");
+            }
+        }
+
+        ~SegmentLock() {
+            pthread_mutex_unlock(&header_->mutex);
+        }
+
+        SegmentLock(const SegmentLock&) = delete;
+        SegmentLock& operator=(const SegmentLock&) = delete;
+
+    private:
+        Header* header_;
+    };
+
+    /**
+     * Marks the table as being modified for the lifetime of the object, so a
+     * crash in between is detected by the next locker.
+     */
+    class Mutation {
+    public:
+        explicit Mutation(Header* header) : header_(header) {
+            header_->mutating.store(1, std::memory_order_relaxed);
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+
+        ~Mutation() {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            header_->mutating.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        Header* header_;
+    };
+
+    std::string name_;
+    int fd_ = -1;
+    char* base_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    Header* header_ = nullptr;
+
+    static std::uint64_t alignUp(std::uint64_t n, std::uint64_t a) {
+        return (n + a - 1) / a * a;
+    }
+
+    static std::uint64_t hashKey(const char* data, std::size_t len) {
+        // FNV-1a: fixed across processes and binaries, unlike std::hash.
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (std::size_t i = 0; i < len; i++) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    Item* item(std::uint64_t off) const {
+        return reinterpret_cast<Item*>(base_ + off);
+    }
+
+    std::uint64_t offsetOf(const Item* it) const {
+        return static_cast<std::uint64_t>(reinterpret_cast<const char*>(it) - base_);
+    }
+
+    static char* keyOf(Item* it) {
+        return reinterpret_cast<char*>(it + 1);
+    }
+
+    static char* valueOf(Item* it) {
+        return keyOf(it) + it->key_len;
+    }
+
+    std::uint64_t* buckets() const {
+        return reinterpret_cast<std::uint64_t*>(base_ + header_->bucket_offset);
+    }
+
+    std::uint8_t* pageClasses() const {
+        return reinterpret_cast<std::uint8_t*>(base_ + header_->page_class_offset);
+    }
+
+    std::uint64_t pageOffset(std::uint64_t page) const {
+        return header_->pages_offset + page * header_->page_bytes;
+    }
+
+    void initialize(std::uint64_t segment_bytes, std::uint64_t page_bytes) {
+        Header* h = header_;
+        h->segment_bytes = segment_bytes;
+        h->page_bytes = page_bytes;
+
+        std::uint64_t bucket_count = 64;
+        while (bucket_count < segment_bytes / 256) {
+            bucket_count <<= 1;
+        }
+        h->bucket_count = bucket_count;
+        h->bucket_offset = alignUp(sizeof(Header), 64);
+        h->page_class_offset = h->bucket_offset + bucket_count * sizeof(std::uint64_t);
+        // segment_bytes / page_bytes bounds the page count from above.
+        h->pages_offset = alignUp(h->page_class_offset + segment_bytes / page_bytes, 4096);
+        if (h->pages_offset + page_bytes > segment_bytes) {
+            throw std::invalid_argument("Segment too small to hold a single page");
+        }
+        h->page_count = (segment_bytes - h->pages_offset) / page_bytes;
+
+        std::uint32_t count = 0;
+        std::uint64_t size = kMinChunk;
+        while (size < page_bytes && count < kMaxClasses - 1) {
+            h->classes[count++].chunk_size = size;
+            size = alignUp(static_cast<std::uint64_t>(size * 1.25), 8);
+        }
+        h->classes[count++].chunk_size = page_bytes;
+        h->class_count = count;
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int rc = pthread_mutex_init(&h->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), "pthread_mutex_init");
+        }
+        h->mutating.store(0, std::memory_order_relaxed);
+        h->evictions = 0;
+        h->recoveries = 0;
+        resetTable();
+    }
+
+    void resetTable() {
+        std::memset(buckets(), 0, header_->bucket_count * sizeof(std::uint64_t));
+        std::memset(pageClasses(), kNoClass, header_->page_count);
+        for (std::uint32_t c = 0; c < header_->class_count; c++) {
+            SlabClass& sc = header_->classes[c];
+            sc.free_head = sc.lru_head = sc.lru_tail = 0;
+            sc.pages = sc.items = 0;
+        }
+        header_->pages_used = 0;
+        header_->item_count = 0;
+    }
+
+    int classFor(std::uint64_t bytes) const {
+        for (std::uint32_t c = 0; c < header_->class_count; c++) {
+            if (header_->classes[c].chunk_size >= bytes) {
+                return static_cast<int>(c);
+            }
+        }
+        return -1;
+    }
+
+    Item* find(std::uint64_t hash, const std::string& key) const {
+        std::uint64_t off = buckets()[hash & (header_->bucket_count - 1)];
+        while (off != 0) {
+            Item* it = item(off);
+            if (it->hash == hash && it->key_len == key.size() &&
+                std::memcmp(keyOf(it), key.data(), key.size()) == 0) {
+                return it;
+            }
+            off = it->hnext;
+        }
+        return nullptr;
+    }
+
+    void lruUnlink(Item* it) {
+        SlabClass& sc = header_->classes[it->cls];
+        if (it->prev != 0) {
+            item(it->prev)->next = it->next;
+        } else {
+            sc.lru_head = it->next;
+        }
+        if (it->next != 0) {
+            item(it->next)->prev = it->prev;
+        } else {
+            sc.lru_tail = it->prev;
+        }
+    }
+
+    void lruAppend(Item* it) {
+        SlabClass& sc = header_->classes[it->cls];
+        std::uint64_t off = offsetOf(it);
+        it->prev = sc.lru_tail;
+        it->next = 0;
+        if (sc.lru_tail != 0) {
+            item(sc.lru_tail)->next = off;
+        } else {
+            sc.lru_head = off;
+        }
+        sc.lru_tail = off;
+    }
+
+    void hashUnlink(Item* it) {
+        std::uint64_t* slot = &buckets()[it->hash & (header_->bucket_count - 1)];
+        std::uint64_t off = offsetOf(it);
+        while (*slot != off) {
+            slot = &item(*slot)->hnext;
+        }
+        *slot = it->hnext;
+    }
+
+    void freeChunk(Item* it) {
+        SlabClass& sc = header_->classes[it->cls];
+        it->in_use = 0;
+        it->hnext = sc.free_head;
+        sc.free_head = offsetOf(it);
+    }
+
+    void unlinkItem(Item* it) {
+        hashUnlink(it);
+        lruUnlink(it);
+        header_->classes[it->cls].items--;
+        header_->item_count--;
+        freeChunk(it);
+    }
+
+    void carvePage(std::uint64_t page, int cls) {
+        SlabClass& sc = header_->classes[cls];
+        pageClasses()[page] = static_cast<std::uint8_t>(cls);
+        std::uint64_t chunks = header_->page_bytes / sc.chunk_size;
+        for (std::uint64_t i = chunks; i-- > 0;) {
+            Item* it = item(pageOffset(page) + i * sc.chunk_size);
+            it->cls = static_cast<std::uint8_t>(cls);
+            freeChunk(it);
+        }
+        sc.pages++;
+    }
+
+    /**
+     * Moves one page from the class holding the most pages to cls, evicting
+     * whatever lived in it. Prefers the page holding the victim class's
+     * least recently used entry.
+     */
+    void reassignPage(int cls) {
+        int victim = -1;
+        for (std::uint32_t c = 0; c < header_->class_count; c++) {
+            if (static_cast<int>(c) != cls && header_->classes[c].pages > 0 &&
+                (victim < 0 || header_->classes[c].pages > header_->classes[victim].pages)) {
+                victim = static_cast<int>(c);
+            }
+        }
+        if (victim < 0) {
+            throw std::logic_error("SharedMemoryLRUCache: no page to reassign");
+        }
+        SlabClass& vc = header_->classes[victim];
+        std::uint64_t page = header_->page_count;
+        if (vc.lru_head != 0) {
+            page = (vc.lru_head - header_->pages_offset) / header_->page_bytes;
+        } else {
+            for (std::uint64_t p = 0; p < header_->pages_used; p++) {
+                if (pageClasses()[p] == victim) {
+                    page = p;
+                    break;
+                }
+            }
+        }
+
+        std::uint64_t begin = pageOffset(page);
+        std::uint64_t end = begin + header_->page_bytes;
+        std::uint64_t chunks = header_->page_bytes / vc.chunk_size;
+        for (std::uint64_t i = 0; i < chunks; i++) {
+            Item* it = item(begin + i * vc.chunk_size);
+            if (it->in_use) {
+                unlinkItem(it);
+                header_->evictions++;
+            }
+        }
+        // Drop the page's chunks from the victim's free list.
+        std::uint64_t* slot = &vc.free_head;
+        while (*slot != 0) {
+            if (*slot >= begin && *slot < end) {
+                *slot = item(*slot)->hnext;
+            } else {
+                slot = &item(*slot)->hnext;
+            }
+        }
+        vc.pages--;
+        carvePage(page, cls);
+    }
+
+    Item* allocate(int cls) {
+        SlabClass& sc = header_->classes[cls];
+        if (sc.free_head == 0) {
+            if (header_->pages_used < header_->page_count) {
+                carvePage(header_->pages_used++, cls);
+            } else if (sc.lru_head != 0) {
+                unlinkItem(item(sc.lru_head));
+                header_->evictions++;
+            } else {
+                reassignPage(cls);
+            }
+        }
+        Item* it = item(sc.free_head);
+        sc.free_head = it->hnext;
+        it->in_use = 1;
+        return it;
+    }
+
+public:
+    /**
+     * Creates the named segment, or attaches to it if another process already
+     * created it. When attaching, the existing segment's size and page size
+     * are used and the arguments are ignored.
+     *
+     * @param name The shm_open name, e.g. "/app-cache"
+     * @param segment_bytes Total size of the segment, including metadata
+     * @param page_bytes Slab page size; also the largest entry that fits
+     * @throws std::invalid_argument if the name does not start with '/', if
+     *         page_bytes < 1024, or if the segment cannot hold one page
+     * @throws std::system_error if the segment cannot be opened or mapped
+     * @throws std::runtime_error if an existing segment is not initialized in time
+     */
+    SharedMemoryLRUCache(const std::string& name, std::size_t segment_bytes,
+                         std::size_t page_bytes = 1 << 20)
+        : name_(name) {
+        if (name.size() < 2 || name[0] != '/') {
+            throw std::invalid_argument("Segment name must start with '/'");
+        }
+        if (page_bytes < 1024) {
+            throw std::invalid_argument("Page size must be at least 1024 bytes");
+        }
+
+        fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd_ >= 0) {
+            try {
+                if (::ftruncate(fd_, static_cast<off_t>(segment_bytes)) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "ftruncate");
+                }
+                map(segment_bytes);
+                initialize(segment_bytes, page_bytes);
+                header_->magic.store(kMagic, std::memory_order_release);
+            } catch (...) {
+                unmap();
+                ::shm_unlink(name.c_str());
+                throw;
+            }
+            return;
+        }
+        if (errno != EEXIST) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+
+        fd_ = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open");
+        }
+        try {
+            // The creator sizes the segment and then publishes the magic.
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            struct stat st {};
+            while (true) {
+                if (::fstat(fd_, &st) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "fstat");
+                }
+                if (static_cast<std::size_t>(st.st_size) >= sizeof(Header)) {
+                    if (base_ == nullptr) {
+                        map(static_cast<std::size_t>(st.st_size));
+                    }
+                    if (header_->magic.load(std::memory_order_acquire) == kMagic) {
+                        break;
+                    }
+                }
+                if (std::chrono::steady_clock::now() > deadline) {
+                    throw std::runtime_error("Shared cache segment " + name + " was never initialized");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    SharedMemoryLRUCache(const SharedMemoryLRUCache&) = delete;
+    SharedMemoryLRUCache& operator=(const SharedMemoryLRUCache&) = delete;
+
+    /**
+     * Unmaps the segment. The segment itself persists until unlink().
+     */
+    ~SharedMemoryLRUCache() {
+        unmap();
+    }
+
+    /**
+     * Removes the segment name. Processes that have it mapped keep working;
+     * the memory is released when the last one detaches.
+     *
+     * @param name The shm_open name passed to the constructor
+     * @return true if the name existed
+     */
+    static bool unlink(const std::string& name) {
+        return ::shm_unlink(name.c_str()) == 0;
+    }
+
+    /**
+     * Retrieves the value associated with the given key and marks the entry
+     * as most recently used.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to a copy of the value if found, nullptr otherwise
+     */
+    std::shared_ptr<std::string> get(const std::string& key) {
+        std::uint64_t hash = hashKey(key.data(), key.size());
+        SegmentLock lock(*this);
+        Item* it = find(hash, key);
+        if (it == nullptr) {
+            return nullptr;
+        }
+        {
+            Mutation mutation(header_);
+            lruUnlink(it);
+            lruAppend(it);
+        }
+        return std::make_shared<std::string>(valueOf(it), it->value_len);
+    }
+
+    /**
+     * Inserts or updates a key-value pair. If the entry's size class is full,
+     * that class's least recently used entry is evicted.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     * @throws std::invalid_argument if the entry does not fit in one page
+     */
+    void put(const std::string& key, const std::string& value) {
+        std::uint64_t bytes = sizeof(Item) + key.size() + value.size();
+        std::uint64_t hash = hashKey(key.data(), key.size());
+        SegmentLock lock(*this);
+        int cls = classFor(bytes);
+        if (cls < 0) {
+            throw std::invalid_argument("Entry larger than the slab page size");
+        }
+        Mutation mutation(header_);
+        Item* it = find(hash, key);
+        if (it != nullptr && it->cls == cls) {
+            it->value_len = static_cast<std::uint32_t>(value.size());
+            std::memcpy(valueOf(it), value.data(), value.size());
+            lruUnlink(it);
+            lruAppend(it);
+            return;
+        }
+        if (it != nullptr) {
+            unlinkItem(it);
+        }
+
+        it = allocate(cls);
+        it->hash = hash;
+        it->key_len = static_cast<std::uint32_t>(key.size());
+        it->value_len = static_cast<std::uint32_t>(value.size());
+        std::memcpy(keyOf(it), key.data(), key.size());
+        std::memcpy(valueOf(it), value.data(), value.size());
+        std::uint64_t* bucket = &buckets()[hash & (header_->bucket_count - 1)];
+        it->hnext = *bucket;
+        *bucket = offsetOf(it);
+        lruAppend(it);
+        header_->classes[cls].items++;
+        header_->item_count++;
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const std::string& key) {
+        std::uint64_t hash = hashKey(key.data(), key.size());
+        SegmentLock lock(*this);
+        Item* it = find(hash, key);
+        if (it == nullptr) {
+            return false;
+        }
+        Mutation mutation(header_);
+        unlinkItem(it);
+        return true;
+    }
+
+    /**
+     * Removes all entries, for every attached process.
+     */
+    void clear() {
+        SegmentLock lock(*this);
+        Mutation mutation(header_);
+        resetTable();
+    }
+
+    /**
+     * Checks whether the given key is present, without changing its recency.
+     *
+     * @param key The key to check
+     * @return true if the key is in the cache, false otherwise
+     */
+    bool containsKey(const std::string& key) {
+        std::uint64_t hash = hashKey(key.data(), key.size());
+        SegmentLock lock(*this);
+        return find(hash, key) != nullptr;
+    }
+
+    /**
+     * Returns the number of entries currently in the cache.
+     *
+     * @return The current size of the cache
+     */
+    int size() {
+        SegmentLock lock(*this);
+        return static_cast<int>(header_->item_count);
+    }
+
+    /**
+     * Checks whether the cache is empty.
+     *
+     * @return true if the cache contains no entries, false otherwise
+     */
+    bool isEmpty() {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the number of entries evicted to make room since creation.
+     *
+     * @return The eviction count
+     */
+    std::uint64_t evictionCount() {
+        SegmentLock lock(*this);
+        return header_->evictions;
+    }
+
+    /**
+     * Returns how often the table was reset because a process died while
+     * modifying it.
+     *
+     * @return The recovery count
+     */
+    std::uint64_t recoveryCount() {
+        SegmentLock lock(*this);
+        return header_->recoveries;
+    }
+
+    /**
+     * Returns the total size of the segment.
+     *
+     * @return The segment size in bytes
+     */
+    std::size_t segmentSize() const {
+        return header_->segment_bytes;
+    }
+
+    /**
+     * Returns the largest key + value size that put() accepts.
+     *
+     * @return The maximum entry payload in bytes
+     */
+    std::size_t maxEntrySize() const {
+        return header_->page_bytes - sizeof(Item);
+    }
+
+private:
+    void map(std::size_t bytes) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        base_ = static_cast<char*>(p);
+        mapped_bytes_ = bytes;
+        header_ = reinterpret_cast<Header*>(base_);
+    }
+
+    void unmap() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_bytes_);
+            base_ = nullptr;
+            header_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+};
+
+#endif // SHARED_MEMORY_LRU_CACHE_H
@@ -0,0 +1,285 @@
+#ifndef STATIC_LRU_CACHE_H
+#define STATIC_LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Fixed-capacity LRU cache with all storage inside the object, for small
+ * hot lookup tables (roughly 8 to 256 entries).
+ *
+ * Entries occupy slots 0..size()-1 densely. Each slot has a one-byte tag
+ * taken from its key's hash; a lookup compares the tag against 16 slots at
+ * a time with SSE2 (a scalar loop elsewhere) and compares keys only where
+ * the tag matches, so a miss in a full 256-entry table costs 16 vector
+ * compares and about one key comparison. Recency is a doubly linked list of
+ * slot indices (one byte each for N < 255), so a hit or an eviction moves
+ * two indices. No operation allocates; whether copying K or V does is up
+ * to K and V.
+ *
+ * Not thread-safe: use it from one thread or behind an external lock.
+ * get() reorders the list, so it needs the lock exclusively; peek() and
+ * containsKey() do not modify the cache.
+ *
+ * Time Complexity:
+ * - get / peek / put / remove / containsKey: O(N / 16) tag compares plus
+ *   O(1) expected key compares
+ * - clear: O(N)
+ *
+ * Space Complexity: N keys, values and tags, and 2(N + 1) indices, in-object
+ *
+ * @tparam K The key type; default-constructible and copy-assignable
+ * @tparam V The value type; default-constructible and copy-assignable
+ * @tparam N The capacity, at most 65534
+ * @tparam Hash The hash functor for K
+ * @tparam KeyEqual The equality functor for K
+ */
+template <typename K, typename V, std::size_t N, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class StaticLRUCache {
+    static_assert(N > 0 && N < 65535, "Capacity must be in [1, 65534]");
+    static_assert(std::is_default_constructible<K>::value && std::is_default_constructible<V>::value,
+                  "Keys and values must be default-constructible");
+
+private:
+    using Index = std::conditional_t<(N < 255), std::uint8_t, std::uint16_t>;
+
+    static constexpr std::size_t kLanes = 16;
+    static constexpr std::size_t kPadded = (N + kLanes - 1) / kLanes * kLanes;
+    static constexpr Index kSentinel = static_cast<Index>(N);
+
+    alignas(16) std::uint8_t tags_[kPadded] = {};
+    Index prev_[N + 1];  // recency list; the sentinel's next is the LRU entry
+    Index next_[N + 1];
+    std::size_t size_ = 0;
+    K keys_[N];
+    V values_[N];
+    Hash hasher_;
+    KeyEqual equal_;
+
+    std::uint8_t tagOf(const K& key) const {
+        // Fibonacci hashing: the top byte depends on every bit of the hash.
+        return static_cast<std::uint8_t>((static_cast<std::uint64_t>(hasher_(key)) *
+                                          0x9e3779b97f4a7c15ULL) >> 56);
+    }
+
+    /**
+     * Returns the slot holding key, or N if it is absent.
+     */
+    std::size_t find(const K& key, std::uint8_t tag) const {
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+        for (std::size_t base = 0; base < size_; base += kLanes) {
+            __m128i block = _mm_load_si128(reinterpret_cast<const __m128i*>(tags_ + base));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if (size_ - base < kLanes) {
+                mask &= (1u << (size_ - base)) - 1;
+            }
+            while (mask != 0) {
+                std::size_t slot = base + static_cast<std::size_t>(__builtin_ctz(mask));
+                if (equal_(keys_[slot], key)) {
+                    return slot;
+                }
+                mask &= mask - 1;
+            }
+        }
+#else
+        for (std::size_t slot = 0; slot < size_; slot++) {
+            if (tags_[slot] == tag && equal_(keys_[slot], key)) {
+                return slot;
+            }
+        }
+#endif
+        return N;
+    }
+
+    void unlink(std::size_t slot) {
+        next_[prev_[slot]] = next_[slot];
+        prev_[next_[slot]] = prev_[slot];
+    }
+
+    void linkMostRecent(std::size_t slot) {
+        prev_[slot] = prev_[kSentinel];
+        next_[slot] = kSentinel;
+        next_[prev_[kSentinel]] = static_cast<Index>(slot);
+        prev_[kSentinel] = static_cast<Index>(slot);
+    }
+
+    void touch(std::size_t slot) {
+        if (prev_[kSentinel] != slot) {
+            unlink(slot);
+            linkMostRecent(slot);
+        }
+    }
+
+    /**
+     * Removes the entry in slot and moves the last entry into the hole, so
+     * the occupied slots stay dense.
+     */
+    void removeAt(std::size_t slot) {
+        unlink(slot);
+        std::size_t last = size_ - 1;
+        if (slot != last) {
+            tags_[slot] = tags_[last];
+            keys_[slot] = std::move(keys_[last]);
+            values_[slot] = std::move(values_[last]);
+            prev_[slot] = prev_[last];
+            next_[slot] = next_[last];
+            next_[prev_[slot]] = static_cast<Index>(slot);
+            prev_[next_[slot]] = static_cast<Index>(slot);
+        }
+        keys_[last] = K();
+        values_[last] = V();
+        size_ = last;
+    }
+
+public:
+    /**
+     * Initializes an empty cache. Keys and values are default-constructed
+     * in place.
+     */
+    StaticLRUCache() {
+        prev_[kSentinel] = kSentinel;
+        next_[kSentinel] = kSentinel;
+    }
+
+    /**
+     * Retrieves a value and marks it most recently used.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A pointer to the stored value, valid until the next put(),
+     *         remove() or clear(); nullptr if absent
+     */
+    V* get(const K& key) {
+        std::size_t slot = find(key, tagOf(key));
+        if (slot == N) {
+            return nullptr;
+        }
+        touch(slot);
+        return &values_[slot];
+    }
+
+    /**
+     * Retrieves a value without changing recency.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A pointer to the stored value, valid until the next
+     *         modification; nullptr if absent
+     */
+    const V* peek(const K& key) const {
+        std::size_t slot = find(key, tagOf(key));
+        return slot == N ? nullptr : &values_[slot];
+    }
+
+    /**
+     * Inserts or updates a key-value pair and marks it most recently used.
+     * When full, the least recently used entry's slot is reused. If copying
+     * the key or value throws, the entry being written is dropped.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const K& key, const V& value) {
+        std::uint8_t tag = tagOf(key);
+        std::size_t slot = find(key, tag);
+        if (slot != N) {
+            values_[slot] = value;
+            touch(slot);
+            return;
+        }
+        if (size_ == N) {
+            slot = next_[kSentinel];
+            touch(slot);
+        } else {
+            slot = size_++;
+            linkMostRecent(slot);
+        }
+        tags_[slot] = tag;
+        try {
+            keys_[slot] = key;
+            values_[slot] = value;
+        } catch (...) {
+            removeAt(slot);
+            throw;
+        }
+    }
+
+    /**
+     * Removes the entry associated with the given key.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if an entry was removed, false if the key was absent
+     */
+    bool remove(const K& key) {
+        std::size_t slot = find(key, tagOf(key));
+        if (slot == N) {
+            return false;
+        }
+        removeAt(slot);
+        return true;
+    }
+
+    /**
+     * Checks whether the given key is present, without changing recency.
+     *
+     * @param key The key to check
+     * @return true if the key is in the cache
+     */
+    bool containsKey(const K& key) const {
+        return find(key, tagOf(key)) != N;
+    }
+
+    /**
+     * Removes all entries, resetting keys and values to their defaults.
+     */
+    void clear() {
+        for (std::size_t slot = 0; slot < size_; slot++) {
+            keys_[slot] = K();
+            values_[slot] = V();
+        }
+        size_ = 0;
+        prev_[kSentinel] = kSentinel;
+        next_[kSentinel] = kSentinel;
+    }
+
+    /**
+     * Visits entries from least to most recently used.
+     *
+     * @param visit Called as visit(const K&, const V&); must not modify the cache
+     */
+    template <typename F>
+    void forEach(F&& visit) const {
+        for (std::size_t slot = next_[kSentinel]; slot != kSentinel; slot = next_[slot]) {
+            visit(keys_[slot], values_[slot]);
+        }
+    }
+
+    /**
+     * @return The number of entries
+     */
+    std::size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @return true if the cache holds no entries
+     */
+    bool isEmpty() const {
+        return size_ == 0;
+    }
+
+    /**
+     * @return The capacity N
+     */
+    static constexpr std::size_t capacity() {
+        return N;
+    }
+};
+
+#endif // STATIC_LRU_CACHE_H
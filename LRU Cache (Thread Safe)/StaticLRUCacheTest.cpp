@@ -0,0 +1,208 @@
+#include "StaticLRUCache.h"
+#include "LRUCache.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for StaticLRUCache.
+ *
+ * Tests cover:
+ * - Basic operations and LRU eviction order
+ * - Matching LRUCache on random operations, across tag-block boundaries
+ * - No heap allocation
+ * - String keys behind an external lock
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread StaticLRUCacheTest.cpp -o static_lru_test
+ */
+
+namespace {
+
+std::atomic<long> g_allocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Out of line, so the compiler does not pair the inlined free() with the
+// replacement operator new and warn about a mismatch.
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/**
+ * Applies the same random operations to a StaticLRUCache and an LRUCache of
+ * the same capacity and checks that they always agree.
+ */
+template <std::size_t N>
+void checkAgainstLRUCache(int key_range, unsigned seed) {
+    StaticLRUCache<int, int, N> fixed;
+    LRUCache<int, int> reference(static_cast<int>(N));
+    std::mt19937 rng(seed);
+    for (int step = 0; step < 20000; step++) {
+        int key = static_cast<int>(rng() % key_range);
+        switch (rng() % 8) {
+        case 0:
+            assert(fixed.remove(key) == reference.remove(key));
+            break;
+        case 1:
+        case 2:
+        case 3:
+            fixed.put(key, step);
+            reference.put(key, step);
+            break;
+        case 4:
+            assert(fixed.containsKey(key) == reference.containsKey(key));
+            break;
+        default: {
+            int* got = fixed.get(key);
+            auto expected = reference.get(key);
+            assert((got == nullptr) == (expected == nullptr));
+            assert(got == nullptr || *got == *expected);
+        }
+        }
+        assert(static_cast<int>(fixed.size()) == reference.size());
+    }
+    std::vector<int> order;
+    fixed.forEach([&order](const int& key, const int&) { order.push_back(key); });
+    std::vector<int> expected_order;
+    reference.forEachChunked([&expected_order](const int& key, const int&) { expected_order.push_back(key); });
+    assert(order == expected_order);
+}
+
+} // namespace
+
+void testBasicOperations() {
+    std::cout << "Test 1: Basic Operations and Eviction Order" << std::endl;
+    StaticLRUCache<int, int, 3> cache;
+    assert(cache.isEmpty() && cache.capacity() == 3);
+
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    assert(*cache.get(1) == 10);  // 1 becomes most recent
+    cache.put(4, 40);             // evicts 2
+    assert(cache.get(2) == nullptr);
+    assert(cache.size() == 3);
+    assert(*cache.peek(3) == 30);  // no recency change
+    cache.put(5, 50);              // evicts 3
+    assert(!cache.containsKey(3) && cache.containsKey(1));
+
+    cache.put(1, 11);
+    assert(*cache.get(1) == 11 && cache.size() == 3);
+    *cache.get(4) += 1;
+    assert(*cache.peek(4) == 41);
+
+    assert(cache.remove(5));
+    assert(!cache.remove(5));
+    assert(cache.size() == 2);
+    std::vector<int> order;
+    cache.forEach([&order](const int& key, const int&) { order.push_back(key); });
+    assert((order == std::vector<int>{1, 4}));
+
+    cache.clear();
+    assert(cache.isEmpty() && cache.get(1) == nullptr);
+    cache.put(7, 70);
+    assert(*cache.get(7) == 70);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMatchesLRUCache() {
+    std::cout << "Test 2: Matching LRUCache on Random Operations" << std::endl;
+    checkAgainstLRUCache<1>(4, 1);
+    checkAgainstLRUCache<8>(24, 2);
+    checkAgainstLRUCache<17>(40, 3);     // last tag block partly used
+    checkAgainstLRUCache<64>(150, 4);
+    checkAgainstLRUCache<254>(600, 5);   // largest one-byte index
+    checkAgainstLRUCache<256>(600, 6);   // two-byte index
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testNoAllocation() {
+    std::cout << "Test 3: No Heap Allocation" << std::endl;
+    auto* cache = new StaticLRUCache<std::uint64_t, double, 128>();
+    long before = g_allocations.load();
+    for (std::uint64_t i = 0; i < 100000; i++) {
+        std::uint64_t key = (i * 2654435761u) % 300;
+        if (cache->get(key) == nullptr) {
+            cache->put(key, static_cast<double>(i));
+        }
+        if (i % 7 == 0) {
+            cache->remove(key + 1);
+        }
+    }
+    cache->clear();
+    assert(g_allocations.load() == before);
+    delete cache;
+
+    // The whole cache lives in the object.
+    static_assert(sizeof(StaticLRUCache<std::uint32_t, std::uint32_t, 16>) < 256,
+                  "16 entries fit in a few cache lines");
+    std::cout << "  sizeof(StaticLRUCache<uint32_t, uint32_t, 16>) = "
+              << sizeof(StaticLRUCache<std::uint32_t, std::uint32_t, 16>) << " bytes" << std::endl;
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testStringKeysBehindLock() {
+    std::cout << "Test 4: String Keys Behind an External Lock" << std::endl;
+    StaticLRUCache<std::string, int, 32> cache;
+    std::mutex lock;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, &lock, t]() {
+            for (int i = 0; i < 5000; i++) {
+                std::string key = "token:" + std::to_string((i * 7 + t) % 48);
+                std::lock_guard<std::mutex> guard(lock);
+                int* value = cache.get(key);
+                if (value == nullptr) {
+                    cache.put(key, 1);
+                } else {
+                    ++*value;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert(cache.size() == 32);
+    int total = 0;
+    cache.forEach([&total](const std::string& key, const int& count) {
+        assert(key.rfind("token:", 0) == 0);
+        total += count;
+    });
+    assert(total > 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Static LRU Cache Tests...\n" << std::endl;
+
+    testBasicOperations();
+    testMatchesLRUCache();
+    testNoAllocation();
+    testStringKeysBehindLock();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+#ifndef TIERED_CACHE_H
+#define TIERED_CACHE_H
+
+#include "LRUCache.h"
+#include "FileTier.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Counters reported by TieredCache::getStats().
+ */
+struct TieredCacheStats {
+    std::uint64_t memory_hits = 0;
+    std::uint64_t disk_hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t disk_keys = 0;
+    std::uint64_t disk_bytes = 0;
+    std::uint64_t dropped_writes = 0;
+};
+
+/**
+ * Two-tier cache: an LRUCache in memory in front of a FileTier on local SSD.
+ *
+ * Entries evicted from memory are handed to the file tier, which appends
+ * them asynchronously to a log-structured segment file. A memory miss looks
+ * the key up in the file tier; a hit there is removed from disk and promoted
+ * back into memory, so each key lives in at most one tier.
+ *
+ * Memory hits take only the LRUCache lock. put(), remove() and the miss path
+ * additionally hold a per-key stripe lock, so a key cannot be promoted from
+ * disk while it is being written or removed.
+ *
+ * Time Complexity:
+ * - get (memory hit): O(1)
+ * - get (disk hit): O(1) plus one pread
+ * - put / remove: O(1); disk writes happen on the tier's writer thread
+ */
+class TieredCache {
+private:
+    static constexpr std::size_t kStripes = 64;
+
+    LRUCache<std::string, std::string> memory_;
+    FileTier disk_;
+    std::array<std::mutex, kStripes> stripes_;
+    std::atomic<std::uint64_t> memory_hits_{0};
+    std::atomic<std::uint64_t> disk_hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+
+    std::mutex& stripeFor(const std::string& key) {
+        return stripes_[std::hash<std::string>{}(key) % kStripes];
+    }
+
+public:
+    /**
+     * Initializes both tiers.
+     *
+     * @param memory_capacity The number of entries kept in memory
+     * @param disk_config Directory and limits of the file tier
+     * @throws std::invalid_argument if memory_capacity <= 0 or disk_config is invalid
+     * @throws std::system_error if the file tier cannot be created
+     */
+    TieredCache(int memory_capacity, const FileTierConfig& disk_config)
+        : memory_(memory_capacity), disk_(disk_config) {
+        memory_.setEvictionListener([this](const std::string& key, const std::string& value) {
+            disk_.putAsync(key, value);
+        });
+    }
+
+    /**
+     * Retrieves a value from memory, or from disk and promotes it to memory.
+     *
+     * @param key The key whose value is to be retrieved
+     * @return A shared_ptr to the value if found, nullptr otherwise
+     */
+    std::shared_ptr<std::string> get(const std::string& key) {
+        auto value = memory_.get(key);
+        if (value) {
+            memory_hits_.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+
+        std::lock_guard<std::mutex> guard(stripeFor(key));
+        // Re-check: another thread may have promoted the key meanwhile.
+        value = memory_.get(key);
+        if (value) {
+            memory_hits_.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+        value = disk_.get(key);
+        if (!value) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        disk_hits_.fetch_add(1, std::memory_order_relaxed);
+        disk_.remove(key);
+        memory_.put(key, *value);
+        return value;
+    }
+
+    /**
+     * Inserts or updates a key-value pair in memory. Any older copy on disk
+     * is discarded; the entry reaches disk again only when evicted.
+     *
+     * @param key The key to be inserted or updated
+     * @param value The value to be associated with the key
+     */
+    void put(const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> guard(stripeFor(key));
+        memory_.put(key, value);
+        disk_.remove(key);
+    }
+
+    /**
+     * Removes a key from both tiers.
+     *
+     * @param key The key of the entry to be removed
+     * @return true if either tier held the key
+     */
+    bool remove(const std::string& key) {
+        std::lock_guard<std::mutex> guard(stripeFor(key));
+        bool in_memory = memory_.remove(key);
+        bool on_disk = disk_.remove(key);
+        return in_memory || on_disk;
+    }
+
+    /**
+     * Blocks until every entry evicted so far has been written to disk.
+     */
+    void flush() {
+        disk_.flush();
+    }
+
+    /**
+     * Returns the number of entries held in memory.
+     *
+     * @return The memory tier size
+     */
+    int memorySize() const {
+        return memory_.size();
+    }
+
+    /**
+     * Returns hit, miss and disk usage counters.
+     *
+     * @return A snapshot of the counters
+     */
+    TieredCacheStats getStats() const {
+        TieredCacheStats stats;
+        stats.memory_hits = memory_hits_.load(std::memory_order_relaxed);
+        stats.disk_hits = disk_hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.disk_keys = disk_.size();
+        stats.disk_bytes = disk_.diskBytes();
+        stats.dropped_writes = disk_.droppedWrites();
+        return stats;
+    }
+};
+
+#endif // TIERED_CACHE_H
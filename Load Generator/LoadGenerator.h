@@ -0,0 +1,202 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include "../Metrics/Metrics.h"
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Settings for one open-loop run.
+ */
+struct LoadGeneratorConfig {
+    double rate_per_second = 100000;   // intended operations per second, all threads together
+    int threads = 4;
+    std::chrono::nanoseconds duration = std::chrono::seconds(10);
+    std::chrono::nanoseconds warmup = std::chrono::seconds(1);   // run but not recorded
+};
+
+/**
+ * Results of one open-loop run.
+ *
+ * Response time is measured from the time the operation was scheduled to
+ * start, so time spent waiting behind a slow operation counts. Service time
+ * is measured from the time it actually started, which is what a closed-loop
+ * benchmark reports; the gap between the two is the queueing delay that
+ * closed-loop measurement hides (coordinated omission).
+ */
+struct LoadReport {
+    HistogramSnapshot response_time;   // nanoseconds, from intended start
+    HistogramSnapshot service_time;    // nanoseconds, from actual start
+    std::uint64_t operations = 0;
+    std::uint64_t late_starts = 0;     // operations started > 1 interval after their slot
+    double seconds = 0;
+    double intended_rate = 0;
+
+    /**
+     * Returns the measured throughput.
+     *
+     * @return Completed operations per second
+     */
+    double achievedRate() const {
+        return seconds > 0 ? static_cast<double>(operations) / seconds : 0.0;
+    }
+
+    /**
+     * Renders response and service time side by side at fixed percentiles.
+     *
+     * @return A table with one row per percentile, values in microseconds
+     */
+    std::string percentileCurve() const {
+        static const double levels[] = {0.5, 0.75, 0.9, 0.95, 0.99, 0.999, 0.9999, 0.99999, 1.0};
+        std::ostringstream oss;
+        oss << std::fixed;
+        oss << std::setw(11) << "percentile" << std::setw(18) << "response (us)"
+            << std::setw(18) << "service (us)" << "\n";
+        for (double q : levels) {
+            std::uint64_t r = q == 1.0 ? response_time.max : response_time.percentile(q);
+            std::uint64_t s = q == 1.0 ? service_time.max : service_time.percentile(q);
+            oss << std::setw(11) << std::setprecision(3) << q * 100
+                << std::setw(18) << std::setprecision(3) << r / 1000.0
+                << std::setw(18) << std::setprecision(3) << s / 1000.0 << "\n";
+        }
+        return oss.str();
+    }
+
+    /**
+     * Renders a short summary followed by the percentile curve.
+     *
+     * @return The report text
+     */
+    std::string toString() const {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(0)
+            << "intended " << intended_rate << " ops/s, achieved " << achievedRate()
+            << " ops/s, " << operations << " ops, " << late_starts << " late starts\n"
+            << percentileCurve();
+        return oss.str();
+    }
+};
+
+/**
+ * Open-loop load generator.
+ *
+ * Operations are issued on a fixed schedule: with rate R and T threads, thread
+ * t owns the slots start + (i * T + t) / R. A thread waits for its next slot
+ * and, if it is already past it because the previous operation was slow,
+ * starts immediately without skipping the slot. Each operation's latency is
+ * taken from its slot, not from when it actually began.
+ */
+class LoadGenerator {
+private:
+    LoadGeneratorConfig config_;
+
+    static void waitUntil(std::chrono::steady_clock::time_point t) {
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= t) {
+                return;
+            }
+            // Sleep for long waits, spin for the last stretch: sleep wakes late.
+            if (t - now > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_for(t - now - std::chrono::microseconds(100));
+            }
+        }
+    }
+
+public:
+    /**
+     * Initializes a generator.
+     *
+     * @param config Rate, thread count, duration and warm-up
+     * @throws std::invalid_argument if the rate or thread count is not positive,
+     *         or the duration is not positive
+     */
+    explicit LoadGenerator(const LoadGeneratorConfig& config) : config_(config) {
+        if (config.rate_per_second <= 0) {
+            throw std::invalid_argument("Rate must be greater than 0");
+        }
+        if (config.threads <= 0) {
+            throw std::invalid_argument("Thread count must be greater than 0");
+        }
+        if (config.duration.count() <= 0) {
+            throw std::invalid_argument("Duration must be greater than 0");
+        }
+    }
+
+    /**
+     * Runs the schedule, calling op(thread, sequence) for every slot.
+     * op is called concurrently from config.threads threads and must be
+     * thread-safe; the sequence number is per thread.
+     *
+     * @param op The operation under test
+     * @return Latency histograms and counts for the measured (post warm-up) part
+     */
+    template <typename Op>
+    LoadReport run(Op&& op) {
+        Histogram response_time;
+        Histogram service_time;
+        std::vector<std::uint64_t> operations(config_.threads, 0);
+        std::vector<std::uint64_t> late(config_.threads, 0);
+
+        const double interval_ns = 1e9 / config_.rate_per_second;
+        const auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+        const auto measure_from = start + config_.warmup;
+        const auto end = measure_from + config_.duration;
+
+        auto worker = [&](int t) {
+            std::uint64_t ops = 0;
+            std::uint64_t late_starts = 0;
+            for (std::uint64_t i = 0;; i++) {
+                double slot = (static_cast<double>(i) * config_.threads + t) * interval_ns;
+                auto intended = start + std::chrono::nanoseconds(static_cast<std::int64_t>(slot));
+                if (intended >= end) {
+                    break;
+                }
+                waitUntil(intended);
+                auto begin = std::chrono::steady_clock::now();
+                op(t, i);
+                auto done = std::chrono::steady_clock::now();
+                if (intended < measure_from) {
+                    continue;
+                }
+                response_time.record(static_cast<std::uint64_t>((done - intended).count()));
+                service_time.record(static_cast<std::uint64_t>((done - begin).count()));
+                ops++;
+                if ((begin - intended).count() > interval_ns * config_.threads) {
+                    late_starts++;
+                }
+            }
+            operations[t] = ops;
+            late[t] = late_starts;
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < config_.threads; t++) {
+            threads.emplace_back(worker, t);
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        LoadReport report;
+        report.response_time = response_time.snapshot();
+        report.service_time = service_time.snapshot();
+        for (int t = 0; t < config_.threads; t++) {
+            report.operations += operations[t];
+            report.late_starts += late[t];
+        }
+        // Operations may finish after `end`; include that tail in the rate.
+        auto finished = std::chrono::steady_clock::now();
+        report.seconds = std::chrono::duration<double>(finished - measure_from).count();
+        report.intended_rate = config_.rate_per_second;
+        return report;
+    }
+};
+
+#endif // LOAD_GENERATOR_H
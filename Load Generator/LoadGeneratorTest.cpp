@@ -0,0 +1,156 @@
+#include "LoadGenerator.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for LoadGenerator.
+ *
+ * Tests cover:
+ * - Slots handed out on the fixed schedule, never early and never skipped
+ * - Warm-up slots run but not recorded
+ * - A slow operation raising the response time of the ones queued behind it,
+ *   but not their service time
+ * - Argument validation
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread LoadGeneratorTest.cpp -o load_generator_test
+ */
+
+namespace {
+
+struct Call {
+    int thread;
+    std::uint64_t sequence;
+    std::chrono::steady_clock::time_point at;
+};
+
+} // namespace
+
+void testSchedule() {
+    std::cout << "Test 1: Fixed Schedule" << std::endl;
+    LoadGeneratorConfig config;
+    config.rate_per_second = 1000;   // one slot per millisecond
+    config.threads = 2;
+    config.duration = std::chrono::milliseconds(100);
+    config.warmup = std::chrono::nanoseconds(0);
+
+    std::mutex lock;
+    std::vector<std::vector<Call>> calls(config.threads);
+    auto before = std::chrono::steady_clock::now();
+    LoadGenerator generator(config);
+    LoadReport report = generator.run([&](int t, std::uint64_t seq) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> guard(lock);
+        calls[t].push_back(Call{t, seq, now});
+    });
+
+    // 100 ms at 1000/s: thread 0 owns slots 0, 2, ..., 98 ms and thread 1
+    // owns 1, 3, ..., 99 ms, 50 each.
+    assert(report.operations == 100);
+    assert(report.response_time.count == 100);
+    assert(report.service_time.count == 100);
+    assert(report.intended_rate == 1000);
+    for (int t = 0; t < config.threads; t++) {
+        assert(calls[t].size() == 50);
+        for (std::uint64_t i = 0; i < calls[t].size(); i++) {
+            assert(calls[t][i].sequence == i);
+            // The run starts at least 10 ms after it is called, and no
+            // operation starts before its slot.
+            auto slot = std::chrono::milliseconds(10 + i * config.threads + t);
+            assert(calls[t][i].at >= before + slot);
+        }
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testWarmup() {
+    std::cout << "Test 2: Warm-up Runs but Is Not Recorded" << std::endl;
+    LoadGeneratorConfig config;
+    config.rate_per_second = 1000;
+    config.threads = 2;
+    config.duration = std::chrono::milliseconds(80);
+    config.warmup = std::chrono::milliseconds(20);
+
+    std::atomic<int> calls{0};
+    LoadGenerator generator(config);
+    LoadReport report = generator.run([&calls](int, std::uint64_t) { calls++; });
+    assert(calls == 100);
+    assert(report.operations == 80);
+    assert(report.response_time.count == 80);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSlowOperation() {
+    std::cout << "Test 3: A Stall Shows in Response Time, Not Service Time" << std::endl;
+    LoadGeneratorConfig config;
+    config.rate_per_second = 1000;
+    config.threads = 1;
+    config.duration = std::chrono::milliseconds(200);
+    config.warmup = std::chrono::nanoseconds(0);
+
+    LoadGenerator generator(config);
+    LoadReport report = generator.run([](int, std::uint64_t seq) {
+        if (seq == 50) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    });
+
+    const std::uint64_t ms = 1000000;
+    assert(report.operations == 200);
+    // Operation 50 + k cannot start before operation 50 ends, at least
+    // 50 ms after slot 50, so for k <= 40 it waits 10 ms or more.
+    assert(report.late_starts >= 40);
+    assert(report.response_time.max >= 50 * ms);
+    assert(report.response_time.percentile(0.9) >= 5 * ms);
+    // Only the stalled operation itself took long to run.
+    assert(report.service_time.max >= 50 * ms);
+    assert(report.service_time.percentile(0.9) < 5 * ms);
+    std::cout << "✓ Passed (response p90 " << report.response_time.percentile(0.9) / 1000
+              << " us, service p90 " << report.service_time.percentile(0.9) / 1000 << " us)\n"
+              << std::endl;
+}
+
+void testInvalidArguments() {
+    std::cout << "Test 4: Argument Validation" << std::endl;
+    int failures = 0;
+    LoadGeneratorConfig config;
+    config.rate_per_second = 0;
+    try {
+        LoadGenerator generator(config);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    config = LoadGeneratorConfig();
+    config.threads = 0;
+    try {
+        LoadGenerator generator(config);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    config = LoadGeneratorConfig();
+    config.duration = std::chrono::nanoseconds(0);
+    try {
+        LoadGenerator generator(config);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    assert(failures == 3);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Load Generator Tests...\n" << std::endl;
+
+    testSchedule();
+    testWarmup();
+    testSlowOperation();
+    testInvalidArguments();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
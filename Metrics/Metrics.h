@@ -0,0 +1,481 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "../Common/ThreadSlot.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Lock-free metrics shared by every component in the repository.
+ *
+ * - Counter:   monotonically increasing, striped over cache lines
+ * - Gauge:     a value that can go up and down
+ * - Histogram: log-linear buckets, one private bucket array per recording
+ *              thread, merged when read
+ * - MetricsRegistry: names metrics and renders them in the Prometheus text
+ *              exposition format
+ *
+ * Recording never takes a lock and never allocates after a thread's first
+ * record into a given metric. Registration and reads do take a lock.
+ */
+
+namespace metrics_detail {
+
+constexpr std::size_t kCacheLine = 64;
+constexpr int kCounterStripes = 16;
+
+/**
+ * Returns a small per-thread number used to pick counter stripes.
+ */
+inline unsigned threadStripe() {
+    static std::atomic<unsigned> next{0};
+    thread_local unsigned stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+/**
+ * Adds to an atomic owned by a single writer without a read-modify-write
+ * instruction. Readers on other threads may see a slightly stale value.
+ */
+inline void ownerAdd(std::atomic<std::uint64_t>& a, std::uint64_t delta) {
+    a.store(a.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // namespace metrics_detail
+
+/**
+ * A monotonically increasing count.
+ *
+ * Increments go to one of several cache-line sized stripes chosen by thread,
+ * so threads incrementing the same counter rarely share a cache line.
+ */
+class Counter {
+private:
+    struct alignas(metrics_detail::kCacheLine) Stripe {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    Stripe stripes_[metrics_detail::kCounterStripes];
+
+public:
+    /**
+     * Adds to the counter.
+     *
+     * @param delta The amount to add
+     */
+    void increment(std::uint64_t delta = 1) {
+        unsigned s = metrics_detail::threadStripe() % metrics_detail::kCounterStripes;
+        stripes_[s].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the sum over all stripes.
+     *
+     * @return The current count
+     */
+    std::uint64_t value() const {
+        std::uint64_t sum = 0;
+        for (const Stripe& s : stripes_) {
+            sum += s.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+};
+
+/**
+ * A value that can be set, raised and lowered, e.g. a queue depth.
+ */
+class Gauge {
+private:
+    std::atomic<std::int64_t> value_{0};
+
+public:
+    void set(std::int64_t value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    void add(std::int64_t delta) {
+        value_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    std::int64_t value() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * A merged, point-in-time view of a Histogram.
+ */
+class HistogramSnapshot {
+public:
+    std::vector<std::uint64_t> counts;
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t max = 0;
+
+    /**
+     * Returns an estimate of the value below which the fraction q of the
+     * recorded values fall. The estimate is within 1/16 of the true value.
+     *
+     * @param q The quantile, in [0, 1]
+     * @return The estimated value, or 0 if nothing was recorded
+     * @throws std::invalid_argument if q is outside [0, 1]
+     */
+    std::uint64_t percentile(double q) const;
+
+    /**
+     * Returns the arithmetic mean of the recorded values.
+     *
+     * @return The mean, or 0 if nothing was recorded
+     */
+    double mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+};
+
+/**
+ * Histogram of non-negative integer values (typically nanoseconds) with
+ * log-linear buckets: exact below 16, then 16 equal-width buckets per power
+ * of two, so every bucket is at most 1/16 of its value wide.
+ *
+ * Each recording thread writes only to its own bucket array, allocated on its
+ * first record, so record() is a handful of relaxed loads and stores with no
+ * lock and no contended cache line. snapshot() sums the per-thread arrays.
+ * Arrays of threads that have exited are kept, so their values still count.
+ */
+class Histogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBucketCount = kSubBuckets + (64 - kSubBits) * kSubBuckets;
+
+    /**
+     * Maps a value to its bucket index.
+     *
+     * @param value The value
+     * @return An index in [0, kBucketCount)
+     */
+    static int bucketIndex(std::uint64_t value) {
+        if (value < static_cast<std::uint64_t>(kSubBuckets)) {
+            return static_cast<int>(value);
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        int shift = exponent - kSubBits;
+        int sub = static_cast<int>(value >> shift) - kSubBuckets;
+        return kSubBuckets + shift * kSubBuckets + sub;
+    }
+
+    /**
+     * Returns the smallest value that maps to the bucket.
+     *
+     * @param index The bucket index
+     * @return The bucket's lower bound
+     */
+    static std::uint64_t bucketLowerBound(int index) {
+        if (index < kSubBuckets) {
+            return static_cast<std::uint64_t>(index);
+        }
+        int shift = (index - kSubBuckets) / kSubBuckets;
+        int sub = (index - kSubBuckets) % kSubBuckets;
+        return static_cast<std::uint64_t>(kSubBuckets + sub) << shift;
+    }
+
+    /**
+     * Returns the largest value that maps to the bucket.
+     *
+     * @param index The bucket index
+     * @return The bucket's upper bound
+     */
+    static std::uint64_t bucketUpperBound(int index) {
+        if (index < kSubBuckets) {
+            return static_cast<std::uint64_t>(index);
+        }
+        int shift = (index - kSubBuckets) / kSubBuckets;
+        return bucketLowerBound(index) + ((std::uint64_t{1} << shift) - 1);
+    }
+
+private:
+    struct Shard {
+        std::atomic<std::uint64_t> counts[kBucketCount];
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+
+        Shard() {
+            for (auto& c : counts) {
+                c.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    ThreadSlot slot_;
+    mutable std::mutex shards_lock_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& localShard() {
+        if (void* shard = slot_.get()) {
+            return *static_cast<Shard*>(shard);
+        }
+        return registerThread();
+    }
+
+    Shard& registerThread() {
+        std::lock_guard<std::mutex> guard(shards_lock_);
+        shards_.push_back(std::make_unique<Shard>());
+        slot_.set(shards_.back().get());
+        return *shards_.back();
+    }
+
+public:
+    Histogram() = default;
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * Records one value.
+     *
+     * @param value The value, e.g. a latency in nanoseconds
+     */
+    void record(std::uint64_t value) {
+        Shard& shard = localShard();
+        metrics_detail::ownerAdd(shard.counts[bucketIndex(value)], 1);
+        metrics_detail::ownerAdd(shard.count, 1);
+        metrics_detail::ownerAdd(shard.sum, value);
+        if (value > shard.max.load(std::memory_order_relaxed)) {
+            shard.max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Merges every thread's buckets into one snapshot.
+     *
+     * @return The merged snapshot
+     */
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot snap;
+        snap.counts.assign(kBucketCount, 0);
+        std::lock_guard<std::mutex> guard(shards_lock_);
+        for (const auto& shard : shards_) {
+            for (int i = 0; i < kBucketCount; i++) {
+                snap.counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+            }
+            snap.count += shard->count.load(std::memory_order_relaxed);
+            snap.sum += shard->sum.load(std::memory_order_relaxed);
+            std::uint64_t m = shard->max.load(std::memory_order_relaxed);
+            if (m > snap.max) {
+                snap.max = m;
+            }
+        }
+        return snap;
+    }
+};
+
+inline std::uint64_t HistogramSnapshot::percentile(double q) const {
+    if (q < 0.0 || q > 1.0) {
+        throw std::invalid_argument("Quantile must be in [0, 1]");
+    }
+    // Bucket counts and the total are read separately, so use the bucket sum.
+    std::uint64_t total = 0;
+    for (std::uint64_t c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // Nearest rank: the value with at least ceil(q * total) values at or
+    // below it, so p99 of 150 values is the 149th. The slack keeps rounding
+    // in the product (0.07 * 100 = 7.000000000000001) from adding a rank.
+    double exact = q * static_cast<double>(total);
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(exact * (1.0 - 1e-12)));
+    if (rank == 0) {
+        rank = 1;
+    }
+    std::uint64_t seen = 0;
+    for (int i = 0; i < static_cast<int>(counts.size()); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            std::uint64_t lo = Histogram::bucketLowerBound(i);
+            std::uint64_t hi = Histogram::bucketUpperBound(i);
+            std::uint64_t mid = lo + (hi - lo) / 2;
+            return mid < max ? mid : max;
+        }
+    }
+    return max;
+}
+
+/**
+ * Records the time between construction and destruction into a Histogram,
+ * in nanoseconds.
+ */
+class ScopedTimer {
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+/**
+ * Owns named metrics and renders them as Prometheus text.
+ *
+ * Lookups by name take a lock, so call sites should look a metric up once
+ * and keep the reference; references stay valid for the registry's lifetime.
+ */
+class MetricsRegistry {
+private:
+    template <typename M>
+    struct Entry {
+        std::string help;
+        std::unique_ptr<M> metric;
+    };
+
+    mutable std::mutex lock_;
+    std::map<std::string, Entry<Counter>> counters_;
+    std::map<std::string, Entry<Gauge>> gauges_;
+    std::map<std::string, Entry<Histogram>> histograms_;
+
+    static void validateName(const std::string& name) {
+        if (name.empty()) {
+            throw std::invalid_argument("Metric name must not be empty");
+        }
+        for (std::size_t i = 0; i < name.size(); i++) {
+            char c = name[i];
+            bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' ||
+                      (i > 0 && c >= '0' && c <= '9');
+            if (!ok) {
+                throw std::invalid_argument("Invalid metric name: " + name);
+            }
+        }
+    }
+
+    template <typename M>
+    M& getOrCreate(std::map<std::string, Entry<M>>& metrics, const std::string& name,
+                   const std::string& help) {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = metrics.find(name);
+        if (it != metrics.end()) {
+            return *it->second.metric;
+        }
+        validateName(name);
+        if (counters_.count(name) + gauges_.count(name) + histograms_.count(name) > 0) {
+            throw std::invalid_argument("Metric already registered with another type: " + name);
+        }
+        Entry<M>& entry = metrics[name];
+        entry.help = help;
+        entry.metric = std::make_unique<M>();
+        return *entry.metric;
+    }
+
+    static void writeHeader(std::ostringstream& oss, const std::string& name,
+                            const std::string& help, const char* type) {
+        if (!help.empty()) {
+            oss << "# HELP " << name << " " << help << "\n";
+        }
+        oss << "# TYPE " << name << " " << type << "\n";
+    }
+
+public:
+    /**
+     * Returns the process-wide registry.
+     *
+     * @return The global registry
+     */
+    static MetricsRegistry& global() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    /**
+     * Returns the counter with the given name, creating it if needed.
+     *
+     * @param name The metric name ([a-zA-Z_:][a-zA-Z0-9_:]*)
+     * @param help Description used when the counter is created
+     * @return The counter
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    Counter& counter(const std::string& name, const std::string& help = "") {
+        return getOrCreate(counters_, name, help);
+    }
+
+    /**
+     * Returns the gauge with the given name, creating it if needed.
+     *
+     * @param name The metric name
+     * @param help Description used when the gauge is created
+     * @return The gauge
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    Gauge& gauge(const std::string& name, const std::string& help = "") {
+        return getOrCreate(gauges_, name, help);
+    }
+
+    /**
+     * Returns the histogram with the given name, creating it if needed.
+     *
+     * @param name The metric name
+     * @param help Description used when the histogram is created
+     * @return The histogram
+     * @throws std::invalid_argument if the name is invalid or used by another type
+     */
+    Histogram& histogram(const std::string& name, const std::string& help = "") {
+        return getOrCreate(histograms_, name, help);
+    }
+
+    /**
+     * Renders every metric in the Prometheus text exposition format.
+     * Histograms are rendered as summaries with quantiles 0.5, 0.9, 0.99,
+     * 0.999 and 1 (the maximum).
+     *
+     * @return The exposition text
+     */
+    std::string exposition() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::ostringstream oss;
+        for (const auto& [name, entry] : counters_) {
+            writeHeader(oss, name, entry.help, "counter");
+            oss << name << " " << entry.metric->value() << "\n";
+        }
+        for (const auto& [name, entry] : gauges_) {
+            writeHeader(oss, name, entry.help, "gauge");
+            oss << name << " " << entry.metric->value() << "\n";
+        }
+        for (const auto& [name, entry] : histograms_) {
+            writeHeader(oss, name, entry.help, "summary");
+            HistogramSnapshot snap = entry.metric->snapshot();
+            static const std::pair<const char*, double> quantiles[] = {
+                {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+            for (const auto& [label, q] : quantiles) {
+                oss << name << "{quantile=\"" << label << "\"} " << snap.percentile(q) << "\n";
+            }
+            oss << name << "{quantile=\"1\"} " << snap.max << "\n";
+            oss << name << "_sum " << snap.sum << "\n";
+            oss << name << "_count " << snap.count << "\n";
+        }
+        return oss.str();
+    }
+};
+
+#endif // METRICS_H
@@ -0,0 +1,168 @@
+#include "Metrics.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * Test cases for the metrics module.
+ *
+ * Tests cover:
+ * - Histogram bucket boundaries and percentile accuracy
+ * - Merging per-thread histograms and counters
+ * - Registry lookup, type conflicts and exposition output
+ * - Cost of a single record (printed, not asserted)
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread MetricsTest.cpp -o metrics_test
+ */
+
+void testBucketBoundaries() {
+    std::cout << "Test 1: Histogram Bucket Boundaries" << std::endl;
+    for (std::uint64_t v : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 31ULL, 32ULL, 1000ULL,
+                            123456789ULL, ~0ULL}) {
+        int i = Histogram::bucketIndex(v);
+        assert(i >= 0 && i < Histogram::kBucketCount);
+        assert(Histogram::bucketLowerBound(i) <= v && v <= Histogram::bucketUpperBound(i));
+        // Relative bucket width never exceeds 1/16.
+        std::uint64_t width = Histogram::bucketUpperBound(i) - Histogram::bucketLowerBound(i);
+        assert(width <= Histogram::bucketLowerBound(i) / 16);
+    }
+    for (int i = 1; i < Histogram::kBucketCount; i++) {
+        assert(Histogram::bucketLowerBound(i) == Histogram::bucketUpperBound(i - 1) + 1);
+    }
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testPercentiles() {
+    std::cout << "Test 2: Percentile Accuracy" << std::endl;
+    Histogram h;
+    for (std::uint64_t v = 1; v <= 100000; v++) {
+        h.record(v);
+    }
+    HistogramSnapshot snap = h.snapshot();
+    assert(snap.count == 100000);
+    assert(snap.max == 100000);
+    assert(snap.mean() == 50000.5);
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double expected = q * 100000;
+        double got = static_cast<double>(snap.percentile(q));
+        assert(got >= expected * (1 - 1.0 / 16) && got <= expected * (1 + 1.0 / 16));
+    }
+    assert(snap.percentile(1.0) == 100000);
+    assert(HistogramSnapshot().percentile(0.5) == 0);
+
+    // Nearest rank rounds up: p99 of 150 values is the 149th, not the 148th.
+    Histogram ranks;
+    for (int i = 0; i < 148; i++) {
+        ranks.record(1);
+    }
+    ranks.record(5);
+    ranks.record(5);
+    assert(ranks.snapshot().percentile(0.99) == 5);
+    assert(ranks.snapshot().percentile(148.0 / 150) == 1);
+
+    // ...but a product that is a whole number up to rounding stays put.
+    Histogram exact;
+    for (int i = 0; i < 100; i++) {
+        exact.record(i < 7 ? 1 : 2);
+    }
+    assert(exact.snapshot().percentile(0.07) == 1);
+    assert(exact.snapshot().percentile(0.071) == 2);
+    assert(exact.snapshot().percentile(0.0) == 1);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testConcurrentRecording() {
+    std::cout << "Test 3: Concurrent Recording Merges on Read" << std::endl;
+    Histogram h;
+    Counter c;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&h, &c, t]() {
+            for (int i = 0; i < 100000; i++) {
+                h.record(static_cast<std::uint64_t>(t * 1000 + i % 1000));
+                c.increment();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    HistogramSnapshot snap = h.snapshot();
+    assert(snap.count == 800000);
+    assert(snap.max == 7999);
+    assert(c.value() == 800000);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRegistryExposition() {
+    std::cout << "Test 4: Registry and Exposition" << std::endl;
+    MetricsRegistry registry;
+    Counter& hits = registry.counter("cache_hits_total", "Cache hits");
+    assert(&registry.counter("cache_hits_total") == &hits);
+    hits.increment(3);
+    registry.gauge("queue_depth").set(-2);
+    registry.histogram("get_latency_ns", "get() latency").record(100);
+
+    bool threw = false;
+    try {
+        registry.gauge("cache_hits_total");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        registry.counter("9bad name");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::string text = registry.exposition();
+    assert(text.find("# HELP cache_hits_total Cache hits\n") != std::string::npos);
+    assert(text.find("# TYPE cache_hits_total counter\ncache_hits_total 3\n") != std::string::npos);
+    assert(text.find("queue_depth -2\n") != std::string::npos);
+    assert(text.find("# TYPE get_latency_ns summary\n") != std::string::npos);
+    assert(text.find("get_latency_ns{quantile=\"0.99\"} 100\n") != std::string::npos);
+    assert(text.find("get_latency_ns_count 1\n") != std::string::npos);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testRecordCost() {
+    std::cout << "Test 5: Record Cost" << std::endl;
+    Histogram h;
+    Counter c;
+    const int n = 10'000'000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        h.record(static_cast<std::uint64_t>(i) & 0xffff);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        c.increment();
+    }
+    auto end = std::chrono::steady_clock::now();
+    assert(h.snapshot().count == static_cast<std::uint64_t>(n));
+    auto ns = [n](auto d) {
+        return std::chrono::duration<double, std::nano>(d).count() / n;
+    };
+    std::cout << "  Histogram::record " << ns(mid - start) << " ns, Counter::increment "
+              << ns(end - mid) << " ns" << std::endl;
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Metrics Tests...\n" << std::endl;
+
+    testBucketBoundaries();
+    testPercentiles();
+    testConcurrentRecording();
+    testRegistryExposition();
+    testRecordCost();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
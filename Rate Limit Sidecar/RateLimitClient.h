@@ -0,0 +1,157 @@
+#ifndef RATE_LIMIT_CLIENT_H
+#define RATE_LIMIT_CLIENT_H
+
+#include "RateLimitProtocol.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <system_error>
+#include <stdexcept>
+
+/**
+ * Blocking client for the rate-limit sidecar.
+ *
+ * One instance owns one Unix socket connection and is not thread-safe;
+ * give each thread its own client. tryAcquireBatch() sends any number of
+ * decisions in one write and collects all answers, which is where the
+ * sidecar's per-decision cost becomes small.
+ */
+class RateLimitClient {
+private:
+    int fd_ = -1;
+    uint32_t next_id_ = 0;
+    std::string out_;
+    std::string in_;
+
+    void sendAll() {
+        std::size_t off = 0;
+        while (off < out_.size()) {
+            ssize_t n = ::send(fd_, out_.data() + off, out_.size() - off, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::system_error(errno, std::generic_category(), "send");
+            }
+            off += static_cast<std::size_t>(n);
+        }
+        out_.clear();
+    }
+
+    void receive(std::size_t bytes) {
+        char buf[16 * 1024];
+        while (in_.size() < bytes) {
+            ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::system_error(n == 0 ? ECONNRESET : errno, std::generic_category(), "recv");
+            }
+            in_.append(buf, static_cast<std::size_t>(n));
+        }
+    }
+
+public:
+    /**
+     * Connects to a sidecar listening on a Unix domain socket.
+     *
+     * @param path The socket path
+     * @throws std::system_error if the connection fails
+     */
+    explicit RateLimitClient(const std::string& path) {
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            ::close(fd_);
+            throw std::invalid_argument("Unix socket path too long: " + path);
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            int saved = errno;
+            ::close(fd_);
+            throw std::system_error(saved, std::generic_category(), "connect");
+        }
+    }
+
+    /**
+     * Takes over a socket already connected to a sidecar, such as one end
+     * of a socketpair.
+     *
+     * @param fd The connected socket; the client closes it
+     * @throws std::invalid_argument if fd is negative
+     */
+    explicit RateLimitClient(int fd) : fd_(fd) {
+        if (fd < 0) {
+            throw std::invalid_argument("Socket must be a valid descriptor");
+        }
+    }
+
+    RateLimitClient(const RateLimitClient&) = delete;
+    RateLimitClient& operator=(const RateLimitClient&) = delete;
+
+    /**
+     * Asks whether `permits` tokens may be taken from the bucket of `key`.
+     *
+     * @return true if allowed, false if denied
+     * @throws std::invalid_argument if the sidecar rejects the request as malformed
+     */
+    bool tryAcquire(const std::string& key, uint32_t permits = 1) {
+        return tryAcquireBatch({{key, permits}})[0];
+    }
+
+    /**
+     * Sends every decision in one write and waits for all answers.
+     *
+     * @param requests (key, permits) pairs
+     * @return One allow/deny flag per request, in request order
+     * @throws std::system_error on connection failure
+     * @throws std::invalid_argument if the sidecar rejects a request as malformed
+     */
+    std::vector<bool> tryAcquireBatch(const std::vector<std::pair<std::string, uint32_t>>& requests) {
+        using namespace ratelimit_proto;
+        uint32_t first_id = next_id_;
+        for (const auto& req : requests) {
+            if (req.first.size() > kMaxKeyLength) {
+                throw std::invalid_argument("Key too long");
+            }
+            encodeRequest(out_, next_id_++, req.first, req.second);
+        }
+        sendAll();
+        receive(requests.size() * kResponseSize);
+
+        std::vector<bool> results(requests.size());
+        bool bad = false;
+        for (std::size_t i = 0; i < requests.size(); i++) {
+            const char* p = in_.data() + i * kResponseSize;
+            if (get32(p) != first_id + static_cast<uint32_t>(i)) {
+                throw std::runtime_error("Rate limit sidecar response out of order");
+            }
+            auto status = static_cast<Status>(static_cast<unsigned char>(p[4]));
+            bad |= status == kBadRequest;
+            results[i] = status == kAllowed;
+        }
+        in_.erase(0, requests.size() * kResponseSize);
+        if (bad) {
+            throw std::invalid_argument("Rate limit sidecar rejected a malformed request");
+        }
+        return results;
+    }
+
+    ~RateLimitClient() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+};
+
+#endif // RATE_LIMIT_CLIENT_H
@@ -0,0 +1,105 @@
+#ifndef RATE_LIMIT_PROTOCOL_H
+#define RATE_LIMIT_PROTOCOL_H
+
+#include "../Cache Server/EpollServer.h"
+#include "../Token Bucket Rate Limiter/KeyedRateLimiter.h"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Wire format of the rate-limit sidecar. All integers are little-endian.
+ *
+ *   Request  (10 + key_len bytes): u32 id | u32 permits | u16 key_len | key
+ *   Response (5 bytes):            u32 id | u8 status
+ *
+ * Requests on a connection are answered in order; the id is echoed so a
+ * client can match responses without relying on that.
+ */
+namespace ratelimit_proto {
+
+constexpr std::size_t kRequestHeaderSize = 10;
+constexpr std::size_t kResponseSize = 5;
+constexpr std::size_t kMaxKeyLength = 1024;
+
+enum Status : uint8_t {
+    kDenied = 0,
+    kAllowed = 1,
+    kBadRequest = 2,
+};
+
+inline void put16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v & 0xff));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+inline void put32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+inline uint16_t get16(const char* p) {
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(u[0] | (u[1] << 8));
+}
+
+inline uint32_t get32(const char* p) {
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+           (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+inline void encodeRequest(std::string& out, uint32_t id, const std::string& key, uint32_t permits) {
+    put32(out, id);
+    put32(out, permits);
+    put16(out, static_cast<uint16_t>(key.size()));
+    out.append(key);
+}
+
+inline void encodeResponse(std::string& out, uint32_t id, Status status) {
+    put32(out, id);
+    out.push_back(static_cast<char>(status));
+}
+
+} // namespace ratelimit_proto
+
+/**
+ * Server side of the sidecar protocol: decodes every complete request in
+ * the input and appends one response per request, so a batch of decisions
+ * costs one read and one write on each side.
+ */
+class RateLimitSession : public ProtocolSession {
+private:
+    KeyedRateLimiter& limiter_;
+    std::string key_;
+
+public:
+    explicit RateLimitSession(KeyedRateLimiter& limiter) : limiter_(limiter) {}
+
+    std::size_t onData(const char* data, std::size_t len, std::string& out,
+                       std::size_t out_limit) override {
+        using namespace ratelimit_proto;
+        std::size_t pos = 0;
+        while (len - pos >= kRequestHeaderSize && out.size() < out_limit) {
+            const char* p = data + pos;
+            uint32_t id = get32(p);
+            uint32_t permits = get32(p + 4);
+            uint16_t key_len = get16(p + 8);
+            if (len - pos < kRequestHeaderSize + key_len) {
+                break;
+            }
+            if (permits == 0 || key_len == 0 || key_len > kMaxKeyLength) {
+                encodeResponse(out, id, kBadRequest);
+            } else {
+                key_.assign(p + kRequestHeaderSize, key_len);
+                bool allowed = limiter_.tryAcquire(key_, static_cast<long>(permits));
+                encodeResponse(out, id, allowed ? kAllowed : kDenied);
+            }
+            pos += kRequestHeaderSize + key_len;
+        }
+        return pos;
+    }
+};
+
+#endif // RATE_LIMIT_PROTOCOL_H
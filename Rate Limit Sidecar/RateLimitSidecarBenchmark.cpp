@@ -0,0 +1,107 @@
+#include "RateLimitClient.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Measures decision round trips against a running rate-limit sidecar.
+ *
+ * Each thread owns one client and repeatedly sends `--batch` decisions in
+ * one write. Reported latency is the round trip of a whole batch; with
+ * --batch 1 that is the single-decision round trip.
+ *
+ * Usage:
+ *   ratelimit_bench [--unix /tmp/ratelimit.sock] [--threads 1] [--batch 1]
+ *                   [--keys 1000] [--seconds 5]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread RateLimitSidecarBenchmark.cpp -o ratelimit_bench
+ */
+
+int main(int argc, char** argv) {
+    std::string path = "/tmp/ratelimit.sock";
+    int threads = 1;
+    int batch = 1;
+    int keys = 1000;
+    int seconds = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string val = argv[i + 1];
+        if (arg == "--unix") {
+            path = val;
+        } else if (arg == "--threads") {
+            threads = std::stoi(val);
+        } else if (arg == "--batch") {
+            batch = std::stoi(val);
+        } else if (arg == "--keys") {
+            keys = std::stoi(val);
+        } else if (arg == "--seconds") {
+            seconds = std::stoi(val);
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<uint64_t>> rtts(threads);
+    std::vector<uint64_t> allowed(threads, 0);
+    std::vector<uint64_t> decisions(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            try {
+                RateLimitClient client(path);
+                std::vector<std::pair<std::string, uint32_t>> requests(batch);
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (auto& req : requests) {
+                        req = {"user:" + std::to_string((n++ * 2654435761u) % keys), 1};
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    auto results = client.tryAcquireBatch(requests);
+                    rtts[t].push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count()));
+                    decisions[t] += results.size();
+                    allowed[t] += static_cast<uint64_t>(std::count(results.begin(), results.end(), true));
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "thread " << t << ": " << e.what() << std::endl;
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true);
+    for (auto& w : workers) {
+        w.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<uint64_t> all;
+    uint64_t total = 0;
+    uint64_t total_allowed = 0;
+    for (int t = 0; t < threads; t++) {
+        all.insert(all.end(), rtts[t].begin(), rtts[t].end());
+        total += decisions[t];
+        total_allowed += allowed[t];
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&](double p) {
+        return all.empty() ? 0.0 : all[static_cast<std::size_t>(p * (all.size() - 1))] / 1000.0;
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "decisions:  " << total << " (" << total_allowed << " allowed) in " << elapsed << "s\n";
+    std::cout << "throughput: " << total / elapsed << " decisions/s\n";
+    std::cout << "batch rtt us: p50=" << pct(0.50) << " p99=" << pct(0.99)
+              << " p99.9=" << pct(0.999) << " max=" << pct(1.0) << std::endl;
+    return 0;
+}
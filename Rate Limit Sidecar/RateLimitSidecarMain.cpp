@@ -0,0 +1,91 @@
+#include "RateLimitProtocol.h"
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+/**
+ * Host-local rate-limit decision daemon.
+ *
+ * Every process on the host asks this one sidecar, so a key's limit is
+ * enforced once for the whole host instead of being split across processes.
+ *
+ * Usage:
+ *   ratelimit_sidecar [--unix /tmp/ratelimit.sock] [--threads N]
+ *                     [--capacity N] [--rate N] [--max-keys N]
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread RateLimitSidecarMain.cpp -o ratelimit_sidecar
+ */
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--unix PATH] [--threads N] [--capacity N] [--rate N] [--max-keys N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    config.tcp_port = -1;
+    config.unix_path = "/tmp/ratelimit.sock";
+    config.threads = 2;
+    long capacity = 100;
+    long rate = 10;
+    long max_keys = 1'000'000;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        std::string val = argv[++i];
+        if (arg == "--unix") {
+            config.unix_path = val;
+        } else if (arg == "--threads") {
+            config.threads = std::stoi(val);
+        } else if (arg == "--capacity") {
+            capacity = std::stol(val);
+        } else if (arg == "--rate") {
+            rate = std::stol(val);
+        } else if (arg == "--max-keys") {
+            max_keys = std::stol(val);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try {
+        KeyedRateLimiter limiter(capacity, rate, static_cast<std::size_t>(max_keys));
+        EpollServer server(config, [&limiter]() {
+            return std::make_unique<RateLimitSession>(limiter);
+        });
+        server.start();
+        std::cout << "ratelimit_sidecar: " << server.loopCount() << " event loops on "
+                  << config.unix_path << ", capacity " << capacity << ", rate " << rate
+                  << "/s per key" << std::endl;
+        while (!g_stop) {
+            ::pause();
+        }
+        server.stop();
+    } catch (const std::exception& e) {
+        std::cerr << "ratelimit_sidecar: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include "RateLimitClient.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * Test cases for the rate-limit sidecar protocol, RateLimitSession and
+ * RateLimitClient.
+ *
+ * Tests cover:
+ * - Little-endian frame encoding and decoding
+ * - Requests split across reads, down to single bytes
+ * - Malformed and oversized requests answered without losing step
+ * - One reply per request, in order, and stopping at the output limit
+ * - A client and a session round trip over a socketpair
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread RateLimitSidecarTest.cpp -o ratelimit_sidecar_test
+ */
+
+namespace {
+
+using namespace ratelimit_proto;
+
+/**
+ * Buffers input the way the server does: whatever the session leaves
+ * unconsumed is kept and handed back with the next bytes.
+ */
+class Feeder {
+private:
+    RateLimitSession session_;
+    std::string in_;
+
+public:
+    explicit Feeder(KeyedRateLimiter& limiter) : session_(limiter) {}
+
+    /**
+     * Feeds bytes to the session and returns the responses they produced.
+     */
+    std::string feed(const std::string& bytes) {
+        in_ += bytes;
+        std::string out;
+        std::size_t used = session_.onData(in_.data(), in_.size(), out, std::string::npos);
+        in_.erase(0, used);
+        return out;
+    }
+
+    std::size_t buffered() const { return in_.size(); }
+};
+
+std::string request(uint32_t id, const std::string& key, uint32_t permits) {
+    std::string out;
+    encodeRequest(out, id, key, permits);
+    return out;
+}
+
+std::string response(uint32_t id, Status status) {
+    std::string out;
+    encodeResponse(out, id, status);
+    return out;
+}
+
+} // namespace
+
+void testEncoding() {
+    std::cout << "Test 1: Frame Encoding and Decoding" << std::endl;
+    std::string out;
+    put16(out, 0xbeef);
+    put32(out, 0xdeadbeef);
+    assert(out == std::string("\xef\xbe\xef\xbe\xad\xde", 6));
+    assert(get16(out.data()) == 0xbeef);
+    assert(get32(out.data() + 2) == 0xdeadbeef);
+
+    std::string req = request(0x01020304, "key", 0xfffffffe);
+    assert(req.size() == kRequestHeaderSize + 3);
+    assert(req == std::string("\x04\x03\x02\x01\xfe\xff\xff\xff\x03\x00key", 13));
+    assert(get32(req.data()) == 0x01020304);
+    assert(get32(req.data() + 4) == 0xfffffffe);
+    assert(get16(req.data() + 8) == 3);
+
+    std::string resp = response(0xffffffff, kBadRequest);
+    assert(resp.size() == kResponseSize);
+    assert(resp == std::string("\xff\xff\xff\xff\x02", 5));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSplitRequests() {
+    std::cout << "Test 2: Requests Split Across Reads" << std::endl;
+    KeyedRateLimiter limiter(10, 1);
+    Feeder feeder(limiter);
+
+    // One byte at a time: nothing is answered until the key is complete.
+    std::string req = request(7, "alice", 3);
+    for (std::size_t i = 0; i + 1 < req.size(); i++) {
+        assert(feeder.feed(req.substr(i, 1)).empty());
+    }
+    assert(feeder.feed(req.substr(req.size() - 1)) == response(7, kAllowed));
+    assert(feeder.buffered() == 0);
+    assert(limiter.getAvailableTokens("alice") == 7);
+
+    // Two requests cut inside the header of the second, then inside its key.
+    std::string both = request(8, "alice", 3) + request(9, "bob", 1);
+    assert(feeder.feed(both.substr(0, 20)) == response(8, kAllowed));
+    assert(feeder.feed(both.substr(20, 7)).empty());
+    assert(feeder.buffered() == 12);
+    assert(feeder.feed(both.substr(27)) == response(9, kAllowed));
+    assert(feeder.buffered() == 0);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testMalformedRequests() {
+    std::cout << "Test 3: Malformed and Oversized Requests" << std::endl;
+    KeyedRateLimiter limiter(10, 1);
+    Feeder feeder(limiter);
+
+    assert(feeder.feed(request(1, "alice", 0)) == response(1, kBadRequest));
+    assert(feeder.feed(request(2, "", 1)) == response(2, kBadRequest));
+    assert(feeder.feed(request(3, std::string(kMaxKeyLength, 'k'), 1)) == response(3, kAllowed));
+
+    // An oversized key is still read in full, so the next request decodes.
+    std::string big = request(4, std::string(kMaxKeyLength + 1, 'k'), 1) + request(5, "alice", 1);
+    assert(feeder.feed(big.substr(0, 600)).empty());
+    assert(feeder.feed(big.substr(600)) == response(4, kBadRequest) + response(5, kAllowed));
+    assert(feeder.buffered() == 0);
+    assert(limiter.getAvailableTokens("alice") == 9);
+
+    // More permits than a bucket holds are denied, not rejected.
+    assert(feeder.feed(request(6, "bob", 0xffffffff)) == response(6, kDenied));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testReplyOrdering() {
+    std::cout << "Test 4: One Reply per Request, in Order" << std::endl;
+    KeyedRateLimiter limiter(5, 1);
+    RateLimitSession session(limiter);
+
+    std::string in;
+    std::string expected;
+    for (uint32_t id = 0; id < 100; id++) {
+        std::string key = "k" + std::to_string(id % 10);
+        in += request(id, key, 1);
+        // Each of the 10 keys allows its first 5 requests.
+        expected += response(id, id < 50 ? kAllowed : kDenied);
+    }
+    std::string out;
+    assert(session.onData(in.data(), in.size(), out, std::string::npos) == in.size());
+    assert(out == expected);
+
+    // The session stops once the output reaches the limit and leaves the
+    // rest unconsumed.
+    std::string two = request(200, "x", 1) + request(201, "x", 1);
+    out.clear();
+    std::size_t used = session.onData(two.data(), two.size(), out, 1);
+    assert(used == two.size() / 2);
+    assert(out == response(200, kAllowed));
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testClientRoundTrip() {
+    std::cout << "Test 5: Client and Session over a Socketpair" << std::endl;
+    int fds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    KeyedRateLimiter limiter(3, 1);
+
+    // A minimal sidecar: every read is run through the session and all of
+    // its replies are written back before the next read.
+    std::thread sidecar([&limiter, fd = fds[1]]() {
+        RateLimitSession session(limiter);
+        std::string in;
+        std::string out;
+        char buf[4096];
+        while (true) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                break;
+            }
+            in.append(buf, static_cast<std::size_t>(n));
+            in.erase(0, session.onData(in.data(), in.size(), out, std::string::npos));
+            assert(::send(fd, out.data(), out.size(), 0) == static_cast<ssize_t>(out.size()));
+            out.clear();
+        }
+        ::close(fd);
+    });
+
+    {
+        RateLimitClient client(fds[0]);
+        assert(client.tryAcquire("alice", 2));
+        assert(!client.tryAcquire("alice", 2));
+        assert(client.tryAcquire("alice"));
+
+        std::vector<std::pair<std::string, uint32_t>> batch;
+        for (int i = 0; i < 500; i++) {
+            batch.emplace_back("user" + std::to_string(i % 100), 1);
+        }
+        std::vector<bool> results = client.tryAcquireBatch(batch);
+        assert(results.size() == batch.size());
+        for (std::size_t i = 0; i < results.size(); i++) {
+            assert(results[i] == (i < 300));  // three permits for each of 100 users
+        }
+
+        // A request the sidecar rejects throws, and the connection stays in step.
+        bool threw = false;
+        try {
+            client.tryAcquireBatch({{"bob", 1}, {"bob", 0}, {"bob", 1}});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(limiter.getAvailableTokens("bob") == 1);
+        threw = false;
+        try {
+            client.tryAcquire(std::string(kMaxKeyLength + 1, 'k'));
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(client.tryAcquire("bob"));
+        assert(!client.tryAcquire("bob"));
+    }
+    sidecar.join();
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Rate Limit Sidecar Tests...\n" << std::endl;
+
+    testEncoding();
+    testSplitRequests();
+    testMalformedRequests();
+    testReplyOrdering();
+    testClientRoundTrip();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,213 @@
+#ifndef KEYED_RATE_LIMITER_H
+#define KEYED_RATE_LIMITER_H
+
+#include "TokenBucketRateLimiter.h"
+#include "../Common/Hash.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+
+/**
+ * Per-key token bucket rate limiter.
+ *
+ * Each distinct key (user, API key, tenant, ...) gets its own
+ * TokenBucketRateLimiter, created on first use with the default capacity
+ * and refill rate. Buckets are spread over independently locked shards so
+ * decisions for different keys rarely contend.
+ *
+ * A bucket that has refilled to capacity is indistinguishable from a new
+ * one, so when a shard grows past its key budget those buckets are dropped
+ * without changing any decision. A sweep that leaves the shard over half
+ * its new size defers the next one until the shard has doubled, so while
+ * every bucket is busy each new key pays O(1) amortized sweep work rather
+ * than a scan of the whole shard.
+ *
+ * Each bucket stores the full std::hash of its key, which both picks the
+ * shard and indexes the shard's map, so the key is hashed at most once per
+ * call and never on rehash. Callers that already hold the hash can pass it.
+ */
+class KeyedRateLimiter {
+private:
+    struct Entry {
+        std::string key;
+        std::size_t hash;
+        TokenBucketRateLimiter bucket;
+
+        Entry(const std::string& k, std::size_t h, long capacity, long refill_rate)
+            : key(k), hash(h), bucket(capacity, refill_rate) {}
+    };
+
+    // Map key: the entry's own key (or the caller's, for lookups) with its hash.
+    struct KeyRef {
+        const std::string* key;
+        std::size_t hash;
+    };
+
+    struct KeyRefHash {
+        std::size_t operator()(const KeyRef& ref) const noexcept {
+            return ref.hash;
+        }
+    };
+
+    struct KeyRefEqual {
+        bool operator()(const KeyRef& a, const KeyRef& b) const {
+            return a.hash == b.hash && *a.key == *b.key;
+        }
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<KeyRef, std::unique_ptr<Entry>, KeyRefHash, KeyRefEqual> buckets;
+        std::size_t sweep_at = 0;   // size at which the next new key sweeps
+    };
+
+    long capacity_;
+    long refill_rate_;
+    std::size_t max_keys_per_shard_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& shardFor(std::size_t hash) {
+        // Mix, so the shard index is independent of the bucket index that
+        // the shard's map derives from the same hash.
+        return *shards_[fmix64(hash) % shards_.size()];
+    }
+
+    /**
+     * Drops buckets that have refilled to full capacity. Called with the
+     * shard lock held.
+     */
+    void sweep(Shard& shard) {
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            if (it->second->bucket.getRefilledTokens() >= capacity_) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    TokenBucketRateLimiter& bucketLocked(Shard& shard, const std::string& key, std::size_t hash) {
+        auto it = shard.buckets.find(KeyRef{&key, hash});
+        if (it != shard.buckets.end()) {
+            return it->second->bucket;
+        }
+        if (shard.buckets.size() >= shard.sweep_at) {
+            sweep(shard);
+            shard.sweep_at = std::max(max_keys_per_shard_, 2 * shard.buckets.size());
+        }
+        auto entry = std::make_unique<Entry>(key, hash, capacity_, refill_rate_);
+        Entry& ref = *entry;
+        shard.buckets.emplace(KeyRef{&ref.key, hash}, std::move(entry));
+        return ref.bucket;
+    }
+
+public:
+    /**
+     * Constructs a KeyedRateLimiter.
+     *
+     * @param capacity The bucket capacity given to every key
+     * @param refill_rate The tokens per second given to every key
+     * @param max_keys Soft limit on tracked keys before idle buckets are swept
+     * @param shard_count The number of independently locked shards
+     * @throws std::invalid_argument if any argument is <= 0
+     */
+    KeyedRateLimiter(long capacity, long refill_rate,
+                     std::size_t max_keys = 1'000'000, int shard_count = 64)
+        : capacity_(capacity), refill_rate_(refill_rate) {
+        if (capacity <= 0 || refill_rate <= 0) {
+            throw std::invalid_argument("Capacity and refill rate must be greater than 0");
+        }
+        if (max_keys == 0 || shard_count <= 0) {
+            throw std::invalid_argument("Key limit and shard count must be greater than 0");
+        }
+        max_keys_per_shard_ = (max_keys + shard_count - 1) / shard_count;
+        shards_.reserve(shard_count);
+        for (int i = 0; i < shard_count; i++) {
+            shards_.push_back(std::make_unique<Shard>());
+            shards_.back()->sweep_at = max_keys_per_shard_;
+        }
+    }
+
+    /**
+     * Attempts to acquire tokens from the bucket belonging to the given key.
+     *
+     * @param key The key whose bucket is charged
+     * @param permits The number of tokens to acquire
+     * @return true if enough tokens were available and acquired, false otherwise
+     * @throws std::invalid_argument if permits <= 0
+     */
+    bool tryAcquire(const std::string& key, long permits = 1) {
+        return tryAcquire(key, std::hash<std::string>{}(key), permits);
+    }
+
+    /**
+     * Attempts to acquire tokens using a hash the caller has already computed.
+     *
+     * @param key The key whose bucket is charged
+     * @param hash std::hash<std::string>{}(key)
+     * @param permits The number of tokens to acquire
+     * @return true if enough tokens were available and acquired, false otherwise
+     * @throws std::invalid_argument if permits <= 0
+     */
+    bool tryAcquire(const std::string& key, std::size_t hash, long permits) {
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        return bucketLocked(shard, key, hash).tryAcquire(permits);
+    }
+
+    /**
+     * Returns the tokens currently available to a key. Keys never seen
+     * report a full bucket.
+     *
+     * @param key The key to inspect
+     * @return The current token count
+     */
+    long getAvailableTokens(const std::string& key) {
+        return getAvailableTokens(key, std::hash<std::string>{}(key));
+    }
+
+    /**
+     * Returns the tokens available to a key, using a hash the caller has
+     * already computed.
+     *
+     * @param key The key to inspect
+     * @param hash std::hash<std::string>{}(key)
+     * @return The current token count
+     */
+    long getAvailableTokens(const std::string& key, std::size_t hash) {
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.buckets.find(KeyRef{&key, hash});
+        return it == shard.buckets.end() ? capacity_ : it->second->bucket.getRefilledTokens();
+    }
+
+    /**
+     * Returns the number of keys currently tracked.
+     *
+     * @return The number of live buckets
+     */
+    std::size_t keyCount() {
+        std::size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> guard(shard->lock);
+            total += shard->buckets.size();
+        }
+        return total;
+    }
+
+    long getCapacity() const {
+        return capacity_;
+    }
+
+    long getRefillRate() const {
+        return refill_rate_;
+    }
+};
+
+#endif // KEYED_RATE_LIMITER_H
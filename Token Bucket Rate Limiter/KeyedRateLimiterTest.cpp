@@ -0,0 +1,119 @@
+#include "KeyedRateLimiter.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+/**
+ * Test cases for KeyedRateLimiter.
+ *
+ * Tests cover:
+ * - Independent buckets per key
+ * - Sweeping idle buckets once a shard reaches its key budget
+ * - Keeping buckets that have not refilled
+ * - Sweep cost staying bounded while no bucket refills
+ * - Argument validation
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread KeyedRateLimiterTest.cpp -o keyed_rate_limiter_test
+ */
+
+void testIndependentBuckets() {
+    std::cout << "Test 1: Independent Buckets per Key" << std::endl;
+    KeyedRateLimiter limiter(3, 1);
+    for (int i = 0; i < 3; i++) {
+        assert(limiter.tryAcquire("alice"));
+    }
+    assert(!limiter.tryAcquire("alice"));
+    assert(limiter.getAvailableTokens("alice") == 0);
+
+    assert(limiter.getAvailableTokens("bob") == 3);  // never seen
+    assert(limiter.tryAcquire("bob", 2));
+    assert(!limiter.tryAcquire("bob", 2));
+    std::size_t hash = std::hash<std::string>{}("bob");
+    assert(limiter.tryAcquire("bob", hash, 1));
+    assert(limiter.keyCount() == 2);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testIdleBucketsSwept() {
+    std::cout << "Test 2: Idle Buckets Swept at the Key Budget" << std::endl;
+    // One token refilled per millisecond: a bucket idle for 2 ms is full.
+    KeyedRateLimiter limiter(1, 1000, 4, 1);
+    for (int i = 0; i < 200; i++) {
+        assert(limiter.tryAcquire("key" + std::to_string(i)));
+        assert(limiter.keyCount() <= 4);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    // A swept key starts again from a full bucket.
+    assert(limiter.getAvailableTokens("key0") == 1);
+    assert(limiter.tryAcquire("key0"));
+    std::cout << "✓ Passed (keys: " << limiter.keyCount() << ")\n" << std::endl;
+}
+
+void testBusyBucketsKept() {
+    std::cout << "Test 3: Buckets Below Capacity Are Kept" << std::endl;
+    // One token per second: nothing refills during the test.
+    KeyedRateLimiter limiter(5, 1, 2, 1);
+    assert(limiter.tryAcquire("a"));
+    assert(limiter.tryAcquire("b"));
+    assert(limiter.tryAcquire("c"));  // budget reached, but no bucket is full
+    assert(limiter.keyCount() == 3);
+    assert(limiter.getAvailableTokens("a") == 4);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+void testSweepAmortized() {
+    std::cout << "Test 4: Sweeps Amortized While Every Bucket Is Busy" << std::endl;
+    // Nothing refills, so no sweep frees anything. Sweeping the whole shard
+    // for every new key past the budget would check about 10^9 buckets.
+    // Each bucket is left 500 tokens short, 500 s of refill at one per second.
+    KeyedRateLimiter limiter(1000, 1, 64, 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 50000; i++) {
+        assert(limiter.tryAcquire("busy" + std::to_string(i), 500));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(limiter.keyCount() == 50000);
+    assert(elapsed < std::chrono::seconds(2));
+    std::cout << "✓ Passed ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms)\n"
+              << std::endl;
+}
+
+void testInvalidArguments() {
+    std::cout << "Test 5: Argument Validation" << std::endl;
+    int failures = 0;
+    try {
+        KeyedRateLimiter limiter(0, 1);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    try {
+        KeyedRateLimiter limiter(1, 1, 0);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    try {
+        KeyedRateLimiter limiter(1, 1);
+        limiter.tryAcquire("a", 0);
+    } catch (const std::invalid_argument&) {
+        failures++;
+    }
+    assert(failures == 3);
+    std::cout << "✓ Passed\n" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Keyed Rate Limiter Tests...\n" << std::endl;
+
+    testIndependentBuckets();
+    testIdleBucketsSwept();
+    testBusyBucketsKept();
+    testSweepAmortized();
+    testInvalidArguments();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
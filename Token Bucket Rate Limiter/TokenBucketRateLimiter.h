@@ -5,6 +5,7 @@
 #include <mutex>
 #include <chrono>
 #include <algorithm>
+#include <stdexcept>
 
 /**
  * Token Bucket Rate Limiter implementation.
@@ -21,14 +22,20 @@ private:
     std::chrono::nanoseconds last_refill_time_;
     mutable std::mutex lock_;
 
+    /**
+     * Returns the tokens earned between the last refill and now.
+     */
+    long tokensToAdd(std::chrono::nanoseconds now) const {
+        auto elapsed_nanos = now - last_refill_time_;
+        return (elapsed_nanos.count() * refill_rate_) / 1'000'000'000L;
+    }
+
     /**
      * Refills the bucket based on elapsed time since last refill.
      */
     void refill() {
         auto now = std::chrono::high_resolution_clock::now().time_since_epoch();
-        auto elapsed_nanos = now - last_refill_time_;
-
-        long tokens_to_add = (elapsed_nanos.count() * refill_rate_) / 1'000'000'000L;
+        long tokens_to_add = tokensToAdd(now);
 
         if (tokens_to_add > 0) {
             tokens_ = std::min(capacity_, tokens_ + tokens_to_add);
@@ -65,6 +72,28 @@ public:
         return false;
     }
 
+    /**
+     * Attempts to acquire several tokens at once. Either all requested
+     * tokens are taken or none are.
+     *
+     * @param permits The number of tokens to acquire
+     * @return true if enough tokens were available and acquired, false otherwise
+     * @throws std::invalid_argument if permits <= 0
+     */
+    bool tryAcquire(long permits) {
+        if (permits <= 0) {
+            throw std::invalid_argument("Permits must be greater than 0");
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        refill();
+
+        if (tokens_ >= permits) {
+            tokens_ -= permits;
+            return true;
+        }
+        return false;
+    }
+
     /**
      * Returns the current number of tokens available in the bucket.
      *
@@ -75,6 +104,19 @@ public:
         return tokens_;
     }
 
+    /**
+     * Returns the number of tokens a request made now would see, counting
+     * the refill since the last acquire. Unlike getAvailableTokens(), this
+     * does not lag behind an idle bucket.
+     *
+     * @return The token count as of now
+     */
+    long getRefilledTokens() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto now = std::chrono::high_resolution_clock::now().time_since_epoch();
+        return std::min(capacity_, tokens_ + tokensToAdd(now));
+    }
+
     /**
      * Returns the capacity of the bucket.
      *